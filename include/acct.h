@@ -0,0 +1,44 @@
+#ifndef ACCT_H
+#define ACCT_H
+
+struct job;
+struct process;
+struct rusage;
+
+/* Resource accounting: every launched process records its wall time, the
+ * time the shell spent starting it and, when reaped with wait4(), its CPU
+ * time, peak RSS and context switches. Recording is always on and costs two
+ * vDSO clock reads per process; the report is printed for jobs prefixed with
+ * `time` and, with MY_SHELL_ACCT set, for every job. */
+
+/* MY_SHELL_ACCT=1|stderr prints every job, MY_SHELL_ACCT=path appends JSON lines */
+#define ACCT_ENV "MY_SHELL_ACCT"
+
+/* Per-process figures, stored in struct process */
+struct proc_acct {
+    long long start_ns;  // CLOCK_MONOTONIC just before the launch
+    long long spawn_ns;  // time spent in fork/posix_spawn (up to exec for posix_spawn)
+    long long end_ns;    // CLOCK_MONOTONIC when reaped, 0 while running
+    long user_us;        // user CPU time
+    long sys_us;         // system CPU time
+    long maxrss_kb;      // peak resident set size
+    long nvcsw;          // voluntary context switches
+    long nivcsw;         // involuntary context switches
+    int status;          // wait status
+};
+
+void acct_init(void);
+
+/* CLOCK_MONOTONIC in nanoseconds */
+long long acct_now(void);
+
+/* Record the exit of p with its wait status and rusage (NULL if unknown) */
+void acct_exit(struct process *p, int status, const struct rusage *ru);
+
+/* Record a builtin that ran inside the shell, from the shell's rusage before it */
+void acct_self(struct process *p, const struct rusage *before);
+
+/* Print j's per-stage and total figures if it was timed or accounting is on */
+void acct_report(const struct job *j);
+
+#endif /* ACCT_H */
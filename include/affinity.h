@@ -0,0 +1,44 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <sched.h>
+
+struct arena;
+
+/* Per-stage scheduling: words such as `@cpu=0-3`, `@cpu=auto`, `@nice=5` and
+ * `@sched=batch` in front of a stage's command are stored on its process and
+ * applied by the child before exec, e.g.
+ *
+ *     @cpu=0-3 grep foo big.log | @cpu=4-7 sort
+ *
+ * `@cpu=auto` gives each such stage the next CPU of the shell's own affinity
+ * mask in turn, so the stages of one pipeline land on distinct cores. */
+#define STAGE_PREFIX '@'
+
+/* Which settings a stage asked for */
+enum {
+    STAGE_CPU = 1,       // cpus holds the affinity mask
+    STAGE_CPU_AUTO = 2,  // cpus is picked at launch
+    STAGE_NICE = 4,      // nice holds the niceness
+    STAGE_POLICY = 8,    // policy holds SCHED_OTHER, SCHED_BATCH or SCHED_IDLE
+};
+
+struct stage_sched {
+    int flags;        // STAGE_*, 0 for a plain stage
+    int nice;         // @nice=N
+    int policy;       // @sched=other|batch|idle
+    cpu_set_t *cpus;  // @cpu=LIST, arena-allocated
+};
+
+/* Parse one word into s. Returns 1 if it was a stage prefix, 0 if it is an
+ * ordinary word, -1 if it was a prefix with a bad value (reported on stderr). */
+int stage_sched_parse(struct arena *a, struct stage_sched *s, const char *word);
+
+/* Turn @cpu=auto into a concrete CPU; called by the shell before each launch */
+void stage_sched_resolve(struct stage_sched *s);
+
+/* Apply s to the calling process, reporting refused settings on stderr; the
+ * forked child calls it between fork and exec */
+void stage_sched_apply(const struct stage_sched *s);
+
+#endif /* AFFINITY_H */
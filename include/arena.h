@@ -0,0 +1,45 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/* Default capacity of the first block of a job arena */
+#define ARENA_BLOCK_SIZE 4096
+
+/* Alignment of every allocation; data[] starts on it and sizes round up to it */
+#define ARENA_ALIGN 16
+
+/* Bump allocator: everything is released at once by arena_destroy() */
+struct arena_block {
+    struct arena_block *next;  // previously filled block
+    size_t size;               // usable bytes in data[]
+    size_t used;               // bytes handed out
+    char data[] __attribute__((aligned(ARENA_ALIGN)));
+};
+
+struct arena {
+    struct arena_block *block;  // current block (arena header lives in the first one)
+    void *last;                 // most recent allocation, may grow in place
+};
+
+/* Process-wide allocation counters */
+struct arena_stats {
+    unsigned long mallocs;  // heap blocks obtained from malloc()
+    unsigned long allocs;   // allocations served from arenas
+    unsigned long bytes;    // bytes served from arenas
+};
+
+extern struct arena_stats arena_stats;
+
+/* Allocation never fails: running out of memory aborts the shell with a message,
+ * since the parser has no sensible way to go on without its job */
+struct arena *arena_create(size_t size);
+void arena_destroy(struct arena *a);
+
+void *arena_alloc(struct arena *a, size_t n);
+void *arena_calloc(struct arena *a, size_t n);
+void *arena_realloc(struct arena *a, void *ptr, size_t old_n, size_t new_n);
+char *arena_strdup(struct arena *a, const char *s);
+char *arena_strndup(struct arena *a, const char *s, size_t n);
+
+#endif /* ARENA_H */
@@ -17,6 +17,23 @@ struct builtin_cmd {
 extern struct builtin_cmd builtins[];
 extern const int num_builtins;
 
+/* Name hash shared by the build-time generator and the runtime lookup */
+static inline unsigned int builtin_hash(const char *name, unsigned int seed)
+{
+    unsigned int h = 2166136261u ^ seed;
+    while (*name) {
+        h ^= (unsigned char) *name++;
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+/* Maximum number of builtins loaded with `builtin -f` */
+#define MAX_DYN_BUILTINS 32
+
+/* The i-th builtin loaded with `builtin -f`, NULL past the last */
+const struct builtin_cmd *loaded_builtin(int i);
+
 /* Built-in command functions */
 int cmd_exit(struct process *proc, int in_fd, int out_fd);
 int cmd_cd(struct process *proc, int in_fd, int out_fd);
@@ -25,8 +42,18 @@ int cmd_echo(struct process *proc, int in_fd, int out_fd);
 int cmd_record(struct process *proc, int in_fd, int out_fd);
 int cmd_replay(struct process *proc, int in_fd, int out_fd);
 int cmd_mypid(struct process *proc, int in_fd, int out_fd);
+int cmd_hash(struct process *proc, int in_fd, int out_fd);
+int cmd_builtin(struct process *proc, int in_fd, int out_fd);
+int cmd_timeout(struct process *proc, int in_fd, int out_fd);
+int cmd_wait(struct process *proc, int in_fd, int out_fd);
+int cmd_parallel(struct process *proc, int in_fd, int out_fd);
+int cmd_xargs(struct process *proc, int in_fd, int out_fd);
+int cmd_trace(struct process *proc, int in_fd, int out_fd);
+int cmd_parsecache(struct process *proc, int in_fd, int out_fd);
+int cmd_stats(struct process *proc, int in_fd, int out_fd);
 
 /* Command type detection */
+const struct builtin_cmd *find_builtin(const char *name);
 int get_cmd_id(const char *name);
 
 #endif /* BUILTIN_H */
\ No newline at end of file
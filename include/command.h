@@ -3,16 +3,21 @@
 
 #include <sys/types.h>
 
+#include "acct.h"
+#include "affinity.h"
+#include "pipes.h"
+
+struct arena;
+struct builtin_cmd;
+
 /* Built-in command identifiers */
 enum {
     CMD_EXTERNAL = 0,
-    CMD_EXIT,
-    CMD_CD,
-    CMD_HELP,
-    CMD_ECHO,
-    CMD_RECORD,
-    CMD_REPLAY,
-    CMD_MYPID
+#define BUILTIN(name, func, id) id,
+#include "builtins.def"
+#undef BUILTIN
+    CMD_DYNAMIC,  // loaded with `builtin -f`
+    CMD_FASTPATH  // in-shell cat/head/tail/wc/tee
 };
 
 /* Process linked list node */
@@ -24,8 +29,14 @@ struct process {
     char *outfile;         // output redirect path
     pid_t pid;             // process ID
     int type;              // CMD_EXTERNAL or built-in id
+    const struct builtin_cmd *builtin;  // dispatch entry, NULL if external
     int state;             // PROC_*
     struct process *next;  // next in pipeline
+    struct job *job;       // owning job, set while in the job table
+    struct process *pid_next;  // job table pid hash chain
+    struct proc_acct acct;     // timings and rusage, see acct.h
+    struct stage_sched sched;  // @cpu=/@nice=/@sched= prefixes, see affinity.h
+    struct pipe_opts pipe;     // @pipe= prefix for this and later pipes, see pipes.h
 };
 
 /* Job structure to group pipeline processes */
@@ -35,15 +46,21 @@ struct job {
     int mode;               // FG_EXEC or BG_EXEC
     char *full_cmd;         // entire command string
     struct process *first;  // head of process list
+    int pipe_rd;            // read end of the pipe being filled, -1 for the last stage
+    int running;            // launched processes not yet reaped
+    int timed;              // `time` prefix: report resource usage
+    long long start_ns;     // CLOCK_MONOTONIC when the job was launched
+    struct arena *arena;    // owns the job and everything parsed for it
+    pid_t *relays;          // @pipe=stats relay processes
+    int nrelays;
 };
 
 /* Command parsing functions */
-struct process *parse_segment(char *seg);
+struct process *parse_segment(struct arena *a, char *seg);
 struct job *parse_line(char *line);
-char *process_replay(const char *line);
+char *process_replay(struct arena *a, const char *line);
 
 /* Memory management */
-void free_process(struct process *p);
 void free_job(struct job *j);
 
 #endif /* COMMAND_H */
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef COMPLETE_H
+#define COMPLETE_H
+
+#include <stddef.h>
+
+/* Tab completion for the line editor. The first word of a pipeline stage
+ * completes as a command: a builtin from builtins[], one loaded with
+ * `builtin -f`, or an executable in PATH. PATH executables live in a prefix
+ * trie built on the first completion and then kept current through inotify
+ * watches on the PATH directories, so a Tab walks down the typed prefix
+ * instead of rescanning PATH. Every other word completes as a file name. */
+#define COMPLETE_MAX_DIRS 63   // PATH directories indexed, one bit each
+#define COMPLETE_LIST_MAX 200  // candidates shown by complete_list()
+
+/* Complete the word that ends at pos in buf. Stores the text to insert at pos
+ * in *insert (malloc'd, possibly empty, escaped for the lexer) and returns the
+ * number of candidates. */
+int complete_word(const char *buf, int pos, char **insert);
+
+/* Print the candidates for the word that ends at pos, in columns fitting cols */
+void complete_list(const char *buf, int pos, int cols, int out_fd);
+
+#ifdef SHELL_BENCH
+/* Command names starting with prefix: copies their longest common extension
+ * to ext (n bytes) and returns how many there are; for shell_bench only */
+int complete_command(const char *prefix, char *ext, size_t n);
+#endif
+
+#endif /* COMPLETE_H */
@@ -0,0 +1,52 @@
+#ifndef EXEC_H
+#define EXEC_H
+
+#include <sys/types.h>
+
+#include "builtin.h"
+
+struct job;
+struct process;
+
+/* Engines used to start external commands */
+enum {
+    SPAWN_POSIX,  /* posix_spawn (clone(CLONE_VM|CLONE_VFORK) under glibc) */
+    SPAWN_FORK,   /* classic fork() + execvp() fallback */
+    SPAWN_ZYGOTE, /* fork server started before the shell's heap grows */
+};
+
+/* Build-time default engine, override with `make SPAWN=FORK` */
+#ifndef DEFAULT_SPAWN_MODE
+#define DEFAULT_SPAWN_MODE SPAWN_POSIX
+#endif
+
+/* Runtime override: MY_SHELL_SPAWN=posix|fork|zygote */
+#define SPAWN_ENV "MY_SHELL_SPAWN"
+
+/* Engine selection */
+int spawn_mode_from_env(void);
+const char *spawn_mode_name(int mode);
+
+/* Largest zygote request (path and argv); longer command lines use posix_spawn */
+#define ZYGOTE_MSG_MAX 65536
+
+/* Start the fork server used by SPAWN_ZYGOTE; returns 0 or -1 */
+int zygote_start(void);
+
+/* Executable path cache: command name -> absolute path, shared by all launches */
+#define PATH_CACHE_BUCKETS 256
+
+const char *path_cache_lookup(const char *name);
+int path_cache_insert(const char *name, const char *path);
+void path_cache_forget(const char *name);
+void path_cache_clear(void);
+void path_cache_print(int out_fd);
+
+/* Start p as a member of j's process group with in_fd/out_fd as stdin/stdout.
+ * Returns the child pid, or -1 after reporting the error on stderr. */
+pid_t spawn_process(struct job *j, struct process *p, int in_fd, int out_fd);
+
+/* Run builtin fn for p in a child of j's process group; returns pid or -1 */
+pid_t spawn_builtin(struct job *j, struct process *p, builtin_fn fn, int in_fd, int out_fd);
+
+#endif /* EXEC_H */
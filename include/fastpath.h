@@ -0,0 +1,33 @@
+#ifndef FASTPATH_H
+#define FASTPATH_H
+
+#include "builtin.h"
+
+/* In-shell versions of common pipeline stages (cat, head, tail, wc, tee).
+ * They take the same in_fd/out_fd pair as builtins and move data with
+ * splice/sendfile/copy_file_range where the kernel allows it. A stage whose
+ * options are not supported keeps running the external binary. */
+
+/* Runtime selection: MY_SHELL_FASTPATH=all|none|name,name,... (default all) */
+#define FASTPATH_ENV "MY_SHELL_FASTPATH"
+
+/* Bytes moved per splice/sendfile/copy_file_range call */
+#define FASTPATH_CHUNK (1 << 24)
+
+void fastpath_init(void);
+
+/* Fast-path entry for p, or NULL when p must run the external command */
+const struct builtin_cmd *fastpath_find(const struct process *p);
+
+/* Whether p may run inside the shell: only when everything it opens is a
+ * regular file and its input, if read, is a regular file or (shell_pipe) a
+ * pipe from an earlier stage of the job. A terminal, FIFO or device such as
+ * /dev/zero could block or stream forever, and a stage in the shell is out of
+ * reach of kill and timeout, so those are forked. */
+int fastpath_in_shell(const struct process *p, int in_fd, int shell_pipe);
+
+/* Move up to limit bytes (all if limit < 0) from in to out with the cheapest
+ * kernel copy the pair of files allows; returns bytes moved or -1 */
+long long fastpath_copy(int in, int out, long long limit);
+
+#endif /* FASTPATH_H */
@@ -0,0 +1,26 @@
+#ifndef HISTINDEX_H
+#define HISTINDEX_H
+
+#include <stdint.h>
+
+/* Trigram index over the history store for substring search. Each entry is
+ * filed under every distinct 3-byte sequence it contains, in posting lists of
+ * ascending ids. A query walks the shortest list of its own trigrams from the
+ * newest id down, probes the other lists by binary search and confirms the
+ * survivors with strstr(), so its cost follows the number of candidates
+ * rather than the size of the history. Entries are also filed under their
+ * bigrams, the last one ending in the NUL: a 2-byte pattern walks its own
+ * list, and a 1-byte pattern takes the newest id among the lists of the
+ * bigrams it starts. The index lives in this shell's memory (some 130 bytes
+ * per entry): it is built from the store on the first search, then
+ * add_history() and every query append the entries written since, by this
+ * shell or another one. */
+#define HISTINDEX_SLOTS 4096  // initial hash slots, doubled at half load
+
+/* Index the entries added since the last update, once the index is built */
+void histindex_update(void);
+
+/* Newest entry containing pattern that is older than before (0: any); 0 if none */
+uint64_t history_search(const char *pattern, uint64_t before);
+
+#endif /* HISTINDEX_H */
@@ -0,0 +1,54 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* History store: a ring of variable-length entries in a memory-mapped file.
+ * Entries get ids 1, 2, 3... that keep growing across sessions; the oldest
+ * are overwritten once either the index ring or the data ring wraps. */
+
+#define HIST_MAGIC "MYSHHIST"
+#define HIST_VERSION 1
+
+/* Defaults for a newly created store, overridable from the environment */
+#define HIST_ENTRIES 131072         // MY_SHELL_HISTSIZE: entries kept
+#define HIST_DATA_SIZE (8u << 20)  // MY_SHELL_HISTBYTES: bytes of command text
+#define HIST_FILE ".my_shell_history"
+
+#define HIST_FILE_ENV "MY_SHELL_HISTFILE"
+#define HIST_SIZE_ENV "MY_SHELL_HISTSIZE"
+#define HIST_BYTES_ENV "MY_SHELL_HISTBYTES"
+
+/* On-disk header, followed by uint64_t index[max_entries] and data[data_size] */
+struct hist_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t max_entries;  // slots in the index ring
+    uint64_t data_size;    // bytes in the data ring
+    uint64_t next_id;      // id the next entry will get
+    uint64_t data_head;    // logical data offset of the next record
+    uint64_t reserved[3];
+};
+
+/* Record header in the data ring, followed by len bytes of text and a NUL */
+struct hist_record {
+    uint64_t id;
+    uint32_t len;
+    uint32_t pad;
+};
+
+/* Open (or create) the store; falls back to anonymous memory */
+int history_init(void);
+
+/* Append a command line */
+void add_history(const char *line);
+
+/* O(1) lookup; NULL if id was never written or has been overwritten */
+const char *history_get(uint64_t id);
+
+/* Oldest still available and newest ids, 0 when the history is empty */
+uint64_t history_first(void);
+uint64_t history_last(void);
+
+#endif /* HISTORY_H */
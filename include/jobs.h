@@ -0,0 +1,35 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <sys/types.h>
+
+struct job;
+struct process;
+
+/* Background job table: job id -> job in a growable array, child pid ->
+ * process in a growable hash chained through struct process. Both grow by
+ * doubling, so adding, finding and reaping a job are O(1) on average. */
+#define JOB_TABLE_MIN 16  // initial id slots and pid buckets
+
+/* Install the SIGCHLD handler and its self-pipe */
+void jobs_init(void);
+
+/* Track a launched background job; returns its id, or -1 if out of memory */
+int job_add(struct job *j);
+
+/* Look up the job with id, or the process with pid (a pgid finds the leader) */
+struct job *job_find_id(int id);
+struct process *job_find_pid(pid_t pid);
+
+/* Highest job id in use (0 when empty) and the SIGCHLD self-pipe read end */
+int jobs_max_id(void);
+int jobs_sigchld_fd(void);
+
+/* Record the exit status of a tracked process reaped by someone else */
+void job_exited(struct process *p, int status, int report);
+
+/* Reap finished background children; with report set, print a
+ * "[id] Done  command" line for every job that finished and free it */
+void jobs_reap(int report);
+
+#endif /* JOBS_H */
@@ -0,0 +1,34 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+struct arena;
+
+/* Token kinds */
+enum {
+    LEX_WORD,  // command word or argument
+    LEX_PIPE,  // |
+    LEX_IN,    // <
+    LEX_OUT,   // >
+    LEX_BG,    // &
+};
+
+/* Token flags */
+#define LEXF_QUOTED 1  // word contains quotes or escapes to strip
+
+/* A token is a span of the original line buffer, nothing is copied */
+struct token {
+    int kind;   // LEX_*
+    int flags;  // LEXF_*
+    int off;    // start offset in the line
+    int len;    // length in the line, quotes included
+};
+
+/* Split line into tokens in one pass. Returns the token count and stores an
+ * arena-allocated array in *toks, or -1 on a syntax error (already reported). */
+int lex_line(struct arena *a, const char *line, struct token **toks);
+
+/* Turn a word span into a C string inside buf: strip quotes/escapes and
+ * NUL-terminate in place. Only call once every token has been lexed. */
+char *lex_word(char *buf, const struct token *t);
+
+#endif /* LEXER_H */
@@ -0,0 +1,23 @@
+#ifndef LINEEDIT_H
+#define LINEEDIT_H
+
+/* Line editor for interactive input. The terminal is in raw mode only while a
+ * line is being read, so commands get it back as they expect it.
+ *
+ *     Left/Right, ^B/^F   move one character   Home/End, ^A/^E   line start/end
+ *     Backspace, ^H       delete before        Delete, ^D        delete under
+ *     ^K, ^U, ^W          kill to end, to start, the word before
+ *     Up/Down, ^P/^N      walk the history     ^L                clear the screen
+ *     ^R                  search the history as you type (histindex.h); ^R again for
+ *                         an older match, ^G to give up, any other key takes the line
+ *     Tab                 complete (complete.h); a second Tab lists the candidates
+ *     ^C                  discard the line     ^D on an empty line ends input
+ */
+
+/* Whether stdin and stdout are a terminal the editor can drive (TERM=dumb is not) */
+int lineedit_available(void);
+
+/* Show prompt and read one line: malloc'd, without the newline; NULL at end of input */
+char *lineedit_read(const char *prompt);
+
+#endif /* LINEEDIT_H */
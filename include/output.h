@@ -0,0 +1,32 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+
+/* Buffered output layer: builtins queue fragments per fd and each fd is
+ * written with a single writev() when a builtin finishes or a buffer fills */
+#define OUT_SLOTS 4       // distinct fds buffered at the same time
+#define OUT_BUF_LEN 8192  // formatted bytes held per fd
+#define OUT_IOV 64        // fragments per fd before a forced flush
+#define OUT_COPY_MAX 64   // pputs() copies strings shorter than this
+
+struct out_buf {
+    int fd;                     // -1 when the slot is free
+    int iovcnt;                 // queued fragments
+    size_t len;                 // bytes used in data[]
+    struct iovec iov[OUT_IOV];  // fragments in output order
+    char data[OUT_BUF_LEN];     // storage for formatted fragments
+};
+
+/* Queue formatted output for fd; stderr is written through immediately */
+void pprintf(int fd, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/* Queue len bytes of s without copying; s must stay valid until the next flush */
+void pputs(int fd, const char *s, size_t len);
+
+/* Write out everything queued for fd, or for every fd */
+void out_flush(int fd);
+void out_flush_all(void);
+
+#endif /* OUTPUT_H */
@@ -0,0 +1,34 @@
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <stddef.h>
+
+struct job;
+
+/* Parsed-job templates keyed by the command line after replay substitution.
+ * A template is one malloc'd image of the job's processes, argv arrays, CPU
+ * sets and strings; a hit copies the image into the new job's arena with one
+ * memcpy and rebases its pointers, so repeated lines skip lexing entirely.
+ * Templates are evicted least recently used first once their total size
+ * exceeds the budget, and dropped whenever builtins are loaded or unloaded. */
+#define PARSECACHE_ENV "MY_SHELL_PARSECACHE"   // budget in bytes (suffix K or M), 0 disables
+#define PARSECACHE_BUDGET (256 * 1024)
+#define PARSECACHE_BUCKETS 256
+
+/* Read MY_SHELL_PARSECACHE */
+void parsecache_init(void);
+
+/* Fill j (processes, mode, time prefix) from the template of j->full_cmd.
+ * Returns 1 on a hit, 0 on a miss. */
+int parsecache_lookup(struct job *j);
+
+/* Remember a freshly parsed job as the template for its line */
+void parsecache_insert(const struct job *j);
+
+/* Drop every template, e.g. after the builtin table changed */
+void parsecache_clear(void);
+
+/* Change the budget, evicting down to it; 0 disables the cache */
+void parsecache_set_budget(size_t budget);
+
+#endif /* PARSECACHE_H */
@@ -0,0 +1,49 @@
+#ifndef PIPES_H
+#define PIPES_H
+
+struct job;
+struct process;
+
+/* Inter-stage pipes. Every pipe is created with O_CLOEXEC; its capacity,
+ * packet mode and measurement come from MY_SHELL_PIPE and from `@pipe=`
+ * prefixes, which take the same comma-separated options:
+ *
+ *     SIZE     capacity via F_SETPIPE_SZ (suffix K, M or G), capped at
+ *              /proc/sys/fs/pipe-max-size
+ *     direct   O_DIRECT packet mode: each write() is read back as one packet
+ *     stats    relay the pipe through a process that reports bytes,
+ *              throughput and stall times on stderr when the writer is done
+ *
+ * `@pipe=` on a stage applies to its output pipe and every later one until
+ * another `@pipe=`, so on the first stage it sets up the whole job:
+ *
+ *     @pipe=1M,stats zcat big.gz | grep x | wc -l                           */
+#define PIPE_ENV "MY_SHELL_PIPE"
+#define PIPE_MAX_SIZE_FILE "/proc/sys/fs/pipe-max-size"
+
+struct pipe_opts {
+    int set;     // options given (by @pipe= on a process)
+    int size;    // capacity in bytes, 0 for the kernel default
+    int direct;  // O_DIRECT packet mode
+    int stats;   // measure through a relay
+};
+
+/* Read MY_SHELL_PIPE */
+void pipes_init(void);
+
+/* Options of the shell's pipes when no @pipe= says otherwise */
+const struct pipe_opts *pipes_default(void);
+
+/* Parse one word into o. Returns 1 if it was @pipe=, 0 if not, -1 if its
+ * value was invalid (reported on stderr). */
+int pipe_opts_parse(struct pipe_opts *o, const char *word);
+
+/* Create the pipe from p to p->next of job j under o: p writes to fds[1],
+ * p->next reads fds[0]. With stats a relay process of j's group sits in
+ * between. Returns 0, or -1 after reporting the error. */
+int pipe_open(struct job *j, const struct process *p, const struct pipe_opts *o, int fds[2]);
+
+/* Wait for the relays of a finished foreground job */
+void pipe_relays_wait(struct job *j);
+
+#endif /* PIPES_H */
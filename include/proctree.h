@@ -0,0 +1,41 @@
+#ifndef PROCTREE_H
+#define PROCTREE_H
+
+#include <sys/types.h>
+
+/* Length of /proc/<pid>/stat comm field, plus NUL */
+#define COMM_LEN 17
+
+/* One process in a snapshot; links are indices into proc_tree.nodes */
+struct proc_node {
+    pid_t pid;
+    pid_t ppid;
+    int first_child;   // -1 if none
+    int next_sibling;  // -1 if none
+    char comm[COMM_LEN];
+};
+
+/* Snapshot of /proc with a parent -> children index */
+struct proc_tree {
+    struct proc_node *nodes;
+    int count;
+    int cap;
+    int *slots;     // open-addressing pid -> node index, -1 if empty
+    int slot_mask;  // table size - 1
+};
+
+/* Read ppid (and optionally comm) of one process; -1 if it does not exist */
+pid_t proc_read_ppid(pid_t pid, char *comm);
+
+/* Print the children of pid one per line straight from
+ * /proc/<pid>/task/<tid>/children; -1 without printing anything if the
+ * kernel lacks that file */
+int proc_print_children(pid_t pid, int out_fd);
+
+/* Whole-system snapshot in one pass over /proc */
+int proctree_snapshot(struct proc_tree *t);
+void proctree_free(struct proc_tree *t);
+int proctree_find(const struct proc_tree *t, pid_t pid);
+void proctree_print(const struct proc_tree *t, int idx, int depth, int out_fd);
+
+#endif /* PROCTREE_H */
@@ -2,15 +2,15 @@
 #define SHELL_H
 
 #include <sys/types.h>
-#include <stdarg.h>
+
+#include "output.h"
 
 /* Forward declarations */
 struct process;
 struct job;
 
 /* Buffer sizes and limits */
-#define MAX_JOBS 20
-#define MAX_HISTORY 16
+#define MAX_HISTORY 16  // entries per `record` page
 #define PATH_LEN 1024
 #define LINE_LEN 1024
 #define TOK_LEN 64
@@ -38,31 +38,26 @@ struct shell_info {
     char home_dir[PATH_LEN];
     char cwd[PATH_LEN];
     char user[TOK_LEN];
-    struct job *jobs[MAX_JOBS + 1];
+    int interactive;  // stdin is a terminal
+    int spawn_mode;   // SPAWN_* engine for external commands
+    int last_status;  // exit status of the last foreground job, like $?
 };
 
 extern struct shell_info shell;
 
-/* History buffer - shared across modules */
-extern char history[MAX_HISTORY][LINE_LEN];
-extern int history_count;
-
 /* Shell initialization and control functions */
 void shell_init(void);
+const char *shell_prompt(void);
 void print_prompt(void);
 void update_cwd(void);
-void pprintf(int fd, const char *fmt, ...);
-
-/* History management */
-void add_history(const char *line);
 
 /* Job management */
-int get_job_id(void);
 int launch_job(struct job *j);
 int launch_process(struct job *j, struct process *p, int in_fd, int out_fd);
 
 /* Process ID helpers */
 pid_t get_parent_pid(pid_t pid);
 void find_children(pid_t parent_pid, int out_fd);
+int print_proc_tree(pid_t root_pid, int out_fd);
 
 #endif /* SHELL_H */
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+#include "command.h"
+
+/* Shell metrics: counters and log2-bucketed latency histograms, updated with
+ * relaxed atomic adds so they can stay on in the launch path. They live in a
+ * shared mapping of a file that other processes may read at any time:
+ *
+ *     MY_SHELL_STATS=on      $XDG_RUNTIME_DIR/my_shell.PID.stats, else
+ *                            /run/user/UID/my_shell.PID.stats
+ *     MY_SHELL_STATS unset   the same for an interactive shell, else as off
+ *     MY_SHELL_STATS=path    that file
+ *     MY_SHELL_STATS=off     an anonymous mapping, nothing to scrape
+ *
+ * The file holds one struct shell_stats in native byte order and is removed
+ * when the shell exits; files in the runtime directory left by shells that
+ * were killed are removed when the next one starts there. Readers check magic, version and size first; the
+ * counters and histograms are aligned 64-bit words, readable without locks. */
+#define STATS_ENV "MY_SHELL_STATS"
+#define STATS_MAGIC 0x53485354u  // "SHST"
+#define STATS_VERSION 1
+#define STATS_BUCKETS 32  // [0]: under 1 us, [i]: 2^(i-1) to 2^i us, the last is open-ended
+
+/* Counters */
+enum {
+    STAT_LINES,           // command lines parsed
+    STAT_PARSE_ERRORS,    // lines rejected with a syntax error
+    STAT_JOBS,            // jobs launched
+    STAT_BG_JOBS,         // of which in the background
+    STAT_BG_DONE,         // background jobs finished
+    STAT_PROCESSES,       // child processes started
+    STAT_NOT_FOUND,       // commands not found in PATH
+    STAT_SPAWN_FAILURES,  // fork, posix_spawn or zygote launches that failed
+    NUM_STATS
+};
+
+/* Latency histograms */
+enum {
+    HIST_PARSE,  // parse_line()
+    HIST_SPAWN,  // start of one child process
+    HIST_WAIT,   // foreground job from launch until every stage is reaped
+    NUM_HISTS
+};
+
+/* Builtin call counters are indexed by CMD_* id */
+#define STATS_CMD_IDS (CMD_FASTPATH + 1)
+
+struct stats_hist {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[STATS_BUCKETS];
+};
+
+struct shell_stats {
+    uint32_t magic;    // STATS_MAGIC
+    uint32_t version;  // STATS_VERSION
+    uint32_t size;     // sizeof(struct shell_stats)
+    int32_t pid;       // the shell
+    int64_t start;     // CLOCK_REALTIME seconds at startup
+    uint64_t counters[NUM_STATS];
+    uint64_t builtins[STATS_CMD_IDS];
+    struct stats_hist hist[NUM_HISTS];
+};
+
+/* Always valid: a static block until stats_init() maps the exported one */
+extern struct shell_stats *stats;
+
+/* Map the metrics file selected by MY_SHELL_STATS */
+void stats_init(void);
+
+static inline void stats_add(int counter)
+{
+    __atomic_fetch_add(&stats->counters[counter], 1, __ATOMIC_RELAXED);
+}
+
+static inline void stats_builtin(int id)
+{
+    __atomic_fetch_add(&stats->builtins[id], 1, __ATOMIC_RELAXED);
+}
+
+/* Record one latency of ns nanoseconds in histogram h */
+static inline void stats_time(int h, long long ns)
+{
+    struct stats_hist *s = &stats->hist[h];
+    uint64_t v = ns > 0 ? (uint64_t) ns : 0;
+    uint64_t us = v / 1000;
+    int b = us ? 64 - __builtin_clzll(us) : 0;
+    if (b >= STATS_BUCKETS)
+        b = STATS_BUCKETS - 1;
+
+    __atomic_fetch_add(&s->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s->sum_ns, v, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s->buckets[b], 1, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&s->max_ns, __ATOMIC_RELAXED);
+    while (v > max && !__atomic_compare_exchange_n(&s->max_ns, &max, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+#endif /* STATS_H */
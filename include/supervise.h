@@ -0,0 +1,60 @@
+#ifndef SUPERVISE_H
+#define SUPERVISE_H
+
+struct job;
+struct process;
+
+/* Process supervisor: one epoll set waits on a pidfd per watched process,
+ * an optional deadline timerfd and the terminal's hangup, so waiting for a
+ * job, killing it on a deadline and noticing a lost terminal need neither
+ * polling nor a helper process. Kernels without pidfd_open() fall back to
+ * the SIGCHLD self-pipe plus waitpid(WNOHANG) on each watched process. */
+
+/* Grace period between SIGTERM and SIGKILL once a deadline expires */
+#define SV_KILL_GRACE_MS 1000
+
+/* Events returned by sv_next() */
+enum {
+    SV_EXITED,   // a watched process exited, *pp and *status are set
+    SV_TIMEOUT,  // the deadline passed
+    SV_HANGUP,   // the terminal on stdin hung up
+    SV_ERROR,    // nothing left to wait for, or epoll failed
+};
+
+/* One watched process */
+struct sv_entry {
+    struct process *p;  // NULL once it exited
+    int pidfd;          // -1 when polled through the SIGCHLD pipe
+};
+
+struct supervisor {
+    int epfd;                  // epoll set
+    int timerfd;               // deadline, -1 until sv_deadline()
+    int sigchld;               // SIGCHLD pipe registered for the fallback
+    int tty;                   // stdin registered for hangups
+    struct sv_entry *entries;  // watched processes, indexed by epoll tag
+    int n, cap;                // used and allocated entries
+    int live;                  // entries still running
+};
+
+/* Set up sv; returns 0 or -1 */
+int sv_open(struct supervisor *sv);
+
+/* Watch p (pid > 0) until it exits; returns 0 or -1 */
+int sv_watch(struct supervisor *sv, struct process *p);
+
+/* Arm the deadline ms milliseconds from now, ms < 0 disarms it */
+int sv_deadline(struct supervisor *sv, long ms);
+
+/* Block until the next event; SV_EXITED reaps the process */
+int sv_next(struct supervisor *sv, struct process **pp, int *status);
+
+/* Release every descriptor held by sv */
+void sv_close(struct supervisor *sv);
+
+/* Wait for every launched process of foreground job j. With timeout_ms >= 0
+ * the job's group gets SIGTERM at the deadline and SIGKILL after the grace
+ * period. Returns 1 if the deadline was hit, 0 otherwise. */
+int supervise_job(struct job *j, long timeout_ms);
+
+#endif /* SUPERVISE_H */
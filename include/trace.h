@@ -0,0 +1,57 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "acct.h"
+
+struct process;
+
+/* Launch-latency tracing in Chrome trace-event JSON, loadable in Perfetto or
+ * chrome://tracing. Only compiled in by `make trace` (-DSHELL_TRACE): in any
+ * other build every TRACE_* macro expands to nothing. A tracing build starts
+ * writing with MY_SHELL_TRACE=file or `trace on file`; the shell's own phases
+ * go on the shell's track and every child gets a track named after its pid. */
+#define TRACE_ENV "MY_SHELL_TRACE"
+#define TRACE_BUF_LEN 65536  // events buffered before a write()
+
+#ifdef SHELL_TRACE
+
+extern int trace_fd;  // -1 while not tracing
+
+void trace_init(void);
+int trace_open(const char *path);
+void trace_close(void);
+void trace_flush(void);
+
+/* Emit a complete event on the shell's track (tid 0) or on child tid */
+void trace_span(const char *name, long long start_ns, long long end_ns, int tid, const char *arg);
+
+/* Emit the spawn and run spans of a reaped child on its own track */
+void trace_process(const struct process *p);
+
+#define TRACE_BEGIN(t) long long t = (trace_fd >= 0 ? acct_now() : 0)
+#define TRACE_END(t, name, arg)                            \
+    do {                                                   \
+        if (t && trace_fd >= 0)                            \
+            trace_span(name, t, acct_now(), 0, arg);       \
+    } while (0)
+#define TRACE_PROCESS(p)                                   \
+    do {                                                   \
+        if (trace_fd >= 0)                                 \
+            trace_process(p);                              \
+    } while (0)
+#define TRACE_FLUSH()                                      \
+    do {                                                   \
+        if (trace_fd >= 0)                                 \
+            trace_flush();                                 \
+    } while (0)
+
+#else
+
+#define TRACE_BEGIN(t)
+#define TRACE_END(t, name, arg) do { } while (0)
+#define TRACE_PROCESS(p) do { } while (0)
+#define TRACE_FLUSH() do { } while (0)
+
+#endif /* SHELL_TRACE */
+
+#endif /* TRACE_H */
@@ -3,33 +3,142 @@
  */
 
 #define _GNU_SOURCE
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include "include/arena.h"
 #include "include/command.h"
+#include "include/jobs.h"
+#include "include/lineedit.h"
 #include "include/shell.h"
+#include "include/trace.h"
 
-/* History buffer - made visible to other modules */
-char history[MAX_HISTORY][LINE_LEN];
-int history_count = 0;
+/* Parse and run a single command line */
+static void run_line(char *line)
+{
+#ifdef DEBUG
+    unsigned long mallocs = arena_stats.mallocs;
+#endif
+
+    /* parse and launch job */
+    TRACE_BEGIN(t_parse);
+    struct job *j = parse_line(line);
+    TRACE_END(t_parse, "parse", j->full_cmd);
+
+#ifdef DEBUG
+    pprintf(STDERR_FILENO, "[arena] parse: %lu malloc(s), %lu allocations so far\n", arena_stats.mallocs - mallocs,
+            arena_stats.allocs);
+#endif
+
+    TRACE_BEGIN(t_launch);
+    launch_job(j);
+    TRACE_END(t_launch, "launch_job", j->full_cmd);
+    TRACE_FLUSH();
+
+    /* background jobs in the job table are freed by the reaper */
+    if (j->mode == FG_EXEC || j->id == 0) {
+        free_job(j);
+    }
+}
+
+/* Run every line of buf in place; buf[len] must be writable */
+static void run_buffer(char *buf, size_t len)
+{
+    char *end = buf + len;
+    *end = '\0';
+
+    for (char *line = buf; line < end;) {
+        char *nl = memchr(line, '\n', end - line);
+        if (!nl)
+            nl = end;
+        *nl = '\0';
+        jobs_reap(0);
+
+        /* skip blank lines and comments (including a #! line) */
+        char *s = line + strspn(line, " \t\r");
+        if (*s != '\0' && *s != '#')
+            run_line(line);
+
+        line = nl + 1;
+    }
+}
+
+/* Batch mode: map the script privately and parse its lines where they lie */
+static int run_script(const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        return 127;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    /* reserve one spare byte past EOF for the final terminator: anonymous
+     * pages first, then the file mapped over them */
+    size_t size = st.st_size;
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t map_len = (size + 1 + page - 1) / page * page;
+    char *buf = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED ||
+        mmap(buf, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        perror(path);
+        close(fd);
+        return 126;
+    }
+    close(fd);
+
+    run_buffer(buf, size);
+    munmap(buf, map_len);
+    return shell.last_status;
+}
 
 int main(int argc, char **argv)
 {
-    (void) argc;
-    (void) argv;
     shell_init();
 
+    /* my_shell -c "cmd": run the string, no prompt */
+    if (argc > 1 && strcmp(argv[1], "-c") == 0) {
+        if (argc < 3) {
+            pprintf(STDERR_FILENO, "%s: -c: option requires an argument\n", argv[0]);
+            return 2;
+        }
+        run_buffer(argv[2], strlen(argv[2]));
+        return shell.last_status;
+    }
+
+    /* my_shell script.sh: run the file, no prompt */
+    if (argc > 1)
+        return run_script(argv[1]);
+
+    /* edit lines on a terminal, read them plainly from anything else */
+    int edit = lineedit_available();
     while (1) {
-        print_prompt();
+        jobs_reap(1);
         char *line = NULL;
-        size_t cap = 0;
-        if (getline(&line, &cap, stdin) < 0)
-            break;
+        if (edit) {
+            line = lineedit_read(shell_prompt());
+            if (!line)
+                break;
+        } else {
+            print_prompt();
+            size_t cap = 0;
+            if (getline(&line, &cap, stdin) < 0)
+                break;
+        }
         /* skip empty lines */
-        if (line[0] == '\n')
+        if (line[0] == '\n' || line[0] == '\0') {
+            free(line);
             continue;
+        }
 
         /* remove trailing newline */
         size_t len = strlen(line);
@@ -37,16 +146,9 @@ int main(int argc, char **argv)
             line[len - 1] = '\0';
         }
 
-        /* parse and launch job */
-        struct job *j = parse_line(line);
-        launch_job(j);
-
-        /* free job if it was foreground execution */
-        if (j->mode == FG_EXEC) {
-            free_job(j);
-        }
+        run_line(line);
 
         free(line);
     }
     return 0;
-}
\ No newline at end of file
+}
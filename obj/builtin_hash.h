@@ -0,0 +1,11 @@
+/* Generated by tools/gen_builtin_hash.c from builtins.def - do not edit */
+#ifndef BUILTIN_HASH_H
+#define BUILTIN_HASH_H
+
+#define BUILTIN_HASH_SEED 64u
+#define BUILTIN_HASH_SIZE 32
+
+/* slot -> index into builtins[], -1 if empty */
+static const signed char builtin_hash_slots[BUILTIN_HASH_SIZE] = {2, 10, -1, -1, 11, -1, -1, -1, -1, -1, -1, 13, 0, -1, -1, 4, 5, 12, 15, 1, -1, 7, 3, 14, -1, -1, 8, 6, -1, -1, 9, -1};
+
+#endif /* BUILTIN_HASH_H */
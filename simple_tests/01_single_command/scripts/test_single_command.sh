@@ -7,6 +7,7 @@
 #   - Basic command execution (ls, cat, whoami, pwd)
 #   - Handling empty lines (spaces/tabs only)
 #   - Exit command functionality
+#   - Command path cache invalidation
 # =============================================================================
 
 # Color definitions for output formatting
@@ -231,6 +232,46 @@ test_exit_command() {
     fi
 }
 
+# Test 4: Command path cache
+test_path_cache() {
+    log_section "測試 4: 命令路徑快取"
+    local test_passed=true
+    local dir="$(mktemp -d)"
+    mkdir -p "$dir/first" "$dir/second" "$dir/rel"
+    printf '#!/bin/sh\necho from_second\n' > "$dir/second/pc_tool"
+    printf '#!/bin/sh\necho from_rel\n' > "$dir/rel/pc_rel"
+    chmod +x "$dir/second/pc_tool" "$dir/rel/pc_rel"
+
+    # a cached binary removed under the fork and zygote engines is dropped from the cache
+    local output mode
+    for mode in fork zygote; do
+        printf '#!/bin/sh\necho from_first\n' > "$dir/first/pc_tool"
+        chmod +x "$dir/first/pc_tool"
+        output="$(printf 'pc_tool\nrm %s/first/pc_tool\npc_tool\nhash\n' "$dir" |
+            PATH="$dir/first:$dir/second:/usr/bin:/bin" MY_SHELL_SPAWN=$mode timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+        if echo "$output" | grep -q "from_first" && echo "$output" | grep -q "from_second" &&
+            echo "$output" | grep -q "$dir/second/pc_tool" && ! echo "$output" | grep -q "$dir/first/pc_tool"; then
+            log_success "$mode 模式下執行失敗時移除過期的快取項目"
+        else
+            log_error "Stale entry not replaced with $mode: $output"
+            test_passed=false
+        fi
+    done
+
+    # resolutions through empty or relative PATH elements are not cached
+    output="$(cd "$dir" && printf 'pc_rel\nhash\n' |
+        PATH="rel::/usr/bin:/bin" timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+    if echo "$output" | grep -q "from_rel" && ! echo "$output" | grep -q "rel/pc_rel"; then
+        log_success "相對 PATH 目錄找到的命令不放入快取"
+    else
+        log_error "Relative PATH resolution was cached: $output"
+        test_passed=false
+    fi
+
+    rm -rf "$dir"
+    [ "$test_passed" = true ]
+}
+
 # Main test execution
 main() {
     log_section "單一進程命令測試開始"
@@ -261,6 +302,12 @@ main() {
         passed_tests=$((passed_tests + 1))
     fi
     
+    # Test 4: Command path cache
+    total_tests=$((total_tests + 1))
+    if test_path_cache; then
+        passed_tests=$((passed_tests + 1))
+    fi
+    
     # Final results
     log_section "測試結果總結"
     echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
@@ -0,0 +1,222 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Non-interactive Batch Mode
+# Purpose:
+#   - Verify `my_shell -c "cmd"` runs the given command string
+#   - Verify `my_shell script.sh` runs a script file line by line
+#   - Neither mode may print the interactive prompt
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 07_batch_mode
+#   - Or run directly:
+#       bash simple_tests/07_batch_mode/scripts/test_batch_mode.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=10
+TEST_DATA_DIR="$SCRIPT_DIR/../test_data"
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Test 1: my_shell -c "cmd"
+test_command_string() {
+    log_section "測試 1: 命令字串模式 (-c)"
+
+    local temp_output="$(mktemp)"
+
+    pushd "$TEST_DATA_DIR" >/dev/null || return 1
+    log_info "Running: my_shell -c 'echo one; cat text.txt | head -1'"
+    timeout $TIMEOUT "$SHELL_BINARY" -c "echo one
+cat text.txt | head -1" > "$temp_output" 2>&1
+    local exit_code=$?
+    popd >/dev/null
+
+    if [ $exit_code -ne 0 ]; then
+        log_error "-c mode exited with code $exit_code"
+        sed 's/^/  > /' "$temp_output"
+        rm -f "$temp_output"
+        return 1
+    fi
+
+    local expected="$(printf 'one\nHello world')"
+    if [ "$(cat "$temp_output")" == "$expected" ]; then
+        log_success "-c output matches exactly (no prompt printed)"
+    else
+        log_error "-c output mismatch"
+        log_info "Actual output:"
+        sed 's/^/  > /' "$temp_output"
+        rm -f "$temp_output"
+        return 1
+    fi
+
+    rm -f "$temp_output"
+    return 0
+}
+
+# Test 2: my_shell script.sh
+test_script_file() {
+    log_section "測試 2: 腳本檔案模式 (script.sh)"
+
+    local temp_output="$(mktemp)"
+
+    pushd "$TEST_DATA_DIR" >/dev/null || return 1
+    log_info "Running: my_shell script.sh"
+    timeout $TIMEOUT "$SHELL_BINARY" script.sh < /dev/null > "$temp_output" 2>&1
+    local exit_code=$?
+    popd >/dev/null
+
+    if [ $exit_code -ne 0 ]; then
+        log_error "Script mode exited with code $exit_code"
+        sed 's/^/  > /' "$temp_output"
+        rm -f "$temp_output"
+        return 1
+    fi
+
+    local expected="$(printf 'batch start\nA shell interprets user commands into system calls\nbatch end')"
+    if [ "$(cat "$temp_output")" == "$expected" ]; then
+        log_success "Script output matches exactly (comments skipped, no prompt)"
+    else
+        log_error "Script output mismatch"
+        log_info "Actual output:"
+        sed 's/^/  > /' "$temp_output"
+        rm -f "$temp_output"
+        return 1
+    fi
+
+    rm -f "$temp_output"
+    return 0
+}
+
+# Test 3: missing script file
+test_missing_script() {
+    log_section "測試 3: 不存在的腳本檔案"
+
+    timeout $TIMEOUT "$SHELL_BINARY" /nonexistent/script.sh > /dev/null 2>&1
+    local exit_code=$?
+
+    if [ $exit_code -eq 127 ]; then
+        log_success "Missing script reported with exit code 127"
+        return 0
+    fi
+    log_error "Expected exit code 127, got $exit_code"
+    return 1
+}
+
+# Test 4: exit status of the last foreground job
+test_exit_status() {
+    log_section "測試 4: 結束碼"
+    local test_passed=true
+    local line expected got
+    local script="$(mktemp)"
+
+    while IFS='=' read -r line expected; do
+        timeout $TIMEOUT "$SHELL_BINARY" -c "$line" > /dev/null 2>&1
+        got=$?
+        if [ "$got" -eq "$expected" ]; then
+            log_success "-c '$line' exits with $expected"
+        else
+            log_error "-c '$line' exited with $got, expected $expected"
+            test_passed=false
+        fi
+    done <<'EOF'
+true=0
+false=1
+/bin/false | /bin/true=0
+/bin/true | /bin/false=1
+sh -c 'exit 3'=3
+sh -c 'kill -9 $$'=137
+nosuchcmd_xyz=127
+cd /nonexistent_dir=1
+echo "unterminated=2
+EOF
+
+    printf 'echo one\nfalse\n' > "$script"
+    timeout $TIMEOUT "$SHELL_BINARY" "$script" > /dev/null 2>&1
+    got=$?
+    printf 'false\necho two\n' > "$script"
+    timeout $TIMEOUT "$SHELL_BINARY" "$script" > /dev/null 2>&1
+    local got2=$?
+    if [ "$got" -eq 1 ] && [ "$got2" -eq 0 ]; then
+        log_success "Script exits with the status of its last line"
+    else
+        log_error "Script exit status does not follow its last line"
+        test_passed=false
+    fi
+    rm -f "$script"
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "批次模式測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+    log_info "Using test data dir: $TEST_DATA_DIR"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_command_string test_script_file test_missing_script test_exit_status; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有批次模式測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 shell 的批次模式實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
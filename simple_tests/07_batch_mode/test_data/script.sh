@@ -0,0 +1,6 @@
+#!/usr/bin/env my_shell
+# comment lines and blank lines are skipped
+
+echo batch start
+cat text.txt | head -2 | tail -1
+echo batch end
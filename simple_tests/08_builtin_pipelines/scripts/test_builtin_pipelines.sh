@@ -0,0 +1,243 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Built-ins Inside Pipelines
+# Purpose:
+#   - Verify a built-in feeding a pipe larger than the pipe capacity (64 KiB)
+#     does not deadlock the shell
+#   - Verify built-ins in the middle of a pipeline and in the background run
+#     in their own child process
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 08_builtin_pipelines
+#   - Or run directly:
+#       bash simple_tests/08_builtin_pipelines/scripts/test_builtin_pipelines.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=10
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Test 1: built-in output larger than the pipe buffer
+test_large_builtin_output() {
+    log_section "測試 1: 大量輸出的內建命令管線 (echo <200000 chars> | wc -c)"
+
+    local temp_input="$(mktemp)"
+    local temp_output="$(mktemp)"
+
+    printf 'echo %s | wc -c\nexit\n' "$(head -c 200000 /dev/zero | tr '\0' 'x')" > "$temp_input"
+
+    log_info "Running: echo <200000 chars> | wc -c"
+    timeout $TIMEOUT "$SHELL_BINARY" < "$temp_input" > "$temp_output" 2>&1
+    local exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Shell deadlocked on a large built-in pipeline (timed out after ${TIMEOUT}s)"
+        rm -f "$temp_input" "$temp_output"
+        return 1
+    fi
+
+    if grep -q '200001' "$temp_output"; then
+        log_success "wc counted all 200001 bytes written by echo"
+    else
+        log_error "Expected byte count 200001 not found"
+        log_info "Actual output:"
+        cut -c1-120 "$temp_output" | sed 's/^/  > /'
+        rm -f "$temp_input" "$temp_output"
+        return 1
+    fi
+
+    rm -f "$temp_input" "$temp_output"
+    return 0
+}
+
+# Test 2: built-in in the middle of a pipeline
+test_builtin_middle_stage() {
+    log_section "測試 2: 管線中段的內建命令 (echo a | echo b | cat)"
+
+    local temp_input="$(mktemp)"
+    local temp_output="$(mktemp)"
+
+    cat > "$temp_input" << 'EOF'
+echo a | echo b | cat
+exit
+EOF
+
+    log_info "Running: echo a | echo b | cat"
+    timeout $TIMEOUT "$SHELL_BINARY" < "$temp_input" > "$temp_output" 2>&1
+    local exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Middle-stage built-in test timed out after ${TIMEOUT}s"
+        rm -f "$temp_input" "$temp_output"
+        return 1
+    fi
+
+    if grep -q 'b$' "$temp_output" && ! grep -q 'a$' "$temp_output"; then
+        log_success "Only the middle built-in's output reached cat"
+    else
+        log_error "Unexpected output for middle-stage built-in"
+        log_info "Actual output:"
+        sed 's/^/  > /' "$temp_output"
+        rm -f "$temp_input" "$temp_output"
+        return 1
+    fi
+
+    rm -f "$temp_input" "$temp_output"
+    return 0
+}
+
+# Test 3: built-in in the background gets its own PID
+test_background_builtin() {
+    log_section "測試 3: 背景執行內建命令 (echo bg > bg_out.txt &)"
+
+    local temp_dir="$(mktemp -d)"
+    local temp_input="$temp_dir/input"
+    local temp_output="$temp_dir/output"
+
+    cat > "$temp_input" << 'EOF'
+echo bg > bg_out.txt &
+exit
+EOF
+
+    log_info "Running: echo bg > bg_out.txt &"
+    pushd "$temp_dir" >/dev/null || return 1
+    timeout $TIMEOUT "$SHELL_BINARY" < "$temp_input" > "$temp_output" 2>&1
+    popd >/dev/null
+
+    local test_passed=true
+    if grep -Eq '(^|[$] )[1-9][0-9]*$' "$temp_output"; then
+        log_success "Background built-in printed a child PID"
+    else
+        log_error "No child PID printed for background built-in"
+        log_info "Actual output:"
+        sed 's/^/  > /' "$temp_output"
+        test_passed=false
+    fi
+
+    for _ in $(seq 1 40); do # up to ~2s
+        [ -s "$temp_dir/bg_out.txt" ] && break
+        sleep 0.05
+    done
+    if [ "$(cat "$temp_dir/bg_out.txt" 2>/dev/null)" == "bg" ]; then
+        log_success "bg_out.txt written by the background built-in"
+    else
+        log_error "bg_out.txt missing or has unexpected content"
+        test_passed=false
+    fi
+
+    rm -rf "$temp_dir"
+    if [ "$test_passed" = true ]; then
+        return 0
+    else
+        return 1
+    fi
+}
+
+# Test 4: more fragments than the output buffer's iovec array (OUT_IOV)
+test_many_fragments() {
+    log_section "測試 4: 超過 OUT_IOV 個片段的內建命令輸出"
+
+    local word expected="start" i
+    word="$(printf 'x%.0s' $(seq 70))"
+    for i in $(seq 1 100); do
+        expected+=" $word a$i"
+    done
+
+    log_info "Running: echo start <70 chars> a1 ... <70 chars> a100 > file"
+    local temp_output="$(mktemp)"
+    local output
+    output="$(timeout $TIMEOUT "$SHELL_BINARY" -c "echo $expected" 2>&1)"
+    timeout $TIMEOUT "$SHELL_BINARY" -c "echo $expected > $temp_output" > /dev/null 2>&1
+
+    local test_passed=true
+    if [ "$output" == "$expected" ]; then
+        log_success "Terminal-order output intact across forced flushes"
+    else
+        log_error "Output corrupted: $(echo "$output" | tr ' ' '\n' | grep -v '^x*$' | tr '\n' ' ' | cut -c1-200)"
+        test_passed=false
+    fi
+    if [ "$(cat "$temp_output")" == "$expected" ]; then
+        log_success "Redirected output intact across forced flushes"
+    else
+        log_error "Redirected output corrupted"
+        test_passed=false
+    fi
+
+    rm -f "$temp_output"
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "管線內建命令測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_large_builtin_output test_builtin_middle_stage test_background_builtin test_many_fragments; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有管線內建命令測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 shell 的內建命令管線實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
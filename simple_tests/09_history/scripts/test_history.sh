@@ -0,0 +1,209 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Persistent Command History (record / replay)
+# Purpose:
+#   - Verify `record` lists entries with their history ids
+#   - Verify `replay N` re-runs entry N, optionally with extra pipeline stages
+#   - Verify history survives across shell sessions through MY_SHELL_HISTFILE
+#   - Verify `record -p N` pages back through older entries
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 09_history
+#   - Or run directly:
+#       bash simple_tests/09_history/scripts/test_history.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=10
+HIST_FILE="$(mktemp -u)"
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Run the shell in batch mode against the shared history file
+run_shell() {
+    MY_SHELL_HISTFILE="$HIST_FILE" timeout $TIMEOUT "$SHELL_BINARY" -c "$1"
+}
+
+# Test 1: record and replay within one session
+test_record_replay() {
+    log_section "測試 1: record 與 replay"
+
+    local output
+    output="$(run_shell "echo alpha
+echo beta
+replay 1 | cat
+record")"
+
+    local test_passed=true
+    if [ "$(echo "$output" | sed -n 3p)" == "alpha" ]; then
+        log_success "replay 1 | cat re-ran 'echo alpha'"
+    else
+        log_error "replay 1 did not re-run 'echo alpha'"
+        test_passed=false
+    fi
+
+    if echo "$output" | grep -Eq '^ 3  echo alpha \| cat$'; then
+        log_success "record shows the expanded replay as entry 3"
+    else
+        log_error "record output missing expanded replay entry"
+        test_passed=false
+    fi
+
+    if [ "$test_passed" = false ]; then
+        log_info "Actual output:"
+        echo "$output" | sed 's/^/  > /'
+        return 1
+    fi
+    return 0
+}
+
+# Test 2: history persists into the next session
+test_persistence() {
+    log_section "測試 2: 跨 session 保存歷史紀錄"
+
+    local output
+    output="$(run_shell "replay 2")"
+
+    if [ "$output" == "beta" ]; then
+        log_success "New session replayed entry 2 from the history file"
+        return 0
+    fi
+    log_error "Expected 'beta' from replay 2 in a new session"
+    log_info "Actual output:"
+    echo "$output" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 3: record -p pages back through older entries
+test_record_pages() {
+    log_section "測試 3: record -p 分頁"
+
+    local script=""
+    for i in $(seq 1 20); do
+        script+="echo line$i > /dev/null"$'\n'
+    done
+    run_shell "$script" > /dev/null
+
+    local output
+    output="$(run_shell "record -p 2")"
+
+    # 5 entries from tests 1-2 + 20 here + this record = 26; page 2 ends at 10
+    if echo "$output" | tail -n 1 | grep -Eq '^10  echo line5 > /dev/null$'; then
+        log_success "record -p 2 ends 16 entries before the newest"
+        return 0
+    fi
+    log_error "Unexpected record -p 2 output"
+    log_info "Actual output:"
+    echo "$output" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 4: a damaged history file is recreated, a foreign file left alone
+test_damaged_file() {
+    log_section "測試 4: 損壞的歷史檔"
+
+    local test_passed=true
+    local damaged="$(mktemp)" foreign="$(mktemp)" output
+    # our magic, then a header with zero sizes
+    printf 'MYSHHIST\001\000\000\000' > "$damaged"
+    head -c 100 /dev/zero >> "$damaged"
+    output="$(MY_SHELL_HISTFILE="$damaged" timeout $TIMEOUT "$SHELL_BINARY" -c "echo fresh
+record" 2>&1)"
+    if echo "$output" | grep -q "damaged history file, starting a new one" &&
+        echo "$output" | grep -Eq '^ 1  echo fresh$'; then
+        log_success "Damaged file replaced by a new history"
+    else
+        log_error "Damaged history file not recreated"
+        echo "$output" | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    echo "not a history file" > "$foreign"
+    output="$(MY_SHELL_HISTFILE="$foreign" timeout $TIMEOUT "$SHELL_BINARY" -c "echo mem" 2>&1)"
+    if echo "$output" | grep -q "keeping history in memory" && [ "$(cat "$foreign")" == "not a history file" ]; then
+        log_success "Foreign file left untouched, history kept in memory"
+    else
+        log_error "Foreign file was modified or not reported"
+        test_passed=false
+    fi
+
+    rm -f "$damaged" "$foreign"
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "歷史紀錄測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+    log_info "Using history file: $HIST_FILE"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_record_replay test_persistence test_record_pages test_damaged_file; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    rm -f "$HIST_FILE"
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有歷史紀錄測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 shell 的歷史紀錄實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
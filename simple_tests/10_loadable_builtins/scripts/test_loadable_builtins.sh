@@ -0,0 +1,158 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Built-in Dispatch and Loadable Built-ins
+# Purpose:
+#   - Verify `builtin` lists every static built-in
+#   - Verify `builtin -f lib.so name` loads a built-in from a shared object,
+#     which then runs in the shell and inside pipelines
+#   - Verify static built-ins cannot be replaced and `builtin -d` unloads
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 10_loadable_builtins
+#   - Or run directly:
+#       bash simple_tests/10_loadable_builtins/scripts/test_loadable_builtins.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+TEST_DATA_DIR="$SCRIPT_DIR/../test_data"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=10
+TEMP_DIR="$(mktemp -d)"
+PLUGIN="$TEMP_DIR/hello_builtin.so"
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Compare output against the expected text, dump it on mismatch
+expect_output() {
+    local desc="$1" expected="$2" actual="$3"
+    if [ "$actual" == "$expected" ]; then
+        log_success "$desc"
+        return 0
+    fi
+    log_error "$desc"
+    log_info "Expected:"
+    echo "$expected" | sed 's/^/  > /'
+    log_info "Actual output:"
+    echo "$actual" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 1: builtin lists the static built-ins
+test_list_builtins() {
+    log_section "測試 1: builtin 列出內建命令"
+
+    local output
+    output="$(timeout $TIMEOUT "$SHELL_BINARY" -c "builtin | grep -c '^builtin '")"
+    local count
+    count="$(grep -c '^BUILTIN(' "$PROJECT_ROOT/include/builtins.def")"
+
+    expect_output "builtin lists all $count static built-ins" "$count" "$output"
+}
+
+# Test 2: load a built-in from a shared object
+test_load_builtin() {
+    log_section "測試 2: builtin -f 載入共享函式庫"
+
+    if ! gcc -shared -fPIC -I "$PROJECT_ROOT/include" "$TEST_DATA_DIR/hello_builtin.c" -o "$PLUGIN"; then
+        log_error "Failed to compile the sample built-in"
+        return 1
+    fi
+
+    local output
+    output="$(timeout $TIMEOUT "$SHELL_BINARY" -c "builtin -f $PLUGIN hello
+hello
+hello shell | cat
+builtin hello")"
+
+    expect_output "hello runs in the shell and in a pipeline" "hello, world
+hello, shell" "$output"
+}
+
+# Test 3: static built-ins are protected, loaded ones can be unloaded
+test_replace_unload() {
+    log_section "測試 3: 不可取代靜態內建命令、builtin -d 卸載"
+
+    local output
+    output="$(timeout $TIMEOUT "$SHELL_BINARY" -c "builtin -f $PLUGIN echo
+builtin -f $PLUGIN hello
+builtin -d hello
+hello" 2>&1)"
+
+    expect_output "echo is refused and hello is gone after -d" "builtin: echo: cannot replace a static built-in
+hello: command not found" "$output"
+}
+
+main() {
+    log_section "內建命令載入測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_list_builtins test_load_builtin test_replace_unload; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    rm -rf "$TEMP_DIR"
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有內建命令載入測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 shell 的內建命令實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
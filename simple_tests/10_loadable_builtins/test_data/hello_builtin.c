@@ -0,0 +1,18 @@
+/*
+ * hello_builtin.c - Sample loadable built-in for `builtin -f`
+ *
+ * Build: gcc -shared -fPIC -I include hello_builtin.c -o hello_builtin.so
+ */
+
+#include <unistd.h>
+
+#include "builtin.h"
+#include "output.h"
+
+/* Built-in: hello [name] - greet from a shared object */
+int hello(struct process *proc, int in_fd, int out_fd)
+{
+    (void) in_fd;
+    pprintf(out_fd, "hello, %s\n", proc->argc > 1 ? proc->argv[1] : "world");
+    return 1;
+}
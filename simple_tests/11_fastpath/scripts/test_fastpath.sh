@@ -0,0 +1,229 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: In-shell Fast Paths (cat, head, tail, wc, tee)
+# Purpose:
+#   - Verify every fast path prints exactly what the external binary prints
+#     (MY_SHELL_FASTPATH=none) for files, pipes and redirects
+#   - Verify an early-exiting reader (yes | head) ends the pipeline
+#   - Verify unsupported options still run the external binary
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 11_fastpath
+#   - Or run directly:
+#       bash simple_tests/11_fastpath/scripts/test_fastpath.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=10
+TEMP_DIR="$(mktemp -d)"
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Run a command line in TEMP_DIR with the given MY_SHELL_FASTPATH value
+run_shell() {
+    (cd "$TEMP_DIR" && MY_SHELL_FASTPATH="$1" timeout $TIMEOUT "$SHELL_BINARY" -c "$2" 2>&1)
+}
+
+# Test 1: fast paths match the external binaries
+test_same_output() {
+    log_section "測試 1: 快速路徑與外部程式輸出一致"
+
+    seq 1 50000 > "$TEMP_DIR/nums.txt"
+    printf 'one two\n  three\tfour five\nno newline' > "$TEMP_DIR/words.txt"
+
+    local cases=(
+        "cat nums.txt | wc -l"
+        "cat words.txt nums.txt | head -n 3"
+        "cat < words.txt"
+        "head nums.txt"
+        "head -5 nums.txt | tail -2"
+        "head -c 100 nums.txt | wc -c"
+        "tail -n 3 nums.txt"
+        "tail -c 10 words.txt"
+        "seq 1 20000 | tail -n 4"
+        "tail -n 0 nums.txt"
+        "cat words.txt | tail -1"
+        "wc words.txt"
+        "wc -lw nums.txt"
+        "cat words.txt | wc"
+        "wc -c < nums.txt"
+        "seq 1 1000 | tee copy.txt | wc -l"
+        "cat copy.txt | tail -n 1"
+        "cat nums.txt > out.txt"
+        "wc -l out.txt"
+    )
+
+    local test_passed=true
+    for c in "${cases[@]}"; do
+        local fast ext
+        ext="$(run_shell none "$c")"
+        fast="$(run_shell all "$c")"
+        if [ "$fast" == "$ext" ]; then
+            log_success "$c"
+        else
+            log_error "$c"
+            log_info "External:"
+            echo "$ext" | head -5 | sed 's/^/  > /'
+            log_info "Fast path:"
+            echo "$fast" | head -5 | sed 's/^/  > /'
+            test_passed=false
+        fi
+    done
+
+    [ "$test_passed" = true ]
+}
+
+# Test 2: a reader that exits early ends the pipeline
+test_early_exit() {
+    log_section "測試 2: 下游提早結束 (yes | cat | head -n 2)"
+
+    local output
+    output="$(run_shell all "yes | cat | head -n 2")"
+    local exit_code=$?
+
+    if [ $exit_code -eq 124 ]; then
+        log_error "Pipeline did not finish after head exited (timed out after ${TIMEOUT}s)"
+        return 1
+    fi
+    if [ "$output" == $'y\ny' ]; then
+        log_success "Pipeline stopped after two lines"
+        return 0
+    fi
+    log_error "Unexpected output"
+    echo "$output" | head -5 | sed 's/^/  > /'
+    return 1
+}
+
+# Test 3: unsupported options fall back to the external binary
+test_fallback() {
+    log_section "測試 3: 不支援的選項使用外部程式 (cat -n)"
+
+    local output
+    output="$(run_shell all "head -2 nums.txt | cat -n")"
+
+    if [ "$output" == "$(head -2 "$TEMP_DIR/nums.txt" | cat -n)" ]; then
+        log_success "cat -n ran the external cat"
+        return 0
+    fi
+    log_error "Unexpected output for cat -n"
+    echo "$output" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 4: only stages reading regular files or the job's own pipes stay in the shell
+test_blocking_input() {
+    log_section "測試 4: 可能阻塞的輸入在子行程執行"
+
+    local test_passed=true
+    local output
+    output="$(run_shell all "cat nums.txt > /dev/null
+wc -l < nums.txt > /dev/null
+head -n 1 nums.txt | tail -n 1 > /dev/null
+stats")"
+    if echo "$output" | grep -Eq '^processes +1$'; then
+        log_success "Regular files and job pipes are read inside the shell"
+    else
+        log_error "Expected only 'head' to be forked"
+        echo "$output" | grep '^processes' | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    mkfifo "$TEMP_DIR/fifo"
+    local c
+    for c in "cat < /dev/zero > /dev/null" "wc -l < /dev/zero" "cat fifo"; do
+        (cd "$TEMP_DIR" && exec timeout $TIMEOUT "$SHELL_BINARY" -c "$c
+echo after" > "$TEMP_DIR/blocking.out" 2>&1) &
+        local shell_pid=$! child=""
+        for _ in $(seq 1 40); do # up to ~2s
+            child="$(pgrep -P "$(pgrep -P $shell_pid | head -1)" 2>/dev/null | head -1)"
+            [ -n "$child" ] && break
+            sleep 0.05
+        done
+        [ -n "$child" ] && kill "$child"
+        wait $shell_pid
+        if [ -n "$child" ] && grep -qx after "$TEMP_DIR/blocking.out"; then
+            log_success "$c: runs in a child that kill can stop"
+        else
+            log_error "$c: no child to kill, the shell itself was blocked"
+            test_passed=false
+        fi
+    done
+    rm -f "$TEMP_DIR/fifo"
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "快速路徑測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_same_output test_early_exit test_fallback test_blocking_input; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    rm -rf "$TEMP_DIR"
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有快速路徑測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 shell 的快速路徑實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
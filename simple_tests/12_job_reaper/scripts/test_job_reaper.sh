@@ -0,0 +1,186 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Background Job Reaper
+# Purpose:
+#   - Verify finished background jobs are reported with a "[id] Done" line
+#     before the next prompt
+#   - Verify thousands of background jobs are all reaped: no zombies are left
+#     and job ids are reused instead of running out
+#   - Verify a job killed by a signal is reported as "Terminated"
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 12_job_reaper
+#   - Or run directly:
+#       bash simple_tests/12_job_reaper/scripts/test_job_reaper.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+JOBS=2000
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Test 1: a finished job is reported before the next prompt
+test_done_line() {
+    log_section "測試 1: 背景工作完成時印出 Done"
+
+    local output
+    output="$(printf 'sleep 0.1 &\nsleep 0.5\necho next\n' | timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+
+    # the Done line must come right before the prompt that reads "echo next"
+    # (it follows the previous prompt, which ends without a newline)
+    if echo "$output" | grep -B1 -m1 'next$' | head -1 | grep -q $'\\[1\\] Done\tsleep 0.1 &$'; then
+        log_success "[1] Done line printed before the next prompt"
+        return 0
+    fi
+    log_error "Missing or misplaced Done line"
+    log_info "Actual output:"
+    echo "$output" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 2: thousands of jobs are reaped and their ids reused
+test_many_jobs() {
+    log_section "測試 2: 大量背景工作 ($JOBS 個 true &)"
+
+    local temp_input="$(mktemp)"
+    local temp_output="$(mktemp)"
+    for _ in $(seq 1 $JOBS); do
+        echo "true &"
+    done > "$temp_input"
+    cat >> "$temp_input" << 'EOF'
+sleep 1
+sh -c 'echo children: $(cat /proc/$PPID/task/*/children)'
+EOF
+
+    timeout $TIMEOUT "$SHELL_BINARY" < "$temp_input" > "$temp_output" 2>&1
+    local exit_code=$?
+
+    local test_passed=true
+    if [ $exit_code -eq 124 ]; then
+        log_error "Shell timed out after ${TIMEOUT}s"
+        test_passed=false
+    fi
+
+    local done_count
+    done_count=$(grep -o $'\\[[0-9]*\\] Done\ttrue &$' "$temp_output" | wc -l)
+    if [ "$done_count" -eq $JOBS ]; then
+        log_success "All $JOBS jobs reported Done"
+    else
+        log_error "Only $done_count of $JOBS jobs reported Done"
+        test_passed=false
+    fi
+
+    local max_id
+    max_id=$(grep -o '^\[[0-9]*\] [0-9]*$' "$temp_output" | tr -d '[' | cut -d']' -f1 | sort -n | tail -1)
+    if [ -n "$max_id" ] && [ "$max_id" -lt $JOBS ]; then
+        log_success "Job ids were reused (highest id: $max_id)"
+    else
+        log_error "Job ids were not reused (highest id: ${max_id:-none})"
+        test_passed=false
+    fi
+
+    # the sh child itself is the only child left
+    local children
+    children=$(grep -o 'children:.*' "$temp_output" | tail -1 | wc -w)
+    if [ "$children" -eq 2 ]; then
+        log_success "No zombie children left"
+    else
+        log_error "$((children - 2)) extra children left behind"
+        test_passed=false
+    fi
+
+    rm -f "$temp_input" "$temp_output"
+    [ "$test_passed" = true ]
+}
+
+# Test 3: a job killed by a signal is reported as Terminated
+test_terminated() {
+    log_section "測試 3: 被信號終止的工作印出 Terminated"
+
+    local output
+    output="$(printf "sh -c 'kill \$\$' &\nsleep 0.5\necho next\n" | timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+
+    if echo "$output" | grep -q $'\\[1\\] Terminated\t'; then
+        log_success "Killed job reported as Terminated"
+        return 0
+    fi
+    log_error "Missing Terminated line"
+    log_info "Actual output:"
+    echo "$output" | sed 's/^/  > /'
+    return 1
+}
+
+main() {
+    log_section "背景工作回收測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_done_line test_many_jobs test_terminated; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有背景工作回收測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 shell 的背景工作回收實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
@@ -0,0 +1,187 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Process Supervision (timeout / wait)
+# Purpose:
+#   - Verify `timeout` kills a command at its deadline, also inside a pipeline,
+#     and escalates to SIGKILL when SIGTERM is ignored
+#   - Verify `timeout` does not delay a command that finishes in time
+#   - Verify `wait` blocks until every background job is done and `wait -n`
+#     returns as soon as the first one finishes
+#   - Verify `wait %N` rejects an unknown job
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 13_supervision
+#   - Or run directly:
+#       bash simple_tests/13_supervision/scripts/test_supervision.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Helper: milliseconds since the epoch
+now_ms() { echo $(( $(date +%s%N) / 1000000 )); }
+
+# Helper: run the shell on $1, store output in $OUTPUT and wall time in $ELAPSED
+run_shell() {
+    local start=$(now_ms)
+    OUTPUT="$(printf "$1" | timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+    ELAPSED=$(( $(now_ms) - start ))
+}
+
+# Test 1: timeout kills a long command at the deadline
+test_timeout_kill() {
+    log_section "測試 1: timeout 在期限到時終止命令"
+
+    run_shell 'timeout 0.3 sleep 5\necho after\n'
+    if [ $ELAPSED -lt 2000 ] && echo "$OUTPUT" | grep -q 'after$'; then
+        log_success "sleep 5 killed after ${ELAPSED}ms"
+        return 0
+    fi
+    log_error "timeout did not kill the command in time (${ELAPSED}ms)"
+    echo "$OUTPUT" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 2: a command that finishes in time is not delayed
+test_timeout_fast() {
+    log_section "測試 2: 提早結束的命令不受影響"
+
+    run_shell 'timeout 10 echo ok\n'
+    if [ $ELAPSED -lt 2000 ] && echo "$OUTPUT" | grep -q 'ok$'; then
+        log_success "timeout 10 echo ok returned after ${ELAPSED}ms"
+        return 0
+    fi
+    log_error "Unexpected output or delay (${ELAPSED}ms)"
+    echo "$OUTPUT" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 3: timeout inside a pipeline and SIGKILL escalation
+test_timeout_pipeline() {
+    log_section "測試 3: 管線中的 timeout 與 SIGKILL"
+
+    local test_passed=true
+    run_shell 'timeout 0.2 sleep 5 | cat\n'
+    if [ $ELAPSED -lt 2000 ]; then
+        log_success "timeout in a pipeline ended the job after ${ELAPSED}ms"
+    else
+        log_error "Pipeline with timeout took ${ELAPSED}ms"
+        test_passed=false
+    fi
+
+    # SIGTERM is ignored, so the group is killed after the 1s grace period
+    run_shell "timeout 0.2 sh -c 'trap \"\" TERM; sleep 5'\n"
+    if [ $ELAPSED -ge 1000 ] && [ $ELAPSED -lt 3000 ]; then
+        log_success "SIGTERM-proof command killed after ${ELAPSED}ms"
+    else
+        log_error "SIGKILL escalation took ${ELAPSED}ms"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 4: wait and wait -n
+test_wait() {
+    log_section "測試 4: wait 與 wait -n"
+
+    local test_passed=true
+    run_shell "sh -c 'sleep 0.4; echo slow' &\nsh -c 'sleep 0.1; echo fast' &\nwait -n\necho between\nwait\necho end\n"
+    local order
+    order="$(echo "$OUTPUT" | grep -o -E '(slow|fast|between|end)$' | tr '\n' ' ')"
+    if [ "$order" = "fast between slow end " ]; then
+        log_success "wait -n returned after the first job, wait after the last"
+    else
+        log_error "Unexpected order: $order"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+    if echo "$OUTPUT" | grep -q 'Done'; then
+        log_error "Jobs collected by wait must not be reported Done"
+        test_passed=false
+    fi
+
+    run_shell 'wait %%7\n'
+    if echo "$OUTPUT" | grep -q 'wait: %7: no such job'; then
+        log_success "Unknown job rejected"
+    else
+        log_error "Missing error for wait %7"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "行程監督測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_timeout_kill test_timeout_fast test_timeout_pipeline test_wait; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有行程監督測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 timeout 與 wait 的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
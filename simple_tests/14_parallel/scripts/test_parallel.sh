@@ -0,0 +1,179 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: parallel Built-in
+# Purpose:
+#   - Verify every input line runs once, with {} substituted or appended
+#   - Verify -k writes the outputs in input order and that each item's output
+#     stays in one piece
+#   - Verify -j N bounds the number of running children
+#   - Verify the final items/s and latency report
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 14_parallel
+#   - Or run directly:
+#       bash simple_tests/14_parallel/scripts/test_parallel.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Helper: milliseconds since the epoch
+now_ms() { echo $(( $(date +%s%N) / 1000000 )); }
+
+
+# Helper: run the shell on $1, store stdout/stderr in $OUTPUT and wall time in $ELAPSED
+run_shell() {
+    local start=$(now_ms)
+    OUTPUT="$(printf "$1" | timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+    ELAPSED=$(( $(now_ms) - start ))
+}
+
+# Test 1: every item runs once
+test_all_items() {
+    log_section "測試 1: 每一行輸入執行一次"
+
+    local test_passed=true
+    run_shell 'seq 1 500 | parallel -j 8 echo item-{}\n'
+    local got
+    got=$(echo "$OUTPUT" | grep -o 'item-[0-9]*$' | sort -t- -k2 -n | uniq | wc -l)
+    if [ "$got" -eq 500 ] && [ "$(echo "$OUTPUT" | grep -c 'item-[0-9]*$')" -eq 500 ]; then
+        log_success "500 items, each run exactly once"
+    else
+        log_error "Expected 500 distinct items, got $got"
+        test_passed=false
+    fi
+
+    # without {} the item is appended as the last argument
+    run_shell 'seq 3 | parallel -k echo n\n'
+    if [ "$(echo "$OUTPUT" | grep -c -E 'n [123]$')" -eq 3 ]; then
+        log_success "Item appended when the template has no {}"
+    else
+        log_error "Item not appended"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 2: -k keeps input order, output of an item is never interleaved
+test_keep_order() {
+    log_section "測試 2: -k 保持輸入順序"
+
+    run_shell "seq 1 40 | parallel -j 8 -k sh -c 'sleep 0.0\$((\$1 %% 7)); echo begin \$1; echo end \$1' sh\n"
+    local expected actual
+    expected="$(for i in $(seq 1 40); do echo "begin $i"; echo "end $i"; done)"
+    actual="$(echo "$OUTPUT" | grep -o -E '(begin|end) [0-9]+$')"
+    if [ "$expected" = "$actual" ]; then
+        log_success "Outputs grouped per item and in input order"
+        return 0
+    fi
+    log_error "Outputs out of order or interleaved"
+    diff <(echo "$expected") <(echo "$actual") | head -10 | sed 's/^/  > /'
+    return 1
+}
+
+# Test 3: -j bounds concurrency
+test_concurrency() {
+    log_section "測試 3: -j 限制同時執行數量"
+
+    local test_passed=true
+    run_shell 'seq 1 8 | parallel -j 4 sh -c "sleep 0.3"\n'
+    if [ $ELAPSED -ge 550 ] && [ $ELAPSED -lt 1500 ]; then
+        log_success "8 items of 0.3s with -j 4 took ${ELAPSED}ms (two waves)"
+    else
+        log_error "8 items of 0.3s with -j 4 took ${ELAPSED}ms"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 4: the final report
+test_report() {
+    log_section "測試 4: 結束時的統計報告"
+
+    # items 5 and 10 fail
+    run_shell "seq 1 10 | parallel -j 2 sh -c 'exit \$((\$0 %% 5 == 0))'\n"
+    if echo "$OUTPUT" | grep -q -E 'parallel: 10 items \(2 failed\) in [0-9.]+s, [0-9.]+ items/s, latency p50 [0-9.]+ms p95 [0-9.]+ms p99 [0-9.]+ms max [0-9.]+ms'; then
+        log_success "Report shows items, failures, throughput and tail latency"
+        return 0
+    fi
+    log_error "Missing or malformed report"
+    echo "$OUTPUT" | sed 's/^/  > /'
+    return 1
+}
+
+main() {
+    log_section "parallel 內建命令測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_all_items test_keep_order test_concurrency test_report; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有 parallel 測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 parallel 的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
@@ -0,0 +1,174 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: xargs Built-in
+# Purpose:
+#   - Verify every input item is passed exactly once
+#   - Verify batches fill up to ARG_MAX: a 2.6MB file list needs only a few
+#     execs of /bin/echo and none fails with "Argument list too long"
+#   - Verify -n N, -0 and -P N
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 15_xargs
+#   - Or run directly:
+#       bash simple_tests/15_xargs/scripts/test_xargs.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Helper: milliseconds since the epoch
+now_ms() { echo $(( $(date +%s%N) / 1000000 )); }
+
+
+# Helper: run the shell on $1, store stdout/stderr in $OUTPUT and wall time in $ELAPSED
+run_shell() {
+    local start=$(now_ms)
+    OUTPUT="$(printf "$1" | timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+    ELAPSED=$(( $(now_ms) - start ))
+}
+
+# Test 1: items passed once, few execs for a big list
+test_batching() {
+    log_section "測試 1: 依 ARG_MAX 打包參數"
+
+    local list="$(mktemp)"
+    for i in $(seq 1 40000); do
+        echo "/tmp/some/long/directory/name/for/testing/purposes/file_$i.txt"
+    done > "$list"
+
+    run_shell "xargs /bin/echo < $list | wc\n"
+    rm -f "$list"
+
+    local lines words
+    read -r lines words _ <<< "$(echo "$OUTPUT" | grep -o -E '[0-9]+ +[0-9]+ +[0-9]+$' | tail -1)"
+    if [ "$words" = "40000" ] && [ "$lines" -ge 1 ] && [ "$lines" -le 4 ] && ! echo "$OUTPUT" | grep -q 'too long'; then
+        log_success "40000 paths passed in $lines exec(s)"
+        return 0
+    fi
+    log_error "Expected 40000 words in at most 4 execs, got '$words' words in '$lines' lines"
+    echo "$OUTPUT" | head -5 | sed 's/^/  > /'
+    return 1
+}
+
+# Test 2: -n and -0
+test_options() {
+    log_section "測試 2: -n 與 -0"
+
+    local test_passed=true
+    run_shell 'seq 10 | xargs -n 3 echo\n'
+    if [ "$(echo "$OUTPUT" | grep -c -E '^(:.*\$ )?([0-9]+ ?){1,3}$')" -eq 4 ] && echo "$OUTPUT" | grep -q '^10$'; then
+        log_success "-n 3 splits 10 items into 4 execs"
+    else
+        log_error "-n 3 output unexpected"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    run_shell 'printf "a b\\0c\\0" | xargs -0 -n 1 echo\n'
+    if echo "$OUTPUT" | grep -q 'a b$' && echo "$OUTPUT" | grep -q '^c$'; then
+        log_success "-0 keeps blanks inside items"
+    else
+        log_error "-0 output unexpected"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    run_shell 'echo a | xargs -n abc echo ran\necho a | xargs -P 0 echo ran\n'
+    if [ "$(echo "$OUTPUT" | grep -c 'usage: xargs')" -eq 2 ] && ! echo "$OUTPUT" | grep -q 'ran\|abc\|^0'; then
+        log_success "Bad -n/-P values print the usage instead of running"
+    else
+        log_error "Bad option values should not be run as the command"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 3: -P overlaps batches
+test_workers() {
+    log_section "測試 3: -P 同時執行多個批次"
+
+    run_shell 'seq 1 8 | xargs -n 1 -P 4 sh -c "sleep 0.3" sh\n'
+    if [ $ELAPSED -ge 550 ] && [ $ELAPSED -lt 1500 ]; then
+        log_success "8 batches of 0.3s with -P 4 took ${ELAPSED}ms"
+        return 0
+    fi
+    log_error "8 batches of 0.3s with -P 4 took ${ELAPSED}ms"
+    return 1
+}
+
+main() {
+    log_section "xargs 內建命令測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_batching test_options test_workers; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有 xargs 測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 xargs 的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
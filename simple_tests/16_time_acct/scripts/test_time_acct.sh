@@ -0,0 +1,187 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: time Prefix and Resource Accounting
+# Purpose:
+#   - Verify `time pipeline` prints one line per stage plus a job total
+#   - Verify CPU time is charged to the stage that used it
+#   - Verify exit statuses and signals are reported per stage
+#   - Verify MY_SHELL_ACCT=path appends JSON lines for every job
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 16_time_acct
+#   - Or run directly:
+#       bash simple_tests/16_time_acct/scripts/test_time_acct.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Helper: milliseconds since the epoch
+now_ms() { echo $(( $(date +%s%N) / 1000000 )); }
+
+
+# Helper: run the shell on $1, store stdout/stderr in $OUTPUT and wall time in $ELAPSED
+run_shell() {
+    local start=$(now_ms)
+    OUTPUT="$(printf "$1" | timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+    ELAPSED=$(( $(now_ms) - start ))
+}
+
+# Test 1: per-stage and job lines
+test_time_lines() {
+    log_section "測試 1: time 印出每個階段與整個工作"
+
+    run_shell 'time sleep 0.2 | cat\n'
+    local test_passed=true
+    if echo "$OUTPUT" | grep -q -E '^1 +[0-9]+ +0 +0\.[0-9]{3}s .* sleep 0\.2$' &&
+       echo "$OUTPUT" | grep -q -E '^2 +(shell|[0-9]+) +0 .* cat$' &&
+       echo "$OUTPUT" | grep -q -E '^job +0\.2[0-9]{2}s'; then
+        log_success "Stage lines and a ~0.2s job total printed"
+    else
+        log_error "Unexpected time report"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    run_shell 'sleep 0.1\n'
+    if echo "$OUTPUT" | grep -q '^job'; then
+        log_error "Report printed without time or MY_SHELL_ACCT"
+        test_passed=false
+    else
+        log_success "No report without time"
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 2: CPU time goes to the stage that burns it
+test_cpu_attribution() {
+    log_section "測試 2: CPU 時間歸屬到正確的階段"
+
+    run_shell "time sh -c 'i=0; while [ \$i -lt 300000 ]; do i=\$((i+1)); done; echo done' | cat\n"
+    local busy idle
+    busy=$(echo "$OUTPUT" | grep -E '^1 ' | awk '{print $5}' | tr -d s)
+    idle=$(echo "$OUTPUT" | grep -E '^2 ' | awk '{print $5}' | tr -d s)
+    if [ -n "$busy" ] && awk "BEGIN { exit !($busy > 0.05 && $busy > 10 * $idle) }"; then
+        log_success "Busy stage user ${busy}s, idle stage user ${idle}s"
+        return 0
+    fi
+    log_error "CPU time not attributed to the busy stage (busy=$busy idle=$idle)"
+    echo "$OUTPUT" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 3: statuses and signals
+test_status() {
+    log_section "測試 3: 結束狀態與信號"
+
+    run_shell "time yes | head -c 1000 | sh -c 'cat >/dev/null; exit 3'\n"
+    if echo "$OUTPUT" | grep -q -E '^1 +[0-9]+ +sig13 .* yes$' &&
+       echo "$OUTPUT" | grep -q -E '^3 +[0-9]+ +3 '; then
+        log_success "SIGPIPE and exit 3 reported on their stages"
+        return 0
+    fi
+    log_error "Statuses not reported"
+    echo "$OUTPUT" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 4: JSON lines log
+test_json() {
+    log_section "測試 4: MY_SHELL_ACCT 寫出 JSON lines"
+
+    local log="$(mktemp)"
+    rm -f "$log"
+    OUTPUT="$(printf 'echo a | cat\nsleep 0.1\n' | MY_SHELL_ACCT="$log" timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+
+    local test_passed=true
+    if [ "$(grep -c '"type":"stage"' "$log")" -eq 3 ] && [ "$(grep -c '"type":"job"' "$log")" -eq 2 ] &&
+       grep -q '"type":"job","stages":2,.*"cmd":"echo a | cat"}$' "$log"; then
+        log_success "3 stage and 2 job records logged"
+    else
+        log_error "Unexpected JSON log"
+        sed 's/^/  > /' "$log"
+        test_passed=false
+    fi
+    if echo "$OUTPUT" | grep -q '^job'; then
+        log_error "JSON mode must not print the table"
+        test_passed=false
+    fi
+    rm -f "$log"
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "time 與資源統計測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_time_lines test_cpu_attribution test_status test_json; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有 time 與資源統計測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查資源統計的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
@@ -0,0 +1,210 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Launch-Latency Tracing
+# Purpose:
+#   - Verify the default build has no tracing code and `trace` says so
+#   - Verify a `make trace` build writes strict trace-event JSON with the
+#     shell's phases (parse, lex, pipe, spawn, wait) and one named track per
+#     child pid, both with MY_SHELL_TRACE and with `trace on FILE`
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 17_trace
+#   - Or run directly:
+#       bash simple_tests/17_trace/scripts/test_trace.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Helper: milliseconds since the epoch
+now_ms() { echo $(( $(date +%s%N) / 1000000 )); }
+
+
+# Helper: run the shell on $1, store stdout/stderr in $OUTPUT and wall time in $ELAPSED
+run_shell() {
+    local start=$(now_ms)
+    OUTPUT="$(printf "$1" | timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+    ELAPSED=$(( $(now_ms) - start ))
+}
+
+TRACE_BUILD=""
+
+# Helper: build a tracing shell out of tree, so the tested binary stays untouched
+build_trace_shell() {
+    TRACE_BUILD="$(mktemp -d)"
+    make -s -C "$PROJECT_ROOT" OBJDIR="$TRACE_BUILD/obj" TARGET="$TRACE_BUILD/my_shell" trace >/dev/null 2>&1
+    [ -x "$TRACE_BUILD/my_shell" ]
+}
+
+# Helper: count events named $2 in trace file $1
+count_events() {
+    grep -o "\"name\":\"$2\"" "$1" | wc -l
+}
+
+# Test 1: compiled out by default
+test_default_build() {
+    log_section "測試 1: 預設編譯不含追蹤程式碼"
+
+    local test_passed=true
+    if nm "$SHELL_BINARY" 2>/dev/null | grep -q trace_span; then
+        log_error "Default build contains trace_span"
+        test_passed=false
+    else
+        log_success "No tracing code in the default build"
+    fi
+
+    run_shell 'trace on /dev/null\n'
+    if echo "$OUTPUT" | grep -q 'trace: not compiled in'; then
+        log_success "trace reports that it is not compiled in"
+    else
+        log_error "Unexpected trace output"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 2: MY_SHELL_TRACE
+test_env_trace() {
+    log_section "測試 2: MY_SHELL_TRACE 產生 trace-event JSON"
+
+    local trace="$TRACE_BUILD/env.json"
+    # exit in a forked pipeline stage must not close the shell's trace
+    printf 'ls | sort | wc -l\nexit | cat\nsleep 0.1\n' | MY_SHELL_TRACE="$trace" timeout $TIMEOUT "$TRACE_BUILD/my_shell" >/dev/null 2>&1
+
+    local test_passed=true
+    if command -v python3 >/dev/null 2>&1; then
+        if python3 -c 'import json, sys; json.load(open(sys.argv[1]))' "$trace" 2>/dev/null; then
+            log_success "Trace is valid JSON"
+        else
+            log_error "Trace is not valid JSON"
+            test_passed=false
+        fi
+    fi
+
+    if [ "$(count_events "$trace" trace_end)" -eq 1 ]; then
+        log_success "Only the shell wrote the trace trailer"
+    else
+        log_error "Expected one trace_end event, found $(count_events "$trace" trace_end)"
+        test_passed=false
+    fi
+
+    for ev in parse lex history pipe spawn wait launch_job run; do
+        if [ "$(count_events "$trace" $ev)" -lt 1 ]; then
+            log_error "No '$ev' event"
+            test_passed=false
+        fi
+    done
+    # ls, sort and sleep each get a track; wc runs inside the shell
+    local tracks
+    tracks=$(grep -c -E '"thread_name".*"name":"pid [0-9]+ (ls|sort|sleep)"' "$trace")
+    if [ "$tracks" -eq 3 ]; then
+        log_success "Shell phases and 3 child tracks recorded"
+    else
+        log_error "Expected 3 child tracks, found $tracks"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 3: trace on / off
+test_builtin_trace() {
+    log_section "測試 3: trace on FILE 與 trace off"
+
+    local trace="$TRACE_BUILD/builtin.json"
+    printf "echo before\ntrace on $trace\nsleep 0.05\ntrace off\nsleep 0.05\n" |
+        timeout $TIMEOUT "$TRACE_BUILD/my_shell" >/dev/null 2>&1
+
+    if [ "$(count_events "$trace" run)" -eq 1 ] && ! grep -q 'echo before' "$trace" && tail -1 "$trace" | grep -q '^]$'; then
+        log_success "Only the command between trace on and off was traced"
+        return 0
+    fi
+    log_error "Unexpected trace contents"
+    sed 's/^/  > /' "$trace" | head -20
+    return 1
+}
+
+main() {
+    log_section "啟動延遲追蹤測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    local tests="test_default_build"
+    if build_trace_shell; then
+        tests="$tests test_env_trace test_builtin_trace"
+    else
+        log_error "make trace failed"
+        total_tests=1
+    fi
+
+    for t in $tests; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+    rm -rf "$TRACE_BUILD"
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有追蹤測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查追蹤的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
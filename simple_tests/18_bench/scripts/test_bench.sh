@@ -0,0 +1,195 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Benchmark Suite
+# Purpose:
+#   - Verify shell_bench prints a TSV row for every parse, launch, batch and
+#     pipeline case
+#   - Verify bench.sh passes against its own baseline and flags rows that are
+#     slower than the tolerance allows
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 18_bench
+#   - Or run directly:
+#       bash simple_tests/18_bench/scripts/test_bench.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=300
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+BENCH_BUILD=""
+
+# Helper: build the benchmark out of tree at a tiny scale, so the test stays fast
+build_bench() {
+    BENCH_BUILD="$(mktemp -d)"
+    make -s -C "$PROJECT_ROOT" OBJDIR="$BENCH_BUILD" TARGET="$BENCH_BUILD/my_shell" bench-build >/dev/null 2>&1
+    [ -x "$BENCH_BUILD/shell_bench" ]
+}
+
+# Helper: run bench.sh with baseline $1 and extra arguments, store output in $OUTPUT and exit code in $RC
+run_bench() {
+    local baseline="$1"
+    shift
+    OUTPUT="$(BENCH_SCALE=0.02 BENCH_BASELINE="$baseline" timeout $TIMEOUT bash "$PROJECT_ROOT/simple_tests/benchmarks/bench.sh" "$BENCH_BUILD" "$@" 2>&1)"
+    RC=$?
+}
+
+# Test 1: every case produces its rows
+test_results() {
+    log_section "測試 1: 產生完整的 TSV 結果"
+
+    run_bench "$BENCH_BUILD/baseline.tsv" --update
+    local results="$BENCH_BUILD/bench.tsv"
+    local test_passed=true
+    if [ $RC -ne 0 ] || ! cmp -s "$results" "$BENCH_BUILD/baseline.tsv"; then
+        log_error "bench.sh --update failed (rc=$RC)"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        return 1
+    fi
+
+    for c in parse/simple parse/argv-512 segment/argv-512 parse/pipeline-64 parse/quoted-128 parse/replay-16 \
+             parse/cached-simple parse/cached-pipeline-64 parse/cached-replay-16 \
+             launch/true launch/builtin launch/pipe-2 launch/pipe-8 batch/true batch/builtin \
+             pipe/fastpath-3 pipe/external-3 pipe/external-1m-3 pipe/auto-3; do
+        if ! grep -q -P "^$c\trate\t[0-9.]+\t\S+/s$" "$results"; then
+            log_error "No rate row for $c"
+            test_passed=false
+        fi
+    done
+    for m in p50 p99; do
+        if [ "$(grep -c -P "^launch/\S+\t$m\t[0-9.]+\tus$" "$results")" -ne 4 ]; then
+            log_error "Expected 4 launch $m rows"
+            test_passed=false
+        fi
+        for c in complete/path-10k history/search-20k history/search-200k; do
+            if ! grep -q -P "^$c\t$m\t[0-9.]+\tus$" "$results"; then
+                log_error "No $m row for $c"
+                test_passed=false
+            fi
+        done
+    done
+    if [ "$test_passed" = true ]; then
+        log_success "$(($(wc -l < "$results") - 1)) rows with rates and latency percentiles"
+    else
+        sed 's/^/  > /' "$results"
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 2: comparison against a baseline
+test_compare() {
+    log_section "測試 2: 與基準比較"
+
+    local test_passed=true
+    run_bench "$BENCH_BUILD/baseline.tsv"
+    if [ $RC -eq 0 ] && ! echo "$OUTPUT" | grep -q REGRESSION; then
+        log_success "Own baseline passes"
+    else
+        BENCH_TOLERANCE=1000 run_bench "$BENCH_BUILD/baseline.tsv"
+        if [ $RC -eq 0 ]; then
+            log_warn "Own baseline exceeded the default tolerance (noisy machine), passes with 1000%"
+        else
+            log_error "Comparison against own baseline failed (rc=$RC)"
+            echo "$OUTPUT" | sed 's/^/  > /'
+            test_passed=false
+        fi
+    fi
+
+    # a baseline 100x faster than anything measurable must fail every row
+    awk -F'\t' -v OFS='\t' 'NR > 1 { $3 = ($4 ~ /\/s$/) ? $3 * 100 : $3 / 100 } 1' \
+        "$BENCH_BUILD/baseline.tsv" > "$BENCH_BUILD/fast.tsv"
+    run_bench "$BENCH_BUILD/fast.tsv"
+    local rows=$(($(wc -l < "$BENCH_BUILD/fast.tsv") - 1))
+    if [ $RC -ne 0 ] && [ "$(echo "$OUTPUT" | grep -c REGRESSION)" -eq "$rows" ]; then
+        log_success "All $rows rows flagged against a faster baseline"
+    else
+        log_error "Regressions not detected (rc=$RC)"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "效能測試套件測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    local tests=""
+    if build_bench; then
+        tests="test_results test_compare"
+    else
+        log_error "make bench-build failed"
+        total_tests=1
+    fi
+
+    for t in $tests; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+    rm -rf "$BENCH_BUILD"
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有效能測試套件測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查效能測試套件"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
@@ -0,0 +1,180 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Zygote Launch Engine
+# Purpose:
+#   - Verify MY_SHELL_SPAWN=zygote runs commands, pipelines and redirections
+#     with the shell's working directory
+#   - Verify children launched by the fork server are the shell's own, so
+#     exit statuses reach the job table and `time`
+#   - Verify command lines too long for one request and a lost server fall
+#     back to posix_spawn
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 19_zygote
+#   - Or run directly:
+#       bash simple_tests/19_zygote/scripts/test_zygote.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Helper: run the shell with the zygote engine on $1, store stdout/stderr in $OUTPUT
+run_shell() {
+    OUTPUT="$(printf '%b' "$1" | MY_SHELL_SPAWN=zygote timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+}
+
+# Test 1: commands, pipelines, redirections and cd
+test_basic() {
+    log_section "測試 1: 命令、管線、重導向與工作目錄"
+
+    local tmp
+    tmp="$(mktemp -d)"
+    run_shell "cd $tmp\n/bin/pwd\nprintf 'b\\\\na\\\\n' > in.txt\nsort < in.txt | tr a-z A-Z > out.txt\n/bin/cat out.txt\nnosuchcmd\n"
+    local expected="$tmp
+A
+B
+nosuchcmd: command not found"
+    local got
+    got="$(echo "$OUTPUT" | sed 's/^.*>>> \$ //' | grep -v '^$')"
+    rm -rf "$tmp"
+    if [ "$got" = "$expected" ]; then
+        log_success "Commands ran in the shell's cwd with their redirections"
+        return 0
+    fi
+    log_error "Unexpected output"
+    echo "$got" | sed 's/^/  > /'
+    return 1
+}
+
+# Test 2: children belong to the shell
+test_parent() {
+    log_section "測試 2: 子行程的父行程是 shell，結束狀態回到工作表"
+
+    local test_passed=true
+    OUTPUT="$(MY_SHELL_SPAWN=zygote timeout $TIMEOUT "$SHELL_BINARY" -c "sh -c 'ps -o ppid= -p \$\$; ps -o pid= -p \$PPID; ps -o comm= -p \$(ps -o ppid= -p \$PPID)'" 2>&1)"
+    # the fork server is a my_shell too; the shell itself was started by timeout
+    local ppid pid grandparent
+    read -r ppid <<< "$(echo "$OUTPUT" | sed -n 1p)"
+    read -r pid <<< "$(echo "$OUTPUT" | sed -n 2p)"
+    read -r grandparent <<< "$(echo "$OUTPUT" | sed -n 3p)"
+    if [ -n "$ppid" ] && [ "$ppid" = "$pid" ] && [ "$grandparent" = "timeout" ]; then
+        log_success "Child's parent is the shell itself"
+    else
+        log_error "Unexpected parent: $OUTPUT"
+        test_passed=false
+    fi
+
+    run_shell "time sh -c 'exit 3'\nsh -c 'kill -TERM \$\$' &\nsleep 0.3\necho tick\n"
+    if echo "$OUTPUT" | grep -q -E '^1 +[0-9]+ +3 ' && echo "$OUTPUT" | grep -q 'Terminated'; then
+        log_success "Exit status and signal reached time and the job table"
+    else
+        log_error "Exit statuses lost"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 3: fallbacks to posix_spawn
+test_fallback() {
+    log_section "測試 3: 退回 posix_spawn"
+
+    local test_passed=true
+    local long
+    long="$(head -c 70000 /dev/zero | tr '\0' x)"
+    OUTPUT="$(MY_SHELL_SPAWN=zygote timeout $TIMEOUT "$SHELL_BINARY" -c "/bin/echo $long" 2>&1)"
+    if [ "${#OUTPUT}" -eq 70000 ]; then
+        log_success "70000-byte argument launched through posix_spawn"
+    else
+        log_error "Long command line failed (${#OUTPUT} bytes)"
+        test_passed=false
+    fi
+
+    # pkill -P: the server is the shell's only child named my_shell
+    run_shell "sh -c 'pkill -x -P \$PPID my_shell'\nsleep 0.1\n/bin/echo after\n/bin/echo again\n"
+    if echo "$OUTPUT" | grep -q 'zygote: fork server lost' && [ "$(echo "$OUTPUT" | grep -c -E 'after|again')" -eq 2 ] &&
+       [ "$(echo "$OUTPUT" | grep -c 'fork server lost')" -eq 1 ]; then
+        log_success "Lost server reported once, commands keep running"
+    else
+        log_error "Unexpected output after killing the server"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "Zygote 啟動引擎測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_basic test_parent test_fallback; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有 zygote 測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查 zygote 啟動引擎"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
@@ -0,0 +1,188 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Per-Stage Scheduling Prefixes
+# Purpose:
+#   - Verify @cpu=, @nice= and @sched= set the affinity, niceness and policy
+#     of one pipeline stage only, with every launch engine
+#   - Verify @cpu=auto hands consecutive stages distinct allowed CPUs
+#   - Verify bad values are syntax errors and other @words stay arguments
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 20_stage_sched
+#   - Or run directly:
+#       bash simple_tests/20_stage_sched/scripts/test_stage_sched.sh
+# =============================================================================
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+# Helper: run command line $2 with engine $1, store stdout/stderr in $OUTPUT
+run_engine() {
+    OUTPUT="$(MY_SHELL_SPAWN="$1" timeout $TIMEOUT "$SHELL_BINARY" -c "$2" 2>&1)"
+}
+
+# Test 1: nice and policy apply to the prefixed stage only
+test_nice_policy() {
+    log_section "測試 1: @nice= 與 @sched= 只作用於該段"
+
+    # /proc/self/stat field 19 is the niceness, 41 the policy (3 batch, 5 idle)
+    local line="@nice=5 @sched=batch cut -d' ' -f19,41 /proc/self/stat | @sched=idle sh -c 'cat; cut -d\" \" -f19,41 /proc/\$\$/stat'
+cut -d' ' -f19,41 /proc/self/stat"
+    local expected="5 3
+0 5
+0 0"
+    local test_passed=true
+    for engine in posix fork zygote; do
+        run_engine $engine "$line"
+        if [ "$OUTPUT" = "$expected" ]; then
+            log_success "$engine: niceness and policy set per stage"
+        else
+            log_error "$engine: unexpected output"
+            echo "$OUTPUT" | sed 's/^/  > /'
+            test_passed=false
+        fi
+    done
+    [ "$test_passed" = true ]
+}
+
+# Test 2: explicit and automatic affinity
+test_cpu() {
+    log_section "測試 2: @cpu=LIST 與 @cpu=auto"
+
+    local test_passed=true
+    local first
+    first="$(grep Cpus_allowed_list /proc/self/status | cut -f2 | cut -d, -f1 | cut -d- -f1)"
+
+    run_engine fork "@cpu=$first grep Cpus_allowed_list /proc/self/status"
+    if [ "$(echo "$OUTPUT" | cut -f2)" = "$first" ]; then
+        log_success "@cpu=$first pinned the stage"
+    else
+        log_error "@cpu=$first: $OUTPUT"
+        test_passed=false
+    fi
+
+    # two auto stages get the next two allowed CPUs (the same one on a 1-CPU box)
+    local ncpu
+    ncpu="$(nproc)"
+    run_engine posix "@cpu=auto grep Cpus_allowed_list /proc/self/status | @cpu=auto sh -c 'cat; grep Cpus_allowed_list /proc/self/status'"
+    local a b
+    a="$(echo "$OUTPUT" | sed -n 1p | cut -f2)"
+    b="$(echo "$OUTPUT" | sed -n 2p | cut -f2)"
+    if [[ "$a" =~ ^[0-9]+$ ]] && [[ "$b" =~ ^[0-9]+$ ]] && { [ "$ncpu" -eq 1 ] || [ "$a" != "$b" ]; }; then
+        log_success "Auto stages on CPUs $a and $b ($ncpu allowed)"
+    else
+        log_error "Unexpected auto placement"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    # the last CPU glibc can name: refused on any normal machine, the command still runs
+    run_engine posix "@cpu=1023 echo ran"
+    if echo "$OUTPUT" | grep -q '^@cpu: ' && echo "$OUTPUT" | grep -q '^ran$'; then
+        log_success "Refused affinity reported, command still ran"
+    else
+        log_error "Unexpected output for an unusable CPU"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 3: syntax
+test_syntax() {
+    log_section "測試 3: 錯誤的值與其他 @ 字詞"
+
+    run_engine posix "@cpu=3-1 true
+@nice=40 true
+@sched=fifo true
+echo @cpu=0 '@nice=1'
+'@nice=1' true"
+    local expected="@cpu=3-1: expected a CPU list such as 0-3,8 or auto
+@nice=40: expected a niceness from -20 to 19
+@sched=fifo: expected other, batch or idle
+@cpu=0 @nice=1
+@nice=1: command not found"
+    if [ "$OUTPUT" = "$expected" ]; then
+        log_success "Bad values rejected, quoted and non-leading @words kept"
+        return 0
+    fi
+    log_error "Unexpected output"
+    echo "$OUTPUT" | sed 's/^/  > /'
+    return 1
+}
+
+main() {
+    log_section "每段排程前綴測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_nice_policy test_cpu test_syntax; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有排程前綴測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查每段排程前綴的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
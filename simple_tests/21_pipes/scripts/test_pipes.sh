@@ -0,0 +1,239 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Pipe Capacity, Packet Mode and Throughput Counters
+# Purpose:
+#   - Verify @pipe=SIZE and MY_SHELL_PIPE set the capacity of inter-stage
+#     pipes, capped at /proc/sys/fs/pipe-max-size, and that @pipe= carries
+#     over to later pipes of the job
+#   - Verify @pipe=direct creates O_DIRECT pipes and pipe fds never leak into
+#     other stages
+#   - Verify @pipe=stats passes the data through unchanged and reports bytes
+#     per pipe
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 21_pipes
+#   - Or run directly:
+#       bash simple_tests/21_pipes/scripts/test_pipes.sh
+# =============================================================================
+
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+TEST_DIR="$(mktemp -d /tmp/pipes_test.XXXXXX)"
+trap 'rm -rf "$TEST_DIR"' EXIT
+
+# pipesz [in]: print the capacity of stdout (F_GETPIPE_SZ), after copying stdin with "in"
+cat > "$TEST_DIR/pipesz" <<'SCRIPT'
+#!/bin/sh
+[ "$1" = in ] && cat
+exec python3 -c 'import fcntl; print(fcntl.fcntl(1, 1032))'
+SCRIPT
+chmod +x "$TEST_DIR/pipesz"
+
+# Helper: run command line $1, store stdout in $OUTPUT and stderr in $ERRORS
+run_shell() {
+    OUTPUT="$(timeout $TIMEOUT "$SHELL_BINARY" -c "$1" 2> "$TEST_DIR/stderr")"
+    ERRORS="$(cat "$TEST_DIR/stderr")"
+}
+
+# Helper: compare $OUTPUT with $2, report as $1
+expect_output() {
+    if [ "$OUTPUT" = "$2" ]; then
+        log_success "$1"
+        return 0
+    fi
+    log_error "$1: unexpected output"
+    echo "$OUTPUT" | sed 's/^/  > /'
+    echo "$ERRORS" | sed 's/^/  ! /'
+    return 1
+}
+
+# Test 1: capacity from @pipe=, MY_SHELL_PIPE and the system ceiling
+test_capacity() {
+    log_section "測試 1: 管線容量"
+
+    if ! command -v python3 > /dev/null; then
+        log_warn "python3 not found, skipping capacity checks"
+        return 0
+    fi
+    local sz="$TEST_DIR/pipesz"
+    local max
+    max="$(cat /proc/sys/fs/pipe-max-size)"
+    local test_passed=true
+
+    run_shell "$sz | cat
+@pipe=256K $sz | cat
+@pipe=32K $sz | $sz in | cat
+$sz | @pipe=16K $sz in | cat
+@pipe=1G $sz | cat"
+    expect_output "@pipe=SIZE sets this and later pipes, capped at $max" "65536
+262144
+32768
+32768
+65536
+16384
+$max" || test_passed=false
+
+    OUTPUT="$(MY_SHELL_PIPE=128K timeout $TIMEOUT "$SHELL_BINARY" -c "$sz | cat
+@pipe=64K $sz | cat" 2>&1)"
+    expect_output "MY_SHELL_PIPE sets the default" "131072
+65536" || test_passed=false
+    [ "$test_passed" = true ]
+}
+
+# Test 2: packet mode and close-on-exec
+test_flags() {
+    log_section "測試 2: O_DIRECT 與 O_CLOEXEC"
+
+    local test_passed=true
+
+    # fdinfo flags are octal; O_DIRECT is 040000
+    run_shell "@pipe=direct grep flags /proc/self/fdinfo/1 | cat
+grep flags /proc/self/fdinfo/1 | cat"
+    local direct plain
+    direct="$(echo "$OUTPUT" | sed -n 1p | awk '{print $2}')"
+    plain="$(echo "$OUTPUT" | sed -n 2p | awk '{print $2}')"
+    if [ -n "$direct" ] && (( (8#$direct & 8#40000) != 0 )) && [ -n "$plain" ] && (( (8#$plain & 8#40000) == 0 )); then
+        log_success "O_DIRECT only with @pipe=direct ($direct, $plain)"
+    else
+        log_error "Unexpected pipe flags"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    # a middle stage holds its two pipe ends and nothing else (3 is ls's own directory)
+    run_shell "true | ls /proc/self/fd | cat"
+    expect_output "No pipe fds leak into other stages" "0
+1
+2
+3" || test_passed=false
+    [ "$test_passed" = true ]
+}
+
+# Test 3: measurement relays
+test_stats() {
+    log_section "測試 3: @pipe=stats 流量統計"
+
+    local test_passed=true
+    run_shell "@pipe=stats head -c 1000000 /dev/zero | cat | wc -c"
+    expect_output "Data passes through the relays unchanged" "1000000" || test_passed=false
+    if echo "$ERRORS" | grep -q '^pipe 1 head -> cat: 1000000 bytes in .*, capacity 65536, full .*, empty ' &&
+       echo "$ERRORS" | grep -q '^pipe 2 cat -> wc: 1000000 bytes in '; then
+        log_success "One report per pipe"
+    else
+        log_error "Unexpected reports"
+        echo "$ERRORS" | sed 's/^/  ! /'
+        test_passed=false
+    fi
+
+    # the reader leaving early ends the relay and the writer as usual
+    run_shell "@pipe=64K,stats yes | head -2"
+    expect_output "A reader that quits early stops the pipeline" "y
+y" || test_passed=false
+    if ! echo "$ERRORS" | grep -q '^pipe 1 yes -> head: [0-9]* bytes'; then
+        log_error "No report for an early-closed pipe"
+        echo "$ERRORS" | sed 's/^/  ! /'
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 4: syntax
+test_syntax() {
+    log_section "測試 4: 錯誤的值"
+
+    run_shell "@pipe=abc true | true
+@pipe=0 true | true
+@pipe=8X true | true
+@pipe= echo empty
+echo @pipe=1M"
+    OUTPUT="$ERRORS
+$OUTPUT"
+    local expected="@pipe=abc: expected SIZE[K|M|G], direct or stats, comma-separated
+@pipe=0: expected SIZE[K|M|G], direct or stats, comma-separated
+@pipe=8X: expected SIZE[K|M|G], direct or stats, comma-separated
+empty
+@pipe=1M"
+    expect_output "Bad values rejected, other @pipe= words kept" "$expected" || return 1
+
+    OUTPUT="$(MY_SHELL_PIPE=huge timeout $TIMEOUT "$SHELL_BINARY" -c "echo ran" 2>&1)"
+    expect_output "A bad MY_SHELL_PIPE is reported and ignored" "MY_SHELL_PIPE: expected SIZE[K|M|G], direct or stats, comma-separated
+ran"
+}
+
+main() {
+    log_section "管線設定測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_capacity test_flags test_stats test_syntax; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有管線設定測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查管線設定的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
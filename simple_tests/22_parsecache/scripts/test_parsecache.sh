@@ -0,0 +1,252 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Parsed-Job Template Cache
+# Purpose:
+#   - Verify repeated and replayed command lines run from a cached template
+#     with the same results as a fresh parse
+#   - Verify the parsecache built-in reports hits, misses and evictions, and
+#     that MY_SHELL_PARSECACHE and `parsecache -s` bound its memory
+#   - Verify loading a built-in drops templates resolved before it existed
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 22_parsecache
+#   - Or run directly:
+#       bash simple_tests/22_parsecache/scripts/test_parsecache.sh
+# =============================================================================
+
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+TEST_DIR="$(mktemp -d /tmp/parsecache_test.XXXXXX)"
+trap 'rm -rf "$TEST_DIR"' EXIT
+export MY_SHELL_HISTFILE="$TEST_DIR/history"
+
+# Helper: run command line $1 in a shell with a fresh history, output in $OUTPUT
+run_shell() {
+    rm -f "$MY_SHELL_HISTFILE"
+    OUTPUT="$(timeout $TIMEOUT "$SHELL_BINARY" -c "$1" 2>&1)"
+}
+
+# Helper: the summary line of `parsecache` in $OUTPUT
+summary() {
+    echo "$OUTPUT" | grep '^parsecache: '
+}
+
+# Helper: $OUTPUT without pids, job ids, timings and the parsecache listing
+stable_output() {
+    echo "$OUTPUT" | grep -v '^[0-9]*$' | grep -v '^\[' | grep -v '^stage \|^job \|^1 .* true$' |
+        grep -v $'^ *[0-9]*\t\|^hits\t\|^parsecache: '
+}
+
+# Test 1: cached lines behave like freshly parsed ones
+test_same_results() {
+    log_section "測試 1: 快取的結果與重新解析相同"
+
+    local line="echo 'a  b' \"c|d\" e\\ f | cat > $TEST_DIR/out
+cat < $TEST_DIR/out | tr a-z A-Z
+time true
+@pipe=64K echo x | @nice=1 cat
+echo bg > /dev/null &
+wait"
+
+    # every line twice: the second copy is a hit
+    local twice uncached cached
+    twice="$(echo "$line" | awk '{ print; print }')"
+    OUTPUT="$(MY_SHELL_PARSECACHE=0 timeout $TIMEOUT "$SHELL_BINARY" -c "$twice" 2>&1)"
+    uncached="$(stable_output)"
+    run_shell "$twice
+parsecache"
+    cached="$(stable_output)"
+
+    if [ "$(echo "$uncached" | wc -l)" -eq 4 ] && [ "$cached" = "$uncached" ] &&
+       [ "$(summary | grep -o '[0-9]* hits')" = "6 hits" ]; then
+        log_success "Six hits, same output as with the cache disabled"
+        return 0
+    fi
+    log_error "Cached and uncached runs differ"
+    diff <(echo "$uncached") <(echo "$cached") | sed 's/^/  > /'
+    summary | sed 's/^/  > /'
+    return 1
+}
+
+# Test 2: counters, replay and listing
+test_counters() {
+    log_section "測試 2: 命中率與 replay"
+
+    run_shell "echo r1
+replay 1
+replay 1
+true
+parsecache"
+    local test_passed=true
+    if [ "$(summary)" != "parsecache: 3 entries, $(echo "$OUTPUT" | summary | sed -n 's/.*entries, \([0-9]*\) of.*/\1/p') of 262144 bytes, 2 hits, 3 misses (40.0% hit rate), 0 evicted" ]; then
+        log_error "Unexpected summary"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    elif echo "$OUTPUT" | grep -q $'^   2\t[0-9]*\techo r1$'; then
+        log_success "replay N hits the template of the line it expands to"
+    else
+        log_error "No listing for echo r1"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    run_shell "parsecache -r
+true
+parsecache -x"
+    if echo "$OUTPUT" | grep -q '^usage: parsecache \[-r | -s SIZE\]$'; then
+        log_success "Bad options rejected"
+    else
+        log_error "Unexpected output: $OUTPUT"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 3: memory budget
+test_budget() {
+    log_section "測試 3: 記憶體上限與 LRU 淘汰"
+
+    local test_passed=true
+    local lines=""
+    for i in $(seq 1 20); do
+        lines+="echo line $i > /dev/null"$'\n'
+    done
+
+    run_shell "parsecache -s 2K
+${lines}echo line 20 > /dev/null
+parsecache"
+    local used
+    used="$(summary | sed -n 's/.*entries, \([0-9]*\) of 2048 bytes.*/\1/p')"
+    if [ -n "$used" ] && [ "$used" -le 2048 ] && summary | grep -q ' 1 hits, .* [1-9][0-9]* evicted$'; then
+        log_success "Stays within 2K ($used bytes), evicts the oldest, keeps the newest"
+    else
+        log_error "Unexpected summary: $(summary)"
+        test_passed=false
+    fi
+
+    OUTPUT="$(MY_SHELL_PARSECACHE=0 timeout $TIMEOUT "$SHELL_BINARY" -c "true
+true
+parsecache" 2>&1)"
+    if [ "$(summary)" = "parsecache: 0 entries, 0 of 0 bytes, 0 hits, 0 misses (0.0% hit rate), 0 evicted" ]; then
+        log_success "MY_SHELL_PARSECACHE=0 disables the cache"
+    else
+        log_error "Unexpected summary: $(summary)"
+        test_passed=false
+    fi
+
+    OUTPUT="$(MY_SHELL_PARSECACHE=lots timeout $TIMEOUT "$SHELL_BINARY" -c "echo ran" 2>&1)"
+    if [ "$OUTPUT" = "MY_SHELL_PARSECACHE: expected a size in bytes (suffix K or M)
+ran" ]; then
+        log_success "A bad MY_SHELL_PARSECACHE is reported and ignored"
+    else
+        log_error "Unexpected output: $OUTPUT"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 4: builtin -f invalidates templates
+test_invalidation() {
+    log_section "測試 4: 載入內建命令後重新解析"
+
+    local plugin="$TEST_DIR/hello_builtin.so"
+    if ! gcc -shared -fPIC -I "$PROJECT_ROOT/include" \
+        "$PROJECT_ROOT/simple_tests/10_loadable_builtins/test_data/hello_builtin.c" -o "$plugin" 2> /dev/null; then
+        log_warn "Cannot build the sample plugin, skipping"
+        return 0
+    fi
+
+    run_shell "hello
+builtin -f $plugin hello
+hello
+builtin -d hello
+hello"
+    local expected="hello: command not found
+hello, world
+hello: command not found"
+    if [ "$OUTPUT" = "$expected" ]; then
+        log_success "A cached line sees built-ins loaded and unloaded after it"
+        return 0
+    fi
+    log_error "Unexpected output"
+    echo "$OUTPUT" | sed 's/^/  > /'
+    return 1
+}
+
+main() {
+    log_section "解析快取測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    for t in test_same_results test_counters test_budget test_invalidation; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有解析快取測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查解析快取的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
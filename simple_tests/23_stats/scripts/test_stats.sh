@@ -0,0 +1,281 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Shell Metrics and the stats Built-in
+# Purpose:
+#   - Verify the counters (lines, errors, jobs, processes, failures, builtin
+#     calls) and latency histograms reported by `stats` and `stats -j`
+#   - Verify the metrics file under $XDG_RUNTIME_DIR or MY_SHELL_STATS can be
+#     read by another process while the shell runs and is removed at exit
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 23_stats
+#   - Or run directly:
+#       bash simple_tests/23_stats/scripts/test_stats.sh
+# =============================================================================
+
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+TEST_DIR="$(mktemp -d /tmp/stats_test.XXXXXX)"
+trap 'rm -rf "$TEST_DIR"' EXIT
+export MY_SHELL_HISTFILE="$TEST_DIR/history"
+export XDG_RUNTIME_DIR="$TEST_DIR"
+
+# Helper: run command line $1, store stdout and stderr in $OUTPUT
+run_shell() {
+    OUTPUT="$(timeout $TIMEOUT "$SHELL_BINARY" -c "$1" 2>&1)"
+}
+
+# Helper: evaluate python expression $1 on the JSON object in the last line of $OUTPUT
+json() {
+    echo "$OUTPUT" | tail -1 | python3 -c "import json, sys; s = json.load(sys.stdin); print($1)"
+}
+
+# Test 1: counters
+test_counters() {
+    log_section "測試 1: 計數器與內建命令呼叫次數"
+    local test_passed=true
+
+    run_shell "echo one
+echo two | cat
+nosuchcmd_xyz
+echo \"unterminated
+sleep 0.1 &
+wait
+stats -j"
+    local got
+    got="$(json "s['counters']['lines'], s['counters']['parse_errors'], s['counters']['jobs'], s['counters']['bg_jobs'], s['counters']['bg_done'], s['counters']['not_found'], s['builtins']['echo'], s['builtins']['wait'], s['builtins']['stats']")"
+    # 7 lines, one unterminated: 6 jobs
+    if [ "$got" = "7 1 6 1 1 1 2 1 1" ]; then
+        log_success "lines, parse_errors, jobs, bg_jobs, bg_done, not_found and builtin calls"
+    else
+        log_error "Unexpected counters: $got"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    # an exec that fails in a forked child still counts as a spawn failure
+    : > "$TEST_DIR/not_executable"
+    local mode
+    for mode in fork posix zygote; do
+        OUTPUT="$(MY_SHELL_SPAWN=$mode timeout $TIMEOUT "$SHELL_BINARY" -c "$TEST_DIR/not_executable
+stats -j" 2>&1)"
+        got="$(json "s['counters']['spawn_failures'], s['counters']['processes']")"
+        if [ "$got" = "1 0" ] && echo "$OUTPUT" | grep -q "not_executable: Permission denied"; then
+            log_success "spawn_failures counts a failed exec ($mode)"
+        else
+            log_error "Unexpected spawn_failures, processes with $mode: $got"
+            echo "$OUTPUT" | sed 's/^/  > /'
+            test_passed=false
+        fi
+    done
+    [ "$test_passed" = true ]
+}
+
+# Test 2: histograms and the human-readable report
+test_report() {
+    log_section "測試 2: 延遲直方圖與報表"
+
+    local test_passed=true
+    run_shell "/bin/true
+/bin/true | /bin/true
+stats -j"
+    local got
+    got="$(json "s['counters']['processes'], s['histograms']['spawn']['count'], sum(s['histograms']['spawn']['buckets']), s['histograms']['wait']['count'], s['histograms']['parse']['count'] == sum(s['histograms']['parse']['buckets']), len(s['histograms']['parse']['buckets'])")"
+    if [ "$got" = "3 3 3 2 True 32" ]; then
+        log_success "spawn, wait and parse histograms add up"
+    else
+        log_error "Unexpected histograms: $got"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+
+    # a forked builtin reads the same shared block; -r zeroes it
+    run_shell "echo x > /dev/null
+stats | grep -E '^(lines|builtins:|latency)'
+stats -r
+stats | grep '^lines'
+stats -x"
+    local expected="lines                     2
+builtins: echo 1, stats 1
+latency       count    mean us     p50 us     p99 us     max us
+lines                     1
+usage: stats [-j | -r]"
+    if [ "$OUTPUT" = "$expected" ]; then
+        log_success "Report from a pipeline stage, reset and usage"
+    else
+        log_error "Unexpected report"
+        echo "$OUTPUT" | sed 's/^/  > /'
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 3: the exported file
+test_export() {
+    log_section "測試 3: 記憶體映射的指標檔"
+
+    local test_passed=true
+
+    # a batch shell exports nothing unless asked; one that is asked clears
+    # the files of dead shells and keeps those of live ones
+    sleep 0 &
+    local dead=$!
+    wait $dead
+    : > "$TEST_DIR/my_shell.$dead.stats"
+    : > "$TEST_DIR/my_shell.$$.stats"
+    timeout $TIMEOUT "$SHELL_BINARY" -c "ls $TEST_DIR > $TEST_DIR/listing"
+    if [ "$(grep -c '\.stats$' "$TEST_DIR/listing")" -eq 2 ]; then
+        log_success "No file for a batch shell by default"
+    else
+        log_error "Unexpected files: $(cat "$TEST_DIR/listing")"
+        test_passed=false
+    fi
+    MY_SHELL_STATS=on timeout $TIMEOUT "$SHELL_BINARY" -c "true"
+    if [ ! -e "$TEST_DIR/my_shell.$dead.stats" ] && [ -e "$TEST_DIR/my_shell.$$.stats" ]; then
+        log_success "Files of dead shells removed at startup"
+    else
+        log_error "Stale file handling: $(ls "$TEST_DIR")"
+        test_passed=false
+    fi
+    rm -f "$TEST_DIR/my_shell.$$.stats"
+
+    MY_SHELL_STATS=on timeout $TIMEOUT "$SHELL_BINARY" -c "echo a > /dev/null
+echo b > /dev/null
+sleep 1" &
+    local timeout_pid=$!
+    sleep 0.5
+
+    # header: magic, version, size, pid, start; then the counters
+    local file
+    file="$(ls "$TEST_DIR"/my_shell.*.stats 2> /dev/null)"
+    local got
+    got="$(python3 - "$file" <<'PY'
+import struct, sys
+data = open(sys.argv[1], 'rb').read()
+magic, version, size, pid, start = struct.unpack_from('=IIIiq', data, 0)
+lines = struct.unpack_from('=Q', data, 24)[0]
+print(hex(magic), version, size == len(data), sys.argv[1].endswith('.%d.stats' % pid), lines)
+PY
+)"
+    if [ "$got" = "0x53485354 1 True True 3" ]; then
+        log_success "Another process reads magic, version, pid and counters while the shell runs"
+    else
+        log_error "Unexpected file contents: $got"
+        test_passed=false
+    fi
+    wait $timeout_pid
+    if [ -n "$file" ] && [ ! -e "$file" ]; then
+        log_success "File removed when the shell exits"
+    else
+        log_error "File left behind: $file"
+        test_passed=false
+    fi
+
+    OUTPUT="$(MY_SHELL_STATS="$TEST_DIR/custom.stats" timeout $TIMEOUT "$SHELL_BINARY" -c "stats | head -1" 2>&1)"
+    if echo "$OUTPUT" | grep -q "^stats: pid [0-9]*, up [0-9]*s, exported to $TEST_DIR/custom.stats$"; then
+        log_success "MY_SHELL_STATS=path"
+    else
+        log_error "Unexpected output: $OUTPUT"
+        test_passed=false
+    fi
+
+    OUTPUT="$(MY_SHELL_STATS=off timeout $TIMEOUT "$SHELL_BINARY" -c "stats | head -1" 2>&1)"
+    if echo "$OUTPUT" | grep -q ', not exported$'; then
+        log_success "MY_SHELL_STATS=off"
+    else
+        log_error "Unexpected output: $OUTPUT"
+        test_passed=false
+    fi
+
+    OUTPUT="$(MY_SHELL_STATS=/nonexistent/dir/x.stats timeout $TIMEOUT "$SHELL_BINARY" -c "echo ran" 2>&1)"
+    if [ "$OUTPUT" = "MY_SHELL_STATS: /nonexistent/dir/x.stats: No such file or directory
+ran" ]; then
+        log_success "An unusable path is reported, the shell still runs"
+    else
+        log_error "Unexpected output: $OUTPUT"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "指標與 stats 測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+    if ! command -v python3 > /dev/null; then
+        log_warn "python3 not found, skipping"
+        exit 0
+    fi
+
+    for t in test_counters test_report test_export; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有指標測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查指標的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
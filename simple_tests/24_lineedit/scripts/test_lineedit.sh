@@ -0,0 +1,390 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: Line Editor and Tab Completion
+# Purpose:
+#   - Verify editing keys (cursor movement, kills, history) on a terminal
+#   - Verify Tab completion of builtins, PATH executables and file names, and
+#     that the PATH trie follows executables added or removed while the shell
+#     runs (inotify)
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 24_lineedit
+#   - Or run directly:
+#       bash simple_tests/24_lineedit/scripts/test_lineedit.sh
+# =============================================================================
+
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+TEST_DIR="$(mktemp -d /tmp/lineedit_test.XXXXXX)"
+trap 'rm -rf "$TEST_DIR"' EXIT
+export MY_SHELL_HISTFILE="$TEST_DIR/history"
+export MY_SHELL_STATS=off
+export TERM=xterm
+BIN="$TEST_DIR/bin"
+WORK="$TEST_DIR/work"
+mkdir -p "$BIN" "$WORK/dir_one"
+
+# Terminal driver: runs the shell on a pty and types each argument once the
+# previous line has been run (a fresh prompt is drawn and output is quiet).
+# Arguments use Python escapes (\t, \r, \x1b[D); one starting with '!' runs a
+# command instead. Prints the session with carriage returns removed.
+cat > "$TEST_DIR/pty_drive.py" <<'PY'
+import codecs, os, pty, select, subprocess, sys, time
+
+shell, steps = sys.argv[1], sys.argv[2:]
+pid, fd = pty.fork()
+if pid == 0:
+    os.execv(shell, [shell])
+out = b''
+
+def pump(timeout):
+    global out
+    if not select.select([fd], [], [], timeout)[0]:
+        return False
+    try:
+        data = os.read(fd, 65536)
+    except OSError:
+        data = b''
+    if not data:
+        raise EOFError
+    out += data
+    return True
+
+def settle():
+    mark = len(out)
+    deadline = time.time() + 10
+    while time.time() < deadline:
+        if not pump(0.1) and b'>>> $ ' in out[mark:]:
+            return
+
+settle()
+for step in steps:
+    if step.startswith('!'):
+        subprocess.run(step[1:], shell=True)
+        continue
+    os.write(fd, codecs.decode(step, 'unicode_escape').encode('latin-1'))
+    settle()
+os.write(fd, b'\x04')
+try:
+    while pump(5):
+        pass
+except EOFError:
+    pass
+os.waitpid(pid, 0)
+sys.stdout.write(out.decode('utf-8', 'replace').replace('\r', ''))
+PY
+
+# Helper: type the arguments into an interactive shell in $WORK, session in $OUTPUT
+run_tty() {
+    OUTPUT="$(cd "$WORK" && PATH="$BIN:/usr/bin:/bin" timeout $TIMEOUT python3 "$TEST_DIR/pty_drive.py" "$SHELL_BINARY" "$@" 2>&1)"
+}
+
+# Helper: an executable in $BIN printing $2
+make_cmd() {
+    printf '#!/bin/sh\necho %s\n' "$2" > "$BIN/$1"
+    chmod +x "$BIN/$1"
+}
+
+# Helper: check that $OUTPUT has the line $1 (output, not the echoed input)
+expect_line() {
+    if echo "$OUTPUT" | grep -qxF -- "$1"; then
+        log_success "$2"
+        return 0
+    fi
+    log_error "$2: no line '$1'"
+    return 1
+}
+
+# Helper: check that $OUTPUT does not have the line $1
+reject_line() {
+    if ! echo "$OUTPUT" | grep -qxF -- "$1"; then
+        log_success "$2"
+        return 0
+    fi
+    log_error "$2: unexpected line '$1'"
+    return 1
+}
+
+# Test 1: editing keys
+test_editing() {
+    log_section "Test 1: 編輯按鍵"
+    local test_passed=true
+
+    run_tty 'echo OUT:bc\x1b[D\x1b[Da\r' \
+        'cho OUT:home\x01e\r' \
+        'junk\x15echo OUT:kill\r' \
+        'echo OUT:word junk\x17\r' \
+        'echo OUT:bsX\x7f\r' \
+        'echo OUT:endX\x1b[D\x0b\r' \
+        'echo OUT:discarded\x03echo OUT:after\r' \
+        'echo OUT:hist1\r' \
+        'echo OUT:hist2\r' \
+        '\x1b[A\x1b[A\x1b[B\r'
+
+    expect_line "OUT:abc" "Left 後插入字元" || test_passed=false
+    expect_line "OUT:home" "Ctrl-A 移到行首" || test_passed=false
+    expect_line "OUT:kill" "Ctrl-U 刪除游標前的內容" || test_passed=false
+    expect_line "OUT:word" "Ctrl-W 刪除前一個字" || test_passed=false
+    expect_line "OUT:bs" "Backspace 刪除前一個字元" || test_passed=false
+    expect_line "OUT:end" "Ctrl-K 刪除到行尾" || test_passed=false
+    expect_line "OUT:after" "Ctrl-C 後可輸入新的一行" || test_passed=false
+    reject_line "OUT:discarded" "Ctrl-C 丟棄目前這一行" || test_passed=false
+    if [ "$(echo "$OUTPUT" | grep -cxF "OUT:hist2")" -eq 2 ]; then
+        log_success "Up/Down 取回歷史紀錄"
+    else
+        log_error "Up Up Down should re-run the last line"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 2: command completion from builtins and PATH
+test_commands() {
+    log_section "Test 2: 內建命令與 PATH 命令補全"
+    local test_passed=true
+
+    make_cmd zzq_tool_alpha OUT:alpha
+    make_cmd zzq_tool_beta OUT:beta
+    make_cmd stats OUT:path-stats-not-run
+    run_tty 'ech\t OUT:builtin\r' \
+        'zzq_tool_a\t\r' \
+        'zzq\t\t\tb\t\r' \
+        'echo x | zzq_tool_al\t\r' \
+        'time @nice=1 zzq_tool_b\t\r' \
+        'parsec\t -r\r' \
+        'qqqnothing\t\t\r'
+
+    expect_line "OUT:builtin" "內建命令補全 (ech -> echo)" || test_passed=false
+    expect_line "OUT:alpha" "PATH 命令補全 (唯一的候選)" || test_passed=false
+    expect_line "zzq_tool_alpha  zzq_tool_beta" "第二次 Tab 列出候選" || test_passed=false
+    expect_line "OUT:beta" "補到共同前綴後繼續輸入" || test_passed=false
+    if [ "$(echo "$OUTPUT" | grep -cxF "OUT:alpha")" -eq 2 ]; then
+        log_success "管線中的命令位置"
+    else
+        log_error "Command after '|' should complete"
+        test_passed=false
+    fi
+    if [ "$(echo "$OUTPUT" | grep -cxF "OUT:beta")" -eq 2 ]; then
+        log_success "time 與 @-前綴之後的命令位置"
+    else
+        log_error "Command after time and @nice= should complete"
+        test_passed=false
+    fi
+    reject_line "parsecache: parsec: command not found" "parsecache 內建命令補全" || test_passed=false
+    if echo "$OUTPUT" | grep -q "qqqnothing: command not found"; then
+        log_success "沒有候選時保留原樣"
+    else
+        log_error "Unmatched word should stay as typed"
+        test_passed=false
+    fi
+    rm -f "$BIN/stats"
+    [ "$test_passed" = true ]
+}
+
+# Test 3: the PATH trie follows changes through inotify
+test_inotify() {
+    log_section "Test 3: PATH 變更即時反映 (inotify)"
+    local test_passed=true
+
+    make_cmd zzq_tool_alpha OUT:alpha
+    make_cmd zzq_tool_beta OUT:beta
+    printf '#!/bin/sh\necho OUT:plain\n' > "$BIN/zzq_plain"
+    run_tty 'zzq_tool_\t\t\r' \
+        "!printf '#!/bin/sh\\necho OUT:fresh\\n' > $BIN/zzq_fresh && chmod +x $BIN/zzq_fresh" \
+        'zzq_f\t\r' \
+        "!rm $BIN/zzq_tool_beta" \
+        'zzq_t\t\r' \
+        'zzq_p\t\r' \
+        "!chmod +x $BIN/zzq_plain" \
+        'zzq_p\t\r' \
+        "!mv $BIN/zzq_fresh $BIN/zzq_moved" \
+        'zzq_m\t\r'
+
+    expect_line "OUT:fresh" "新增的執行檔可補全" || test_passed=false
+    expect_line "OUT:alpha" "刪除的執行檔不再是候選" || test_passed=false
+    if echo "$OUTPUT" | grep -q "zzq_p: command not found" && echo "$OUTPUT" | grep -qxF "OUT:plain"; then
+        log_success "chmod +x 之後才成為候選"
+    else
+        log_error "A non-executable file should only complete after chmod +x"
+        test_passed=false
+    fi
+    if [ "$(echo "$OUTPUT" | grep -cxF "OUT:fresh")" -eq 2 ]; then
+        log_success "改名後以新名稱補全"
+    else
+        log_error "A renamed executable should complete under its new name"
+        test_passed=false
+    fi
+    rm -f "$BIN"/zzq_*
+    [ "$test_passed" = true ]
+}
+
+# Test 4: file name completion
+test_files() {
+    log_section "Test 4: 檔名補全"
+    local test_passed=true
+
+    echo "OUT:file-a" > "$WORK/dir_one/file_a.txt"
+    echo "OUT:spaced" > "$WORK/my file.txt"
+    echo "OUT:hidden" > "$WORK/.hidden_note"
+    printf '#!/bin/sh\necho OUT:script\n' > "$WORK/run_me.sh"
+    chmod +x "$WORK/run_me.sh"
+    run_tty 'cat dir_\tfi\t\r' \
+        'cat my\t\r' \
+        'cat .hid\t\r' \
+        './run\t\r' \
+        'cat < dir_one/f\t\r' \
+        'cat "my f\t\r'
+
+    expect_line "OUT:file-a" "目錄補上 / 後再補全檔名" || test_passed=false
+    expect_line "OUT:spaced" "檔名中的空白以反斜線跳脫" || test_passed=false
+    expect_line "OUT:hidden" "以 . 開頭時補全隱藏檔" || test_passed=false
+    expect_line "OUT:script" "含 / 的命令補全為可執行檔" || test_passed=false
+    if [ "$(echo "$OUTPUT" | grep -cxF "OUT:file-a")" -eq 2 ]; then
+        log_success "重新導向後補全檔名"
+    else
+        log_error "The word after '<' should complete as a file"
+        test_passed=false
+    fi
+    if [ "$(echo "$OUTPUT" | grep -cxF "OUT:spaced")" -eq 2 ]; then
+        log_success "引號內的補全補上結尾引號"
+    else
+        log_error "Completion inside quotes should close the quote"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Helper: the largest cursor column the editor moved to in $OUTPUT
+max_cursor_col() {
+    echo "$OUTPUT" | grep -ao $'\x1b\[[0-9]*C' | tr -dc '0-9\n' | sort -n | tail -1
+}
+
+# Test 5: multibyte characters
+test_utf8() {
+    log_section "Test 5: UTF-8 字元"
+    local test_passed=true
+
+    run_tty 'echo OUT:\xc3\xa9\x1b[Dx\r' \
+        'echo OUT:\xc3\xa9\xc3\xa9\x7f\r' \
+        'echo OUT:a\xc3\xa9b\x1b[D\x1b[D\x1b[3~\r'
+    expect_line "OUT:xé" "Left 跳過整個 UTF-8 字元" || test_passed=false
+    expect_line "OUT:é" "Backspace 刪除整個 UTF-8 字元" || test_passed=false
+    expect_line "OUT:ab" "Delete 刪除整個 UTF-8 字元" || test_passed=false
+
+    run_tty 'echo OUT:e\r'
+    local ascii_col="$(max_cursor_col)"
+    run_tty 'echo OUT:\xc3\xa9\r'
+    local utf8_col="$(max_cursor_col)"
+    if [ -n "$ascii_col" ] && [ "$ascii_col" = "$utf8_col" ]; then
+        log_success "游標位置以欄數而非位元組計算"
+    else
+        log_error "cursor column after 'é' is $utf8_col, after 'e' $ascii_col"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 6: no editor without a terminal
+test_no_tty() {
+    log_section "Test 6: 非終端機輸入"
+    local test_passed=true
+
+    OUTPUT="$(printf 'echo piped\n\necho again\n' | timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+    if echo "$OUTPUT" | grep -q "piped" && echo "$OUTPUT" | grep -q "again" && ! echo "$OUTPUT" | grep -q $'\x1b'; then
+        log_success "管線輸入不使用行編輯器"
+    else
+        log_error "Unexpected output: $OUTPUT"
+        test_passed=false
+    fi
+
+    OUTPUT="$(cd "$WORK" && TERM=dumb PATH="$BIN:/usr/bin:/bin" timeout $TIMEOUT python3 "$TEST_DIR/pty_drive.py" "$SHELL_BINARY" 2>&1)"
+    if ! echo "$OUTPUT" | grep -q $'\x1b'; then
+        log_success "TERM=dumb 時不使用行編輯器"
+    else
+        log_error "TERM=dumb should read plain lines"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "行編輯器與補全測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+    if ! command -v python3 > /dev/null; then
+        log_warn "python3 not found, skipping"
+        exit 0
+    fi
+
+    for t in test_editing test_commands test_inotify test_files test_utf8 test_no_tty; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有行編輯器測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查行編輯器的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
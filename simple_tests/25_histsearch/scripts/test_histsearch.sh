@@ -0,0 +1,345 @@
+#!/bin/bash
+
+# =============================================================================
+# Test Script: History Search
+# Purpose:
+#   - Verify `record -s PATTERN` lists the entries containing PATTERN, paged
+#   - Verify `replay ?PATTERN` runs the newest entry containing PATTERN
+#   - Verify Ctrl-R reverse incremental search in the line editor
+#   - Verify searches over a history of 200,000 entries
+#
+# How to run:
+#   - From project root:
+#       make
+#       ./simple_tests/run_test.sh 25_histsearch
+#   - Or run directly:
+#       bash simple_tests/25_histsearch/scripts/test_histsearch.sh
+# =============================================================================
+
+
+# Color definitions
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Test configuration (auto-detect shell path)
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../../" && pwd)"
+
+if [ -f "$PROJECT_ROOT/my_shell" ]; then
+    SHELL_BINARY="$PROJECT_ROOT/my_shell"
+elif [ -f "../../my_shell" ]; then
+    SHELL_BINARY="$(cd "$(dirname "$0")/../../" && pwd)/my_shell"
+elif [ -f "my_shell" ]; then
+    SHELL_BINARY="$(pwd)/my_shell"
+else
+    SHELL_BINARY="my_shell"  # fallback, will fail gracefully
+fi
+
+TIMEOUT=30
+
+# Utility functions
+log_info() { echo -e "${CYAN}[INFO]${NC} $1"; }
+log_warn() { echo -e "${YELLOW}[WARN]${NC} $1"; }
+log_success(){ echo -e "${GREEN}[PASS]${NC} $1"; }
+log_error() { echo -e "${RED}[FAIL]${NC} $1"; }
+log_section(){ echo -e "\n${BLUE}=== $1 ===${NC}"; }
+
+check_shell_binary() {
+    log_section "環境檢查"
+    if [ ! -f "$SHELL_BINARY" ]; then
+        log_error "Shell binary not found at: $SHELL_BINARY"
+        log_info "Please compile the shell first using: make"
+        exit 1
+    fi
+    if [ ! -x "$SHELL_BINARY" ]; then
+        log_error "Shell binary is not executable: $SHELL_BINARY"
+        exit 1
+    fi
+    log_success "Shell binary found and executable"
+}
+
+TEST_DIR="$(mktemp -d /tmp/histsearch_test.XXXXXX)"
+trap 'rm -rf "$TEST_DIR"' EXIT
+export MY_SHELL_HISTFILE="$TEST_DIR/history"
+export MY_SHELL_STATS=off
+
+# Helper: run the lines of $1 in a fresh history, output in $OUTPUT
+run_fresh() {
+    rm -f "$MY_SHELL_HISTFILE"
+    OUTPUT="$(printf '%s\n' "$1" | timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+}
+
+# Helper: check that $OUTPUT has a line containing $1
+expect_in() {
+    if echo "$OUTPUT" | grep -qF -- "$1"; then
+        log_success "$2"
+        return 0
+    fi
+    log_error "$2: no '$1' in output"
+    return 1
+}
+
+# Test 1: record -s
+test_record_search() {
+    log_section "Test 1: record -s PATTERN"
+    local test_passed=true
+    local lines="" i
+    for i in $(seq 1 20); do
+        lines+="echo match_$i > /dev/null"$'\n'"echo other_$i > /dev/null"$'\n'
+    done
+
+    run_fresh "${lines}record -s match_"
+    local page1 page2 page
+    # the record line itself is not listed
+    page1="$(echo "$OUTPUT" | grep -o 'echo match_[0-9]*' | tr '\n' ' ')"
+    if [ "$page1" = "$(for i in $(seq 5 20); do printf 'echo match_%d ' "$i"; done)" ]; then
+        log_success "第一頁是最新的 16 筆，舊的在前"
+    else
+        log_error "Unexpected first page: $page1"
+        test_passed=false
+    fi
+    if echo "$OUTPUT" | grep -q "record -s"; then
+        log_error "record -s should not list itself"
+        test_passed=false
+    else
+        log_success "不列出 record -s 這行命令本身"
+    fi
+
+    run_fresh "${lines}record -s match_ -p 2"
+    page2="$(echo "$OUTPUT" | grep -o 'echo match_[0-9]*' | tr '\n' ' ')"
+    if [ "$page2" = "echo match_1 echo match_2 echo match_3 echo match_4 " ]; then
+        log_success "-p 2 顯示更早的符合項目"
+    else
+        log_error "Unexpected second page: $page2"
+        test_passed=false
+    fi
+
+    run_fresh "${lines}record -s match_1"
+    if echo "$OUTPUT" | grep -q "other_"; then
+        log_error "Entries without the pattern should not be listed"
+        test_passed=false
+    else
+        log_success "只列出含有 PATTERN 的項目"
+    fi
+    # match_1 and match_10 to match_19
+    page="$(echo "$OUTPUT" | grep -c 'echo match_1[0-9]* > /dev/null$')"
+    if echo "$OUTPUT" | grep -qF " 1  echo match_1 > /dev/null" && [ "$page" -eq 11 ]; then
+        log_success "以歷史編號列出，可交給 replay"
+    else
+        log_error "Entries should be listed with their history numbers"
+        test_passed=false
+    fi
+
+    run_fresh "record -s
+record -p 2 -x y
+record -s zz -p 0"
+    if [ "$(echo "$OUTPUT" | grep -c "usage: record \[-p PAGE\] \[-s PATTERN\]")" -eq 2 ] &&
+        echo "$OUTPUT" | grep -q "record: invalid page 0"; then
+        log_success "錯誤的參數顯示用法"
+    else
+        log_error "Bad arguments should print the usage: $OUTPUT"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 2: replay ?PATTERN
+test_replay_search() {
+    log_section "Test 2: replay ?PATTERN"
+    local test_passed=true
+
+    run_fresh "echo alpha one
+echo beta two
+echo alpha three
+replay ?wo
+replay ?alpha
+replay ?beta | tr a-z A-Z
+replay ?zzz_none"
+    if [ "$(echo "$OUTPUT" | grep -c "alpha three")" -eq 2 ]; then
+        log_success "執行最新的符合項目"
+    else
+        log_error "replay ?alpha should run 'echo alpha three'"
+        test_passed=false
+    fi
+    expect_in "BETA TWO" "搜尋結果可接在管線中" || test_passed=false
+    expect_in "replay: no entry contains zzz_none" "沒有符合項目時顯示錯誤" || test_passed=false
+    if [ "$(echo "$OUTPUT" | grep -c "beta two")" -eq 2 ]; then
+        log_success "少於三個字元的 PATTERN"
+    else
+        log_error "replay ?ta should run 'echo beta two'"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+# Test 3: a history of 200,000 entries
+test_large_history() {
+    log_section "Test 3: 20 萬筆歷史紀錄"
+    local test_passed=true
+
+    rm -f "$MY_SHELL_HISTFILE"
+    seq 1 200000 | sed 's/.*/echo entry_& end/' > "$TEST_DIR/lines"
+    MY_SHELL_HISTSIZE=262144 timeout $TIMEOUT "$SHELL_BINARY" < "$TEST_DIR/lines" > /dev/null 2>&1
+    OUTPUT="$(printf '%s\n' 'record -s "entry_17 end"' 'record -s entry_199999' 'replay ?entry_123456 | tr a-z A-Z' \
+        'record -s entry_1234' | MY_SHELL_HISTSIZE=262144 timeout $TIMEOUT "$SHELL_BINARY" 2>&1)"
+    expect_in "17  echo entry_17 end" "找到 20 萬筆中較舊的項目" || test_passed=false
+    expect_in "199999  echo entry_199999 end" "找到最新的項目" || test_passed=false
+    expect_in "ENTRY_123456 END" "replay ?PATTERN 在 20 萬筆中執行" || test_passed=false
+    if echo "$OUTPUT" | grep -q "123499  echo entry_123499 end$" && ! echo "$OUTPUT" | grep -q "entry_123484 end$"; then
+        log_success "多筆符合時只列出最新一頁"
+    else
+        log_error "record -s entry_1234 should list the newest page only"
+        test_passed=false
+    fi
+
+    # another shell appends to the store after this one has built its index
+    mkfifo "$TEST_DIR/fifo"
+    (
+        printf 'record -s entry_2000\n'
+        sleep 0.5
+        printf 'record -s added_later\n'
+    ) > "$TEST_DIR/fifo" &
+    MY_SHELL_HISTSIZE=262144 timeout $TIMEOUT "$SHELL_BINARY" < "$TEST_DIR/fifo" > "$TEST_DIR/out" 2>&1 &
+    sleep 0.2
+    echo "echo added_later" | MY_SHELL_HISTSIZE=262144 timeout $TIMEOUT "$SHELL_BINARY" > /dev/null 2>&1
+    wait
+    OUTPUT="$(cat "$TEST_DIR/out")"
+    expect_in "  echo added_later" "另一個 shell 新增的項目也能搜尋" || test_passed=false
+    [ "$test_passed" = true ]
+}
+
+# Test 4: Ctrl-R in the line editor
+test_ctrl_r() {
+    log_section "Test 4: Ctrl-R 反向搜尋"
+    local test_passed=true
+
+    # types each argument once the previous line has run (see 24_lineedit)
+    cat > "$TEST_DIR/pty_drive.py" <<'PY'
+import codecs, os, pty, select, sys, time
+
+shell, steps = sys.argv[1], sys.argv[2:]
+pid, fd = pty.fork()
+if pid == 0:
+    os.execv(shell, [shell])
+out = b''
+
+def pump(timeout):
+    global out
+    if not select.select([fd], [], [], timeout)[0]:
+        return False
+    try:
+        data = os.read(fd, 65536)
+    except OSError:
+        data = b''
+    if not data:
+        raise EOFError
+    out += data
+    return True
+
+def settle():
+    mark = len(out)
+    deadline = time.time() + 10
+    while time.time() < deadline:
+        if not pump(0.1) and b'>>> $ ' in out[mark:]:
+            return
+
+settle()
+for step in steps:
+    os.write(fd, codecs.decode(step, 'unicode_escape').encode('latin-1'))
+    settle()
+os.write(fd, b'\x04')
+try:
+    while pump(5):
+        pass
+except EOFError:
+    pass
+os.waitpid(pid, 0)
+sys.stdout.write(out.decode('utf-8', 'replace').replace('\r', ''))
+PY
+    rm -f "$MY_SHELL_HISTFILE"
+    OUTPUT="$(TERM=xterm timeout $TIMEOUT python3 "$TEST_DIR/pty_drive.py" "$SHELL_BINARY" \
+        'echo OUT:first\r' \
+        'echo OUT:second\r' \
+        '\x12first\r' \
+        '\x12OUT:\x12\r' \
+        'echo OUT:kept\x12second\x07\r' \
+        '\x12OUT:kep\x05X\r' \
+        '\x12OUT:sX\x7f\r' \
+        '\x12nomatch_zz\x07echo OUT:none\r' 2>&1)"
+
+    local n
+    n="$(echo "$OUTPUT" | grep -cxF "OUT:first")"
+    if [ "$n" -eq 2 ]; then
+        log_success "輸入字元後 Enter 執行找到的項目"
+    else
+        log_error "^R first should re-run 'echo OUT:first' ($n)"
+        test_passed=false
+    fi
+    n="$(echo "$OUTPUT" | grep -cxF "OUT:second")"
+    if [ "$n" -eq 3 ]; then
+        log_success "再按 ^R 找更舊的項目，Backspace 重新搜尋"
+    else
+        log_error "^R ^R and Backspace should each re-run 'echo OUT:second' ($n)"
+        test_passed=false
+    fi
+    if echo "$OUTPUT" | grep -qxF "OUT:kept" && ! echo "$OUTPUT" | grep -qxF "OUT:second2"; then
+        log_success "^G 取消搜尋並恢復原本的輸入"
+    else
+        log_error "^G should bring back the line being typed"
+        test_passed=false
+    fi
+    if echo "$OUTPUT" | grep -qxF "OUT:keptX"; then
+        log_success "其他按鍵接受結果並繼續編輯"
+    else
+        log_error "^E after a match should edit the line found"
+        test_passed=false
+    fi
+    if echo "$OUTPUT" | grep -qF "(failed reverse-i-search)\`nomatch_zz'" && echo "$OUTPUT" | grep -qxF "OUT:none"; then
+        log_success "沒有符合項目時顯示 failed"
+    else
+        log_error "A pattern without matches should show a failed search"
+        test_passed=false
+    fi
+    [ "$test_passed" = true ]
+}
+
+main() {
+    log_section "歷史搜尋測試開始"
+    log_info "Testing shell binary: $SHELL_BINARY"
+
+    local total_tests=0
+    local passed_tests=0
+
+    check_shell_binary
+
+    local tests="test_record_search test_replay_search test_large_history"
+    if command -v python3 > /dev/null; then
+        tests+=" test_ctrl_r"
+    else
+        log_warn "python3 not found, skipping the Ctrl-R test"
+    fi
+    for t in $tests; do
+        total_tests=$((total_tests + 1))
+        if $t; then
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    log_section "測試結果總結"
+    echo -e "通過測試: ${GREEN}$passed_tests${NC}/$total_tests"
+    if [ $passed_tests -eq $total_tests ]; then
+        log_success "所有歷史搜尋測試通過！"
+        exit 0
+    else
+        log_error "部分測試失敗，請檢查歷史搜尋的實作"
+        exit 1
+    fi
+}
+
+if [ "${BASH_SOURCE[0]}" == "$0" ]; then
+    main "$@"
+fi
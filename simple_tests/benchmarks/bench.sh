@@ -0,0 +1,77 @@
+#!/bin/bash
+
+# =============================================================================
+# Benchmark Suite: Parse, Launch and Pipeline Throughput
+# Purpose:
+#   - Run shell_bench (parse_line/parse_segment microbenchmarks, in-process
+#     launch latency, batch-mode commands/s, pipeline MiB/s) and save its
+#     tab-separated results
+#   - Compare them against the committed baseline.tsv and fail when a hot path
+#     got slower than the tolerance allows
+#
+# How to run:
+#   - From project root:
+#       make bench            # build an -O2 copy under obj/bench, run, compare
+#       make bench-baseline   # same, then overwrite baseline.tsv
+#   - Or run directly on an existing build:
+#       bash simple_tests/benchmarks/bench.sh BUILD_DIR [--update]
+#
+# Environment:
+#   BENCH_TOLERANCE  allowed slowdown in percent before a row fails (default 25)
+#   BENCH_SCALE      multiplier for every iteration count (default 1)
+#   BENCH_BASELINE   baseline file to compare with or update
+# =============================================================================
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+BUILD_DIR="${1:?usage: bench.sh BUILD_DIR [--update]}"
+BASELINE="${BENCH_BASELINE:-$SCRIPT_DIR/baseline.tsv}"
+RESULTS="$BUILD_DIR/bench.tsv"
+TOLERANCE="${BENCH_TOLERANCE:-25}"
+
+if [ ! -x "$BUILD_DIR/shell_bench" ] || [ ! -x "$BUILD_DIR/my_shell" ]; then
+    echo "找不到 $BUILD_DIR/shell_bench 或 $BUILD_DIR/my_shell (請用 make bench)" >&2
+    exit 1
+fi
+
+echo "執行效能測試，結果寫入 $RESULTS..."
+"$BUILD_DIR/shell_bench" "$BUILD_DIR/my_shell" "${BENCH_SCALE:-1}" > "$RESULTS" || exit 1
+
+if [ "$2" = "--update" ]; then
+    cp "$RESULTS" "$BASELINE"
+    echo "已更新基準 $BASELINE"
+    exit 0
+fi
+
+if [ ! -f "$BASELINE" ]; then
+    cat "$RESULTS"
+    echo "沒有基準檔 $BASELINE，請先執行 make bench-baseline"
+    exit 0
+fi
+
+# Join on case+metric; "/s" units regress when they drop, latencies when they rise
+awk -F'\t' -v tol="$TOLERANCE" '
+    BEGIN { printf "%-24s %-6s %12s %12s %9s  %s\n", "case", "metric", "baseline", "current", "change", "unit" }
+    FNR == 1 { next }
+    NR == FNR { base[$1 "\t" $2] = $3; next }
+    {
+        key = $1 "\t" $2
+        if (!(key in base)) {
+            printf "%-24s %-6s %12s %12s %9s  %s (new)\n", $1, $2, "-", $3, "-", $4
+            next
+        }
+        b = base[key]
+        change = b > 0 ? ($3 - b) / b * 100 : 0
+        worse = ($4 ~ /\/s$/) ? -change : change
+        mark = worse > tol ? "  REGRESSION" : ""
+        if (mark != "")
+            failed++
+        printf "%-24s %-6s %12s %12s %+8.1f%%  %s%s\n", $1, $2, b, $3, change, $4, mark
+    }
+    END {
+        if (failed) {
+            printf "%d 項超過容許的 %s%% 退步\n", failed, tol
+            exit 1
+        }
+        printf "全部在容許範圍 (%s%%) 內\n", tol
+    }
+' "$BASELINE" "$RESULTS"
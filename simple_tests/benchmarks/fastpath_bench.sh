@@ -0,0 +1,79 @@
+#!/bin/bash
+
+# =============================================================================
+# Benchmark: In-shell Fast Paths vs External Binaries
+# Purpose:
+#   - Measure the throughput of common pipeline stages (cat, head, tail, wc,
+#     tee) run by the shell's fast paths and by the external binaries
+#     (MY_SHELL_FASTPATH=none), on the same generated data file
+#
+# How to run:
+#   - From project root:
+#       make bench-fastpath
+#   - Or run directly (size in MiB, runs per case):
+#       bash simple_tests/benchmarks/fastpath_bench.sh [MB] [RUNS]
+# =============================================================================
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../../" && pwd)"
+SHELL_BINARY="$PROJECT_ROOT/my_shell"
+
+MB="${1:-256}"
+RUNS="${2:-3}"
+WORK_DIR="$(mktemp -d)"
+DATA="$WORK_DIR/data.txt"
+
+if [ ! -x "$SHELL_BINARY" ]; then
+    echo "Shell binary not found at: $SHELL_BINARY (run make first)" >&2
+    exit 1
+fi
+
+# Benchmark cases: "name:command line", run inside WORK_DIR
+CASES=(
+    "cat>file:cat data.txt > out.txt"
+    "cat|wc-c:cat data.txt | wc -c"
+    "cat|cat:cat data.txt | cat > /dev/null"
+    "head-c|wc-c:head -c $((MB * 1024 * 512)) data.txt | wc -c"
+    "tail-n:tail -n 5 data.txt"
+    "wc-l:wc -l data.txt"
+    "cat|tail-n:cat data.txt | tail -n 1"
+    "cat|tee|wc-c:cat data.txt | tee out.txt | wc -c"
+)
+
+# Best wall time (ns) of RUNS runs of one command line under one mode
+best_time() {
+    local mode="$1" cmd="$2" best=0
+    for _ in $(seq 1 "$RUNS"); do
+        local start end
+        rm -f "$WORK_DIR/out.txt" # time the copy, not truncating the last one
+        start=$(date +%s%N)
+        (cd "$WORK_DIR" && MY_SHELL_FASTPATH="$mode" "$SHELL_BINARY" -c "$cmd" > /dev/null)
+        end=$(date +%s%N)
+        local t=$((end - start))
+        if [ "$best" -eq 0 ] || [ "$t" -lt "$best" ]; then
+            best=$t
+        fi
+    done
+    echo "$best"
+}
+
+# MiB/s for a run of t ns over the data file
+throughput() {
+    awk -v mb="$MB" -v t="$1" 'BEGIN { printf "%.0f", mb / (t / 1e9) }'
+}
+
+echo "生成 ${MB} MiB 測試資料..."
+yes 'the quick brown fox jumps over the lazy dog 0123456789' | head -c $((MB * 1024 * 1024)) > "$DATA"
+cat "$DATA" > /dev/null # warm the page cache
+
+printf '%-16s %16s %16s %9s\n' "case" "external MiB/s" "fastpath MiB/s" "speedup"
+for c in "${CASES[@]}"; do
+    name="${c%%:*}"
+    cmd="${c#*:}"
+    t_ext=$(best_time none "$cmd")
+    t_fast=$(best_time all "$cmd")
+    printf '%-16s %16s %16s %8sx\n' "$name" "$(throughput "$t_ext")" "$(throughput "$t_fast")" \
+        "$(awk -v a="$t_ext" -v b="$t_fast" 'BEGIN { printf "%.2f", a / b }')"
+done
+
+rm -rf "$WORK_DIR"
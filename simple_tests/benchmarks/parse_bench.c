@@ -0,0 +1,182 @@
+/*
+ * parse_bench.c - Parser throughput microbenchmark
+ *
+ * Compares the single-pass span lexer behind parse_line() against the old
+ * strtok_r chain (kept below as legacy_parse_line) on synthetic lines.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../include/arena.h"
+#include "../../include/builtin.h"
+#include "../../include/command.h"
+#include "../../include/parsecache.h"
+#include "../../include/shell.h"
+
+/* Legacy parser ---------------------------------------------------------- */
+
+struct legacy_process {
+    char *raw_cmd;
+    char **argv;
+    int argc;
+    char *infile;
+    char *outfile;
+    int type;
+    struct legacy_process *next;
+};
+
+struct legacy_job {
+    int mode;
+    char *full_cmd;
+    struct legacy_process *first;
+};
+
+static struct legacy_process *legacy_parse_segment(char *seg)
+{
+    char *token, *saveptr;
+    struct legacy_process *p = calloc(1, sizeof(*p));
+    p->raw_cmd = strdup(seg);
+
+    int cap = TOK_LEN, pos = 0;
+    p->argv = calloc(cap, sizeof(char *));
+    for (token = strtok_r(seg, TOK_DELIM, &saveptr); token; token = strtok_r(NULL, TOK_DELIM, &saveptr)) {
+        if (pos >= cap) {
+            cap *= 2;
+            p->argv = realloc(p->argv, cap * sizeof(char *));
+        }
+        if (strcmp(token, "<") == 0) {
+            token = strtok_r(NULL, TOK_DELIM, &saveptr);
+            p->infile = strdup(token);
+        } else if (strcmp(token, ">") == 0) {
+            token = strtok_r(NULL, TOK_DELIM, &saveptr);
+            p->outfile = strdup(token);
+        } else {
+            p->argv[pos++] = strdup(token);
+        }
+    }
+    p->argc = pos;
+    p->argv[pos] = NULL;
+    p->type = (p->argc > 0 ? get_cmd_id(p->argv[0]) : CMD_EXTERNAL);
+    return p;
+}
+
+static struct legacy_job *legacy_parse_line(const char *line)
+{
+    char *processed_line = strdup(line);
+    char *line_copy = strdup(processed_line);
+
+    int mode = FG_EXEC;
+    size_t len = strlen(line_copy);
+    if (len > 0 && line_copy[len - 1] == '&') {
+        mode = BG_EXEC;
+        line_copy[--len] = '\0';
+        while (len > 0 && line_copy[len - 1] == ' ')
+            line_copy[--len] = '\0';
+    }
+
+    char *seg, *saveptr;
+    struct legacy_job *j = calloc(1, sizeof(*j));
+    j->mode = mode;
+    j->full_cmd = strdup(processed_line);
+
+    struct legacy_process **tail = &j->first;
+    for (seg = strtok_r(line_copy, "|", &saveptr); seg; seg = strtok_r(NULL, "|", &saveptr)) {
+        while (*seg == ' ')
+            seg++;
+        *tail = legacy_parse_segment(seg);
+        tail = &(*tail)->next;
+    }
+
+    free(line_copy);
+    free(processed_line);
+    return j;
+}
+
+static void legacy_free_job(struct legacy_job *j)
+{
+    struct legacy_process *p = j->first;
+    while (p) {
+        struct legacy_process *next = p->next;
+        free(p->raw_cmd);
+        for (int i = 0; i < p->argc; i++)
+            free(p->argv[i]);
+        free(p->argv);
+        free(p->infile);
+        free(p->outfile);
+        free(p);
+        p = next;
+    }
+    free(j->full_cmd);
+    free(j);
+}
+
+/* Harness ----------------------------------------------------------------- */
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Build "cat < in | grep -v x0 y0 | grep -v x1 y1 ... > out" with the given shape */
+static char *make_pipeline(int stages, int args)
+{
+    size_t cap = 64 + (size_t) stages * (16 + args * 8);
+    char *line = malloc(cap);
+    size_t n = snprintf(line, cap, "cat < input.txt");
+    for (int s = 0; s < stages; s++) {
+        n += snprintf(line + n, cap - n, " | grep -v");
+        for (int a = 0; a < args; a++)
+            n += snprintf(line + n, cap - n, " x%d_%d", s, a);
+    }
+    snprintf(line + n, cap - n, " > output.txt");
+    return line;
+}
+
+static void run_case(const char *name, const char *line, int iters)
+{
+    size_t len = strlen(line);
+    char *buf = malloc(len + 1);
+
+    double t0 = now_sec();
+    for (int i = 0; i < iters; i++) {
+        struct legacy_job *j = legacy_parse_line(line);
+        legacy_free_job(j);
+    }
+    double legacy = iters / (now_sec() - t0);
+
+    t0 = now_sec();
+    for (int i = 0; i < iters; i++) {
+        memcpy(buf, line, len + 1);
+        struct job *j = parse_line(buf);
+        free_job(j);
+    }
+    double span = iters / (now_sec() - t0);
+
+    printf("%-24s %8zu %14.0f %14.0f %8.2fx\n", name, len, legacy, span, span / legacy);
+    free(buf);
+}
+
+int main(int argc, char **argv)
+{
+    int iters = argc > 1 ? atoi(argv[1]) : 20000;
+    parsecache_set_budget(0); /* time the lexer, not template cache hits */
+
+    printf("%-24s %8s %14s %14s %9s\n", "case", "bytes", "legacy lines/s", "span lines/s", "speedup");
+    run_case("simple", "ls -la /tmp", iters * 10);
+    char *line = make_pipeline(4, 4);
+    run_case("pipeline-4x4", line, iters);
+    free(line);
+    line = make_pipeline(16, 8);
+    run_case("pipeline-16x8", line, iters);
+    free(line);
+    line = make_pipeline(64, 16);
+    run_case("pipeline-64x16", line, iters / 10);
+    free(line);
+    return 0;
+}
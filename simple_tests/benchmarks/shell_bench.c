@@ -0,0 +1,478 @@
+/*
+ * shell_bench.c - Parse, launch, pipeline, completion and history search benchmark suite behind `make bench`
+ *
+ * Prints one tab-separated row per measurement:
+ *
+ *     case    metric    value    unit
+ *
+ * bench.sh compares the rows against baseline.tsv. Units ending in "/s" are
+ * better when higher, every other unit (latencies) when lower.
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../include/acct.h"
+#include "../../include/arena.h"
+#include "../../include/command.h"
+#include "../../include/complete.h"
+#include "../../include/histindex.h"
+#include "../../include/history.h"
+#include "../../include/jobs.h"
+#include "../../include/parsecache.h"
+#include "../../include/shell.h"
+#include "../../include/stats.h"
+
+extern char **environ;
+
+#define BENCH_REPEAT 5  // rate measurements per case, the median is reported
+#define BENCH_WARMUP 20 // untimed launches before sampling latencies
+
+static double scale = 1.0;  // multiplies every iteration count
+static char work_dir[] = "/tmp/shell_bench.XXXXXX";
+
+/* Helper: one TSV row */
+static void row(const char *name, const char *metric, double value, const char *unit)
+{
+    printf("%s\t%s\t%.*f\t%s\n", name, metric, value < 100 ? 2 : 0, value, unit);
+    fflush(stdout);
+}
+
+/* Helper: iteration count n scaled, at least 1 */
+static int scaled(int n)
+{
+    int s = (int) (n * scale);
+    return s > 0 ? s : 1;
+}
+
+static int cmp_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/* Helper: median of n rates */
+static double median(double *v, int n)
+{
+    qsort(v, n, sizeof(*v), cmp_double);
+    return v[n / 2];
+}
+
+/* Parse --------------------------------------------------------------------- */
+
+/* Build "cmd w0 w1 ... w(n-1)" */
+static char *make_argv_line(const char *cmd, int n)
+{
+    size_t cap = strlen(cmd) + 1 + (size_t) n * 8;
+    char *line = malloc(cap);
+    size_t len = snprintf(line, cap, "%s", cmd);
+    for (int i = 0; i < n; i++)
+        len += snprintf(line + len, cap - len, " w%d", i);
+    return line;
+}
+
+/* Build "cat < input.txt | grep -v x0 | ... | grep -v x(n-1) > output.txt" */
+static char *make_pipeline(int stages)
+{
+    size_t cap = 64 + (size_t) stages * 24;
+    char *line = malloc(cap);
+    size_t len = snprintf(line, cap, "cat < input.txt");
+    for (int s = 0; s < stages; s++)
+        len += snprintf(line + len, cap - len, " | grep -v x%d", s);
+    snprintf(line + len, cap - len, " > output.txt");
+    return line;
+}
+
+/* Build n words cycling through every quoting form the lexer handles */
+static char *make_quoted(int n)
+{
+    static const char *words[] = {"'single quoted'", "\"double $quoted\"", "back\\ slash", "mi'x'\"ed\"", "plain"};
+    size_t cap = 8 + (size_t) n * 24;
+    char *line = malloc(cap);
+    size_t len = snprintf(line, cap, "echo");
+    for (int i = 0; i < n; i++)
+        len += snprintf(line + len, cap - len, " %s", words[i % 5]);
+    return line;
+}
+
+/* parse_line() throughput in lines/s: history, replay, lexing and building */
+static void bench_parse_line(const char *name, const char *line, int iters)
+{
+    size_t len = strlen(line);
+    char *buf = malloc(len + 1);
+    double rate[BENCH_REPEAT];
+
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        long long t0 = acct_now();
+        for (int i = 0; i < iters; i++) {
+            memcpy(buf, line, len + 1);
+            free_job(parse_line(buf));
+        }
+        rate[r] = iters / ((acct_now() - t0) / 1e9);
+    }
+    row(name, "rate", median(rate, BENCH_REPEAT), "lines/s");
+    free(buf);
+}
+
+/* parse_segment() throughput in segments/s, one arena per segment as in parse_line() */
+static void bench_parse_segment(const char *name, const char *seg, int iters)
+{
+    size_t len = strlen(seg);
+    char *buf = malloc(len + 1);
+    double rate[BENCH_REPEAT];
+
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        long long t0 = acct_now();
+        for (int i = 0; i < iters; i++) {
+            struct arena *a = arena_create(ARENA_BLOCK_SIZE);
+            memcpy(buf, seg, len + 1);
+            parse_segment(a, buf);
+            arena_destroy(a);
+        }
+        rate[r] = iters / ((acct_now() - t0) / 1e9);
+    }
+    row(name, "rate", median(rate, BENCH_REPEAT), "segments/s");
+    free(buf);
+}
+
+static void bench_parse(void)
+{
+    /* the lexer and builder first: every line is a template cache miss */
+    parsecache_set_budget(0);
+    bench_parse_line("parse/simple", "ls -la /tmp", scaled(200000));
+
+    char *line = make_argv_line("echo", 512);
+    bench_parse_line("parse/argv-512", line, scaled(5000));
+    bench_parse_segment("segment/argv-512", line, scaled(5000));
+    free(line);
+
+    line = make_pipeline(64);
+    bench_parse_line("parse/pipeline-64", line, scaled(5000));
+    free(line);
+
+    line = make_quoted(128);
+    bench_parse_line("parse/quoted-128", line, scaled(10000));
+    bench_parse_segment("segment/quoted-128", line, scaled(10000));
+    free(line);
+
+    /* replay of a 16-stage pipeline with a stage appended */
+    line = make_pipeline(16);
+    add_history(line);
+    free(line);
+    char replay[64];
+    snprintf(replay, sizeof(replay), "replay %llu | wc -l", (unsigned long long) history_last());
+    bench_parse_line("parse/replay-16", replay, scaled(20000));
+
+    /* the same lines again, served from templates after the first one */
+    parsecache_set_budget(PARSECACHE_BUDGET);
+    bench_parse_line("parse/cached-simple", "ls -la /tmp", scaled(200000));
+    line = make_pipeline(64);
+    bench_parse_line("parse/cached-pipeline-64", line, scaled(5000));
+    free(line);
+    bench_parse_line("parse/cached-replay-16", replay, scaled(20000));
+}
+
+/* Launch -------------------------------------------------------------------- */
+
+/* Run line the way batch mode does and return its wall time in ns */
+static long long run_once(const char *line, char *buf)
+{
+    long long t0 = acct_now();
+    strcpy(buf, line);
+    jobs_reap(0);
+    struct job *j = parse_line(buf);
+    launch_job(j);
+    free_job(j);
+    return acct_now() - t0;
+}
+
+/* Commands/s and latency percentiles of n foreground runs of line */
+static void bench_launch(const char *name, const char *line, int n)
+{
+    char *buf = malloc(strlen(line) + 1);
+    long long *lat = malloc(n * sizeof(*lat));
+
+    for (int i = 0; i < BENCH_WARMUP; i++)
+        run_once(line, buf);
+
+    long long total = 0;
+    for (int i = 0; i < n; i++) {
+        lat[i] = run_once(line, buf);
+        total += lat[i];
+    }
+    qsort(lat, n, sizeof(*lat), cmp_ll);
+
+    row(name, "rate", n / (total / 1e9), "cmds/s");
+    row(name, "p50", lat[(n - 1) / 2] / 1e3, "us");
+    row(name, "p99", lat[(n - 1) * 99 / 100] / 1e3, "us");
+    free(lat);
+    free(buf);
+}
+
+static void bench_launches(void)
+{
+    bench_launch("launch/true", "true", scaled(2000));
+    bench_launch("launch/builtin", "echo bench > /dev/null", scaled(20000));
+    bench_launch("launch/pipe-2", "true | true", scaled(1000));
+    bench_launch("launch/pipe-8", "true | true | true | true | true | true | true | true", scaled(300));
+}
+
+/* Batch mode ---------------------------------------------------------------- */
+
+/* Commands/s of `shell script` where the script repeats line n times */
+static void bench_batch(const char *name, const char *shell_bin, const char *line, int n)
+{
+    char script[sizeof(work_dir) + 16];
+    snprintf(script, sizeof(script), "%s/script.sh", work_dir);
+    FILE *f = fopen(script, "w");
+    if (!f) {
+        perror(script);
+        return;
+    }
+    for (int i = 0; i < n; i++)
+        fprintf(f, "%s\n", line);
+    fclose(f);
+
+    posix_spawn_file_actions_t fa;
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_addopen(&fa, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    char *argv[] = {(char *) shell_bin, script, NULL};
+
+    double rate[BENCH_REPEAT];
+    int r;
+    for (r = 0; r < BENCH_REPEAT; r++) {
+        pid_t pid;
+        int status;
+        long long t0 = acct_now();
+        if (posix_spawn(&pid, shell_bin, &fa, NULL, argv, environ) != 0 || waitpid(pid, &status, 0) < 0) {
+            perror(shell_bin);
+            break;
+        }
+        rate[r] = n / ((acct_now() - t0) / 1e9);
+    }
+    if (r == BENCH_REPEAT)
+        row(name, "rate", median(rate, BENCH_REPEAT), "cmds/s");
+    posix_spawn_file_actions_destroy(&fa);
+    unlink(script);
+}
+
+/* Pipeline throughput ------------------------------------------------------- */
+
+/* MiB/s of line moving mb MiB, best of BENCH_REPEAT runs */
+static void bench_pipe(const char *name, const char *line, int mb)
+{
+    char *buf = malloc(strlen(line) + 1);
+    long long best = 0;
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        long long t = run_once(line, buf);
+        if (!best || t < best)
+            best = t;
+    }
+    row(name, "rate", mb / (best / 1e9), "MiB/s");
+    free(buf);
+}
+
+static void bench_pipes(void)
+{
+    int mb = scaled(256);
+    char data[sizeof(work_dir) + 16];
+    snprintf(data, sizeof(data), "%s/data", work_dir);
+
+    /* mb MiB of 64-byte lines, written once */
+    FILE *f = fopen(data, "w");
+    if (!f) {
+        perror(data);
+        return;
+    }
+    char chunk[1 << 16];
+    for (size_t i = 0; i < sizeof(chunk); i++)
+        chunk[i] = (i % 64 == 63) ? '\n' : 'a' + i % 26;
+    for (int i = 0; i < mb * 16; i++)
+        fwrite(chunk, 1, sizeof(chunk), f);
+    fclose(f);
+
+    char line[sizeof(data) + 128];
+    snprintf(line, sizeof(line), "cat %s | cat | cat > /dev/null", data);
+    bench_pipe("pipe/fastpath-3", line, mb);
+    snprintf(line, sizeof(line), "/bin/cat %s | /bin/cat | /bin/cat > /dev/null", data);
+    bench_pipe("pipe/external-3", line, mb);
+    snprintf(line, sizeof(line), "@pipe=1M /bin/cat %s | /bin/cat | /bin/cat > /dev/null", data);
+    bench_pipe("pipe/external-1m-3", line, mb);
+    snprintf(line, sizeof(line), "@cpu=auto /bin/cat %s | @cpu=auto /bin/cat | @cpu=auto /bin/cat > /dev/null", data);
+    bench_pipe("pipe/auto-3", line, mb);
+    snprintf(line, sizeof(line), "/bin/cat %s | /bin/cat | wc -c > /dev/null", data);
+    bench_pipe("pipe/mixed-3", line, mb);
+    unlink(data);
+}
+
+/* Completion ---------------------------------------------------------------- */
+
+/* Latency of command completion with n extra executables in PATH: names of
+ * 6 to 12 pseudo-random letters, completed from 1- to 4-letter prefixes */
+static void bench_complete(const char *name, int n)
+{
+    char dir[sizeof(work_dir) + 16];
+    snprintf(dir, sizeof(dir), "%s/path", work_dir);
+    if (mkdir(dir, 0755) < 0) {
+        perror(dir);
+        return;
+    }
+
+    char (*names)[16] = malloc(n * sizeof(*names));
+    int dir_fd = open(dir, O_RDONLY | O_DIRECTORY);
+    unsigned int seed = 12345;
+    for (int i = 0; i < n; i++) {
+        int len = 6 + (seed = seed * 1103515245 + 12345) / 65536 % 7;
+        for (int k = 0; k < len; k++)
+            names[i][k] = 'a' + (seed = seed * 1103515245 + 12345) / 65536 % 26;
+        names[i][len] = '\0';
+        int fd = openat(dir_fd, names[i], O_WRONLY | O_CREAT, 0755);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    char *old = getenv("PATH") ? strdup(getenv("PATH")) : NULL;
+    char path[sizeof(dir) + 4096];
+    snprintf(path, sizeof(path), "%s:%s", dir, old ? old : "");
+    setenv("PATH", path, 1);
+
+    char ext[256];
+    complete_command("", ext, sizeof(ext)); /* index PATH once */
+    int samples = scaled(20000);
+    long long *lat = malloc(samples * sizeof(*lat));
+    for (int i = 0; i < samples; i++) {
+        char prefix[8];
+        snprintf(prefix, sizeof(prefix), "%.*s", 1 + i % 4, names[i % n]);
+        long long t0 = acct_now();
+        complete_command(prefix, ext, sizeof(ext));
+        lat[i] = acct_now() - t0;
+    }
+    qsort(lat, samples, sizeof(*lat), cmp_ll);
+    row(name, "p50", lat[(samples - 1) / 2] / 1e3, "us");
+    row(name, "p99", lat[(samples - 1) * 99 / 100] / 1e3, "us");
+
+    if (old)
+        setenv("PATH", old, 1);
+    free(old);
+    for (int i = 0; i < n; i++)
+        unlinkat(dir_fd, names[i], 0);
+    close(dir_fd);
+    rmdir(dir);
+    free(names);
+    free(lat);
+}
+
+/* History search ------------------------------------------------------------ */
+
+#define BENCH_HIST_ENTRIES 262144  // store size for the history cases
+
+/* Helper: append n made-up command lines to the history */
+static void fill_history(int n, unsigned int *seed)
+{
+    static const char *const forms[] = {
+        "git commit -m 'fix issue %u'", "make -j%u test", "cd ~/src/module%u", "grep -rn todo_%u src",
+        "ls -la build/out%u",           "ssh host%u.lan", "vim notes/%u.txt",  "./run.sh --seed %u",
+    };
+    char line[64];
+    for (int i = 0; i < n; i++) {
+        unsigned int r = (*seed = *seed * 1103515245 + 12345) / 65536;
+        snprintf(line, sizeof(line), forms[r % 8], r % 100000);
+        add_history(line);
+    }
+}
+
+/* Latency of history_search() for 6-byte pieces of random entries, once the
+ * index has caught up: it should not grow with the number of entries */
+static void bench_history(const char *name, unsigned int *seed)
+{
+    uint64_t first = history_first(), last = history_last();
+    if (!first)
+        return;
+    history_search("bench", 0); /* build or update the index */
+
+    int samples = scaled(20000);
+    long long *lat = malloc(samples * sizeof(*lat));
+    for (int i = 0; i < samples; i++) {
+        unsigned int r = (*seed = *seed * 1103515245 + 12345) / 65536;
+        const char *line = history_get(first + r % (last - first + 1));
+        char pattern[8];
+        size_t len = line ? strlen(line) : 0;
+        int plen = 1 + i % 6; /* 1-2 bytes hit the bigram lists, 3-6 the trigram ones */
+        snprintf(pattern, sizeof(pattern), "%.*s", plen, len > 6 ? line + r % (len - 6) : "ls");
+        long long t0 = acct_now();
+        history_search(pattern, 0);
+        lat[i] = acct_now() - t0;
+    }
+    qsort(lat, samples, sizeof(*lat), cmp_ll);
+    row(name, "p50", lat[(samples - 1) / 2] / 1e3, "us");
+    row(name, "p99", lat[(samples - 1) * 99 / 100] / 1e3, "us");
+    free(lat);
+}
+
+int main(int argc, char **argv)
+{
+    const char *shell_bin = argc > 1 ? argv[1] : NULL;
+    if (argc > 2)
+        scale = atof(argv[2]);
+    if (scale <= 0)
+        scale = 1.0;
+
+    if (!mkdtemp(work_dir)) {
+        perror(work_dir);
+        return 1;
+    }
+
+    /* keep the user's history, accounting, tracing, pipe sizes and metrics files out of the numbers */
+    char hist[sizeof(work_dir) + 16];
+    snprintf(hist, sizeof(hist), "%s/history", work_dir);
+    setenv(HIST_FILE_ENV, hist, 1);
+    char hist_size[16];
+    snprintf(hist_size, sizeof(hist_size), "%d", BENCH_HIST_ENTRIES);
+    setenv(HIST_SIZE_ENV, hist_size, 1);
+    setenv(HIST_BYTES_ENV, "33554432", 1);
+    unsetenv(ACCT_ENV);
+    unsetenv("MY_SHELL_TRACE");
+    unsetenv(PIPE_ENV);
+    unsetenv(PARSECACHE_ENV);
+    setenv(STATS_ENV, "off", 1);
+
+    /* never take over the terminal */
+    int null_fd = open("/dev/null", O_RDONLY);
+    dup2(null_fd, STDIN_FILENO);
+    close(null_fd);
+    shell_init();
+
+    printf("case\tmetric\tvalue\tunit\n");
+    bench_parse();
+    bench_launches();
+    if (shell_bin) {
+        bench_batch("batch/true", shell_bin, "true", scaled(2000));
+        bench_batch("batch/builtin", shell_bin, "echo bench > /dev/null", scaled(20000));
+    }
+    bench_pipes();
+    bench_complete("complete/path-10k", 10000);
+
+    unsigned int seed = 4321;
+    fill_history(20000, &seed);
+    bench_history("history/search-20k", &seed);
+    fill_history(180000, &seed);
+    bench_history("history/search-200k", &seed);
+
+    unlink(hist);
+    rmdir(work_dir);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * spawn_bench.c - Launch latency of each engine as the shell's heap grows
+ *
+ * Starts the zygote fork server while the process is small, then touches a
+ * growing heap and launches `true` through launch_job() with every engine.
+ * fork() copies the page tables of the whole heap; posix_spawn and the
+ * zygote should stay flat.
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../include/acct.h"
+#include "../../include/command.h"
+#include "../../include/exec.h"
+#include "../../include/history.h"
+#include "../../include/shell.h"
+
+static int cmp_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/* Print p50/p99 launch-to-exit latency of n runs of `true` */
+static void run_case(size_t heap_mb, int mode, int n)
+{
+    long long *lat = malloc(n * sizeof(*lat));
+    char buf[8];
+
+    shell.spawn_mode = mode;
+    for (int i = 0; i < n; i++) {
+        long long t0 = acct_now();
+        strcpy(buf, "true");
+        struct job *j = parse_line(buf);
+        launch_job(j);
+        free_job(j);
+        lat[i] = acct_now() - t0;
+    }
+    qsort(lat, n, sizeof(*lat), cmp_ll);
+    printf("%8zu %-8s %10.0f %10.0f\n", heap_mb, spawn_mode_name(mode), lat[(n - 1) / 2] / 1e3,
+           lat[(n - 1) * 99 / 100] / 1e3);
+    fflush(stdout);
+    free(lat);
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 200;
+    size_t max_mb = argc > 2 ? strtoul(argv[2], NULL, 10) : 1024;
+
+    /* the server must be forked before the heap grows; keep history private */
+    setenv(SPAWN_ENV, "zygote", 1);
+    char hist[64];
+    snprintf(hist, sizeof(hist), "/tmp/spawn_bench.%d.history", (int) getpid());
+    setenv(HIST_FILE_ENV, hist, 1);
+    int null_fd = open("/dev/null", O_RDONLY);
+    dup2(null_fd, STDIN_FILENO);
+    close(null_fd);
+    shell_init();
+    unlink(hist); /* stays mapped */
+    if (shell.spawn_mode != SPAWN_ZYGOTE) {
+        fprintf(stderr, "zygote did not start\n");
+        return 1;
+    }
+
+    printf("%8s %-8s %10s %10s\n", "heap MiB", "engine", "p50 us", "p99 us");
+    char *heap = NULL;
+    for (size_t mb = 0; mb <= max_mb; mb = mb ? mb * 4 : 64) {
+        /* resident, written pages: every one costs fork() a page-table entry */
+        free(heap);
+        heap = mb ? malloc(mb << 20) : NULL;
+        if (mb && !heap) {
+            perror("malloc");
+            return 1;
+        }
+        if (heap)
+            memset(heap, 1, mb << 20);
+        run_case(mb, SPAWN_FORK, n);
+        run_case(mb, SPAWN_POSIX, n);
+        run_case(mb, SPAWN_ZYGOTE, n);
+    }
+    free(heap);
+    return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * acct.c - Per-process and per-job resource accounting (time, MY_SHELL_ACCT)
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/acct.h"
+#include "../include/command.h"
+#include "../include/shell.h"
+#include "../include/trace.h"
+
+/* Reporting configuration from MY_SHELL_ACCT */
+static struct {
+    int all;      // report every job on stderr
+    int json_fd;  // JSON lines log, -1 if none
+} acct_cfg = {0, -1};
+
+void acct_init(void)
+{
+    const char *env = getenv(ACCT_ENV);
+    if (!env || !*env || strcmp(env, "0") == 0)
+        return;
+    if (strcmp(env, "1") == 0 || strcmp(env, "stderr") == 0) {
+        acct_cfg.all = 1;
+        return;
+    }
+    acct_cfg.json_fd = open(env, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (acct_cfg.json_fd < 0)
+        perror(env);
+}
+
+long long acct_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Helper: timeval in microseconds */
+static long tv_us(const struct timeval *tv)
+{
+    return tv->tv_sec * 1000000L + tv->tv_usec;
+}
+
+/* Record the exit of p with its wait status and rusage (NULL if unknown) */
+void acct_exit(struct process *p, int status, const struct rusage *ru)
+{
+    struct proc_acct *a = &p->acct;
+    a->end_ns = acct_now();
+    a->status = status;
+    TRACE_PROCESS(p);
+    if (!ru)
+        return;
+    a->user_us = tv_us(&ru->ru_utime);
+    a->sys_us = tv_us(&ru->ru_stime);
+    a->maxrss_kb = ru->ru_maxrss;
+    a->nvcsw = ru->ru_nvcsw;
+    a->nivcsw = ru->ru_nivcsw;
+}
+
+/* Record a builtin that ran inside the shell, from the shell's rusage before it */
+void acct_self(struct process *p, const struct rusage *before)
+{
+    struct rusage now;
+    getrusage(RUSAGE_SELF, &now);
+    acct_exit(p, 0, &now);
+    p->acct.user_us -= tv_us(&before->ru_utime);
+    p->acct.sys_us -= tv_us(&before->ru_stime);
+    p->acct.nvcsw -= before->ru_nvcsw;
+    p->acct.nivcsw -= before->ru_nivcsw;
+}
+
+/* Helper: "0", "1", ... for exits, "sig9" for signals */
+static const char *status_str(int status, char *buf, size_t len)
+{
+    if (WIFSIGNALED(status))
+        snprintf(buf, len, "sig%d", WTERMSIG(status));
+    else
+        snprintf(buf, len, "%d", WEXITSTATUS(status));
+    return buf;
+}
+
+/* Helper: segment text without surrounding blanks */
+static int trimmed(const char *s, const char **start)
+{
+    if (!s)
+        s = "";
+    while (*s == ' ' || *s == '\t')
+        s++;
+    int n = strlen(s);
+    while (n > 0 && (s[n - 1] == ' ' || s[n - 1] == '\t' || s[n - 1] == '\n'))
+        n--;
+    *start = s;
+    return n;
+}
+
+/* Helper: s as a JSON string body (quotes, backslashes and controls escaped) */
+static char *json_escape(const char *s, int n)
+{
+    char *out = malloc(n * 6 + 1), *w = out;
+    if (!out)
+        return NULL;
+    for (int i = 0; i < n; i++) {
+        unsigned char c = s[i];
+        if (c == '"' || c == '\\')
+            w += sprintf(w, "\\%c", c);
+        else if (c < 0x20)
+            w += sprintf(w, "\\u%04x", c);
+        else
+            *w++ = c;
+    }
+    *w = '\0';
+    return out;
+}
+
+/* Helper: one JSON object per stage and one for the job */
+static void report_json(const struct job *j, long long real_ns, const struct proc_acct *sum)
+{
+    int fd = acct_cfg.json_fd;
+    int stage = 0;
+    const char *cmd;
+    char st[16];
+
+    for (const struct process *p = j->first; p; p = p->next) {
+        const struct proc_acct *a = &p->acct;
+        int n = trimmed(p->raw_cmd, &cmd);
+        char *esc = json_escape(cmd, n);
+        pprintf(fd,
+                "{\"type\":\"stage\",\"stage\":%d,\"pid\":%d,\"status\":\"%s\",\"real_us\":%lld,"
+                "\"user_us\":%ld,\"sys_us\":%ld,\"maxrss_kb\":%ld,\"nvcsw\":%ld,\"nivcsw\":%ld,"
+                "\"spawn_us\":%lld,\"cmd\":\"%s\"}\n",
+                ++stage, (int) p->pid, status_str(a->status, st, sizeof(st)),
+                a->end_ns ? (a->end_ns - a->start_ns) / 1000 : 0, a->user_us, a->sys_us, a->maxrss_kb, a->nvcsw,
+                a->nivcsw, a->spawn_ns / 1000, esc ? esc : "");
+        free(esc);
+        out_flush(fd);
+    }
+
+    int n = trimmed(j->full_cmd, &cmd);
+    char *esc = json_escape(cmd, n);
+    pprintf(fd,
+            "{\"type\":\"job\",\"stages\":%d,\"real_us\":%lld,\"user_us\":%ld,\"sys_us\":%ld,"
+            "\"maxrss_kb\":%ld,\"nvcsw\":%ld,\"nivcsw\":%ld,\"cmd\":\"%s\"}\n",
+            stage, real_ns / 1000, sum->user_us, sum->sys_us, sum->maxrss_kb, sum->nvcsw, sum->nivcsw,
+            esc ? esc : "");
+    free(esc);
+    out_flush(fd);
+}
+
+/* Print j's per-stage and total figures if it was timed or accounting is on */
+void acct_report(const struct job *j)
+{
+    if (!j->first || !(j->timed || acct_cfg.all || acct_cfg.json_fd >= 0))
+        return;
+
+    /* the job ends with its last stage; totals add CPU and switches up */
+    struct proc_acct sum;
+    memset(&sum, 0, sizeof(sum));
+    for (const struct process *p = j->first; p; p = p->next) {
+        const struct proc_acct *a = &p->acct;
+        if (a->end_ns > sum.end_ns)
+            sum.end_ns = a->end_ns;
+        if (a->maxrss_kb > sum.maxrss_kb)
+            sum.maxrss_kb = a->maxrss_kb;
+        sum.user_us += a->user_us;
+        sum.sys_us += a->sys_us;
+        sum.nvcsw += a->nvcsw;
+        sum.nivcsw += a->nivcsw;
+    }
+    long long real_ns = (sum.end_ns ? sum.end_ns : acct_now()) - j->start_ns;
+
+    if (acct_cfg.json_fd >= 0)
+        report_json(j, real_ns, &sum);
+    if (!j->timed && !acct_cfg.all)
+        return;
+
+    int fd = STDERR_FILENO, stage = 0;
+    const char *cmd;
+    char st[16];
+    pprintf(fd, "%-6s %7s %7s %9s %9s %9s %9s %6s %6s %9s  %s\n", "stage", "pid", "status", "real", "user", "sys",
+            "maxrss", "vcsw", "ivcsw", "spawn", "command");
+    for (const struct process *p = j->first; p; p = p->next) {
+        const struct proc_acct *a = &p->acct;
+        int n = trimmed(p->raw_cmd, &cmd);
+        char pid[16] = "shell"; /* a builtin run in the shell: its rusage is the shell's */
+        if (p->pid > 0)
+            snprintf(pid, sizeof(pid), "%d", (int) p->pid);
+        pprintf(fd, "%-6d %7s %7s %8.3fs %8.3fs %8.3fs %7ldkB %6ld %6ld %7.0fus  %.*s\n", ++stage, pid,
+                status_str(a->status, st, sizeof(st)), a->end_ns ? (a->end_ns - a->start_ns) / 1e9 : 0.0,
+                a->user_us / 1e6, a->sys_us / 1e6, a->maxrss_kb, a->nvcsw, a->nivcsw, a->spawn_ns / 1e3, n, cmd);
+    }
+    pprintf(fd, "%-6s %7s %7s %8.3fs %8.3fs %8.3fs %7ldkB %6ld %6ld\n", "job", "", "", real_ns / 1e9,
+            sum.user_us / 1e6, sum.sys_us / 1e6, sum.maxrss_kb, sum.nvcsw, sum.nivcsw);
+}
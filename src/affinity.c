@@ -0,0 +1,155 @@
+/*
+ * affinity.c - Per-stage CPU affinity, niceness and scheduling policy
+ */
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "../include/affinity.h"
+#include "../include/arena.h"
+#include "../include/shell.h"
+
+/* Scheduling policies accepted by @sched= */
+static const struct {
+    const char *name;
+    int policy;
+} stage_policies[] = {
+    {"other", SCHED_OTHER},
+    {"batch", SCHED_BATCH},
+    {"idle", SCHED_IDLE},
+};
+#define NUM_STAGE_POLICIES (int) (sizeof(stage_policies) / sizeof(*stage_policies))
+
+/* @cpu=auto state: the CPUs the shell may run on and the next one to hand out */
+static struct {
+    cpu_set_t allowed;
+    int loaded;  // allowed has been read
+    int next;    // CPU number to try first
+} auto_cpu;
+
+/* Helper: parse "0-3,8,10-11" into set; returns 0 or -1 */
+static int parse_cpu_list(const char *s, cpu_set_t *set)
+{
+    CPU_ZERO(set);
+    while (*s) {
+        char *end;
+        long lo = strtol(s, &end, 10), hi = lo;
+        if (end == s || lo < 0)
+            return -1;
+        s = end;
+        if (*s == '-') {
+            hi = strtol(s + 1, &end, 10);
+            if (end == s + 1 || hi < lo)
+                return -1;
+            s = end;
+        }
+        if (hi >= CPU_SETSIZE)
+            return -1;
+        for (long cpu = lo; cpu <= hi; cpu++)
+            CPU_SET(cpu, set);
+        if (*s == ',' && s[1])
+            s++;
+        else if (*s)
+            return -1;
+    }
+    return CPU_COUNT(set) > 0 ? 0 : -1;
+}
+
+/* Parse one word into s: 1 if it was a stage prefix, 0 if not, -1 if invalid */
+int stage_sched_parse(struct arena *a, struct stage_sched *s, const char *word)
+{
+    if (word[0] != STAGE_PREFIX)
+        return 0;
+
+    const char *val = strchr(word, '=');
+    if (!val)
+        return 0;
+    size_t key_len = val - word - 1;
+    val++;
+
+    if (key_len == 3 && strncmp(word + 1, "cpu", 3) == 0) {
+        s->cpus = arena_alloc(a, sizeof(*s->cpus));
+        if (strcmp(val, "auto") == 0) {
+            s->flags = (s->flags | STAGE_CPU_AUTO) & ~STAGE_CPU;
+            return 1;
+        }
+        if (parse_cpu_list(val, s->cpus) == 0) {
+            s->flags = (s->flags | STAGE_CPU) & ~STAGE_CPU_AUTO;
+            return 1;
+        }
+        pprintf(STDERR_FILENO, "%s: expected a CPU list such as 0-3,8 or auto\n", word);
+        return -1;
+    }
+
+    if (key_len == 4 && strncmp(word + 1, "nice", 4) == 0) {
+        char *end;
+        long nice = strtol(val, &end, 10);
+        if (end != val && *end == '\0' && nice >= -20 && nice <= 19) {
+            s->nice = nice;
+            s->flags |= STAGE_NICE;
+            return 1;
+        }
+        pprintf(STDERR_FILENO, "%s: expected a niceness from -20 to 19\n", word);
+        return -1;
+    }
+
+    if (key_len == 5 && strncmp(word + 1, "sched", 5) == 0) {
+        for (int i = 0; i < NUM_STAGE_POLICIES; i++) {
+            if (strcmp(val, stage_policies[i].name) == 0) {
+                s->policy = stage_policies[i].policy;
+                s->flags |= STAGE_POLICY;
+                return 1;
+            }
+        }
+        pprintf(STDERR_FILENO, "%s: expected other, batch or idle\n", word);
+        return -1;
+    }
+
+    return 0; /* some other @word: leave it to the command */
+}
+
+/* Give an @cpu=auto stage the next CPU the shell is allowed to use */
+void stage_sched_resolve(struct stage_sched *s)
+{
+    if (!(s->flags & STAGE_CPU_AUTO))
+        return;
+
+    if (!auto_cpu.loaded) {
+        if (sched_getaffinity(0, sizeof(auto_cpu.allowed), &auto_cpu.allowed) < 0 ||
+            CPU_COUNT(&auto_cpu.allowed) == 0) {
+            CPU_ZERO(&auto_cpu.allowed);
+            CPU_SET(0, &auto_cpu.allowed);
+        }
+        auto_cpu.loaded = 1;
+    }
+
+    /* round-robin from where the last auto stage left off */
+    int cpu = auto_cpu.next;
+    while (!CPU_ISSET(cpu % CPU_SETSIZE, &auto_cpu.allowed))
+        cpu++;
+    cpu %= CPU_SETSIZE;
+    auto_cpu.next = cpu + 1;
+
+    CPU_ZERO(s->cpus);
+    CPU_SET(cpu, s->cpus);
+}
+
+/* Apply s to the calling process; a setting the kernel refuses is reported
+ * and skipped, the command still runs */
+void stage_sched_apply(const struct stage_sched *s)
+{
+    if ((s->flags & (STAGE_CPU | STAGE_CPU_AUTO)) && sched_setaffinity(0, sizeof(*s->cpus), s->cpus) < 0)
+        perror("@cpu");
+    if ((s->flags & STAGE_POLICY)) {
+        struct sched_param param = {0};
+        if (sched_setscheduler(0, s->policy, &param) < 0)
+            perror("@sched");
+    }
+    if ((s->flags & STAGE_NICE) && setpriority(PRIO_PROCESS, 0, s->nice) < 0)
+        perror("@nice");
+}
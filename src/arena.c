@@ -0,0 +1,107 @@
+/*
+ * arena.c - Bump allocator for per-job parser data
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/arena.h"
+
+#define ALIGN_UP(n) (((n) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+
+struct arena_stats arena_stats;
+
+/* Helper: malloc a block with room for n bytes after the header */
+static struct arena_block *block_new(size_t n)
+{
+    struct arena_block *b = malloc(sizeof(*b) + n);
+    if (!b) {
+        perror("my_shell: arena");
+        abort();
+    }
+    arena_stats.mallocs++;
+    b->next = NULL;
+    b->size = n;
+    b->used = 0;
+    return b;
+}
+
+/* Create an arena whose first block (and the arena itself) is one malloc */
+struct arena *arena_create(size_t size)
+{
+    size_t header = ALIGN_UP(sizeof(struct arena));
+    struct arena_block *b = block_new(header + ALIGN_UP(size));
+    struct arena *a = (struct arena *) b->data;
+    b->used = header;
+    a->block = b;
+    a->last = NULL;
+    return a;
+}
+
+/* Release every block; the arena header goes with the first one */
+void arena_destroy(struct arena *a)
+{
+    if (!a)
+        return;
+    struct arena_block *b = a->block;
+    while (b) {
+        struct arena_block *next = b->next;
+        free(b);
+        b = next;
+    }
+}
+
+void *arena_alloc(struct arena *a, size_t n)
+{
+    struct arena_block *b = a->block;
+    n = ALIGN_UP(n);
+    if (b->size - b->used < n) {
+        /* chain a fresh block, at least as large as the previous one */
+        size_t size = b->size > n ? b->size : n;
+        struct arena_block *nb = block_new(size);
+        nb->next = b;
+        a->block = b = nb;
+    }
+    void *p = b->data + b->used;
+    b->used += n;
+    a->last = p;
+    arena_stats.allocs++;
+    arena_stats.bytes += n;
+    return p;
+}
+
+void *arena_calloc(struct arena *a, size_t n)
+{
+    return memset(arena_alloc(a, n), 0, n);
+}
+
+/* Grow ptr; the most recent allocation is extended in place when it fits */
+void *arena_realloc(struct arena *a, void *ptr, size_t old_n, size_t new_n)
+{
+    struct arena_block *b = a->block;
+    if (ptr && ptr == a->last) {
+        size_t start = (char *) ptr - b->data;
+        if (start + ALIGN_UP(new_n) <= b->size) {
+            b->used = start + ALIGN_UP(new_n);
+            return ptr;
+        }
+    }
+    void *p = arena_alloc(a, new_n);
+    if (ptr)
+        memcpy(p, ptr, old_n < new_n ? old_n : new_n);
+    return p;
+}
+
+char *arena_strndup(struct arena *a, const char *s, size_t n)
+{
+    char *p = arena_alloc(a, n + 1);
+    memcpy(p, s, n);
+    p[n] = '\0';
+    return p;
+}
+
+char *arena_strdup(struct arena *a, const char *s)
+{
+    return arena_strndup(a, s, strlen(s));
+}
@@ -2,6 +2,8 @@
  * builtin.c - Built-in command implementations
  */
 
+#define _GNU_SOURCE
+#include <dlfcn.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,25 +12,51 @@
 
 #include "../include/builtin.h"
 #include "../include/command.h"
+#include "../include/exec.h"
+#include "../include/histindex.h"
+#include "../include/history.h"
+#include "../include/parsecache.h"
 #include "../include/shell.h"
 
+#include "builtin_hash.h" /* generated from builtins.def at build time */
+
 /* Table of built-in commands */
 struct builtin_cmd builtins[] = {
-    {"exit", cmd_exit, CMD_EXIT},       {"cd", cmd_cd, CMD_CD},
-    {"help", cmd_help, CMD_HELP},       {"echo", cmd_echo, CMD_ECHO},
-    {"record", cmd_record, CMD_RECORD}, {"replay", cmd_replay, CMD_REPLAY},
-    {"mypid", cmd_mypid, CMD_MYPID},
+#define BUILTIN(name, func, id) {#name, func, id},
+#include "../include/builtins.def"
+#undef BUILTIN
 };
 const int num_builtins = sizeof(builtins) / sizeof(*builtins);
 
+/* Builtins loaded from shared objects with `builtin -f` */
+static struct builtin_cmd dyn_builtins[MAX_DYN_BUILTINS];
+static void *dyn_handles[MAX_DYN_BUILTINS];
+static int num_dyn_builtins;
+
+/* Look up a builtin by name: one perfect-hash probe, then the loaded ones */
+const struct builtin_cmd *find_builtin(const char *name)
+{
+    int slot = builtin_hash_slots[builtin_hash(name, BUILTIN_HASH_SEED) & (BUILTIN_HASH_SIZE - 1)];
+    if (slot >= 0 && strcmp(name, builtins[slot].name) == 0)
+        return &builtins[slot];
+
+    for (int i = 0; i < num_dyn_builtins; i++) {
+        if (strcmp(name, dyn_builtins[i].name) == 0)
+            return &dyn_builtins[i];
+    }
+    return NULL;
+}
+
+const struct builtin_cmd *loaded_builtin(int i)
+{
+    return i >= 0 && i < num_dyn_builtins ? &dyn_builtins[i] : NULL;
+}
+
 /* Determine command type by name, return CMD_* */
 int get_cmd_id(const char *name)
 {
-    for (int i = 0; i < num_builtins; i++) {
-        if (strcmp(name, builtins[i].name) == 0)
-            return builtins[i].id;
-    }
-    return CMD_EXTERNAL;
+    const struct builtin_cmd *b = find_builtin(name);
+    return b ? b->id : CMD_EXTERNAL;
 }
 
 /* Built-in: help - list available built-ins */
@@ -42,9 +70,18 @@ int cmd_help(struct process *proc, int in_fd, int out_fd)
             "  help\t\tShow this help menu\n"
             "  cd [dir]\tChange directory to [dir] or $HOME\n"
             "  echo [-n]\tPrint arguments\n"
-            "  record\tShow last %d commands\n"
-            "  replay N\tRe-execute command #N from history\n"
-            "  mypid [-i|-p|-c] [pid]\tShow process IDs\n"
+            "  record [-p N] [-s PAT]\tShow last %d commands (page N counts back, -s: those containing PAT)\n"
+            "  replay N | ?PAT\tRe-execute command #N, or the newest one containing PAT\n"
+            "  mypid [-i|-p|-c|-t] [pid]\tShow process IDs or tree\n"
+            "  hash [-r] [-p path] [name]\tShow or manage the command path cache\n"
+            "  builtin [-f lib.so | -d] [name]\tList, load or unload built-ins\n"
+            "  timeout SECS cmd\tRun cmd, killing it after SECS[s|m|h|d]\n"
+            "  wait [-n] [%%job|pid]\tWait for background jobs (-n: the next one)\n"
+            "  parallel [-j N] [-k] cmd {}\tRun cmd for each input line, N at a time\n"
+            "  xargs [-n N] [-P N] [-0] cmd\tRun cmd with input items as arguments, ARG_MAX-sized batches\n"
+            "  trace [on FILE | off]\tWrite a Chrome trace of launches (make trace)\n"
+            "  parsecache [-r | -s SIZE]\tShow, clear or resize the parsed-line cache\n"
+            "  stats [-j | -r]\tShow shell metrics (-j: as JSON, -r: reset them)\n"
             "  exit\t\tExit the shell\n"
             "--------------------------------\n",
             MAX_HISTORY);
@@ -56,14 +93,15 @@ int cmd_cd(struct process *proc, int in_fd, int out_fd)
 {
     (void) in_fd;
     (void) out_fd;
+    int ret = 1;
     if (proc->argc == 1) {
         chdir(shell.home_dir);
-    } else {
-        if (chdir(proc->argv[1]) < 0)
-            pprintf(STDERR_FILENO, "cd: %s: %s\n", proc->argv[1], strerror(errno));
+    } else if (chdir(proc->argv[1]) < 0) {
+        pprintf(STDERR_FILENO, "cd: %s: %s\n", proc->argv[1], strerror(errno));
+        ret = -1;
     }
     update_cwd();
-    return 1;
+    return ret;
 }
 
 /* Built-in: echo [-n] */
@@ -75,34 +113,84 @@ int cmd_echo(struct process *proc, int in_fd, int out_fd)
         newline = 0;
         start = 2;
     }
+    /* arguments are queued by reference and leave in one writev */
     for (int i = start; i < proc->argc; i++) {
-        pprintf(out_fd, "%s", proc->argv[i]);
+        pputs(out_fd, proc->argv[i], strlen(proc->argv[i]));
         if (i < proc->argc - 1)
-            pprintf(out_fd, " ");
+            pputs(out_fd, " ", 1);
     }
     if (newline)
-        pprintf(out_fd, "\n");
+        pputs(out_fd, "\n", 1);
+    return 1;
+}
+
+/* Helper: page of the entries containing pattern, newest page first, oldest entry first.
+ * The newest entry is this record command itself, which would always match. */
+static int record_search(const char *pattern, long page, int out_fd)
+{
+    uint64_t ids[MAX_HISTORY], before = history_last();
+    uint64_t skip = (uint64_t) (page - 1) * MAX_HISTORY;
+    int n = 0;
+    while (n < MAX_HISTORY && (before = history_search(pattern, before)) != 0) {
+        if (skip > 0)
+            skip--;
+        else
+            ids[n++] = before;
+    }
+    while (n-- > 0) {
+        const char *line = history_get(ids[n]);
+        if (line)
+            pprintf(out_fd, "%2llu  %s\n", (unsigned long long) ids[n], line);
+    }
     return 1;
 }
 
-/* Built-in: record - show history */
+/* Built-in: record [-p PAGE] [-s PATTERN] - show history, newest page first */
 int cmd_record(struct process *proc, int in_fd, int out_fd)
 {
-    (void) proc;
     (void) in_fd;
-    for (int i = 0; i < history_count; i++) {
-        pprintf(out_fd, "%2d  %s\n", i + 1, history[i]);
+    long page = 1;
+    const char *page_arg = NULL, *pattern = NULL;
+    for (int i = 1; i < proc->argc; i += 2) {
+        if (i + 1 < proc->argc && strcmp(proc->argv[i], "-p") == 0) {
+            page_arg = proc->argv[i + 1];
+            page = atol(page_arg);
+        } else if (i + 1 < proc->argc && strcmp(proc->argv[i], "-s") == 0) {
+            pattern = proc->argv[i + 1];
+        } else {
+            pprintf(STDERR_FILENO, "usage: record [-p PAGE] [-s PATTERN]\n");
+            return -1;
+        }
+    }
+    if (page < 1) {
+        pprintf(STDERR_FILENO, "record: invalid page %s\n", page_arg);
+        return -1;
+    }
+    if (pattern)
+        return record_search(pattern, page, out_fd);
+
+    uint64_t first = history_first(), last = history_last();
+    uint64_t skip = (uint64_t) (page - 1) * MAX_HISTORY;
+    if (first == 0 || last - first < skip)
+        return 1; /* nothing on this page */
+
+    uint64_t hi = last - skip;
+    uint64_t lo = hi - first >= MAX_HISTORY ? hi - MAX_HISTORY + 1 : first;
+    for (uint64_t id = lo; id <= hi; id++) {
+        const char *line = history_get(id);
+        if (line)
+            pprintf(out_fd, "%2llu  %s\n", (unsigned long long) id, line);
     }
     return 1;
 }
 
-/* Built-in: mypid - [-i|-p|-c] [pid] */
+/* Built-in: mypid - [-i|-p|-c|-t] [pid] */
 int cmd_mypid(struct process *proc, int in_fd, int out_fd)
 {
     (void) in_fd;
 
     if (proc->argc < 2) {
-        pprintf(STDERR_FILENO, "usage: mypid [-i|-p|-c] [pid]\n");
+        pprintf(STDERR_FILENO, "usage: mypid [-i|-p|-c|-t] [pid]\n");
         return -1;
     }
 
@@ -114,6 +202,16 @@ int cmd_mypid(struct process *proc, int in_fd, int out_fd)
         return 1;
     }
 
+    if (strcmp(opt, "-t") == 0) {
+        /* -t: print the process tree, rooted at the shell by default */
+        pid_t root = proc->argc > 2 ? atoi(proc->argv[2]) : getpid();
+        if (print_proc_tree(root, out_fd) < 0) {
+            pprintf(STDERR_FILENO, "mypid -t: process id not exist\n");
+            return -1;
+        }
+        return 1;
+    }
+
     if (proc->argc < 3) {
         pprintf(STDERR_FILENO, "mypid %s: missing pid argument\n", opt);
         return -1;
@@ -140,6 +238,160 @@ int cmd_mypid(struct process *proc, int in_fd, int out_fd)
     }
 }
 
+/* Built-in: hash [-r] [-p path name] [name ...] */
+int cmd_hash(struct process *proc, int in_fd, int out_fd)
+{
+    (void) in_fd;
+
+    if (proc->argc == 1) {
+        path_cache_print(out_fd);
+        return 1;
+    }
+
+    if (strcmp(proc->argv[1], "-r") == 0) {
+        path_cache_clear();
+        return 1;
+    }
+
+    if (strcmp(proc->argv[1], "-p") == 0) {
+        if (proc->argc != 4) {
+            pprintf(STDERR_FILENO, "usage: hash -p path name\n");
+            return -1;
+        }
+        if (path_cache_insert(proc->argv[3], proc->argv[2]) < 0) {
+            pprintf(STDERR_FILENO, "hash: %s\n", strerror(errno));
+            return -1;
+        }
+        return 1;
+    }
+
+    /* hash name...: resolve and remember each name */
+    int ret = 1;
+    for (int i = 1; i < proc->argc; i++) {
+        if (!path_cache_lookup(proc->argv[i])) {
+            pprintf(STDERR_FILENO, "hash: %s: not found\n", proc->argv[i]);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/* Helper: load builtins `names` exported by the shared object at `path` */
+static int builtin_load(const char *path, char **names, int count)
+{
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        pprintf(STDERR_FILENO, "builtin: %s\n", dlerror());
+        return -1;
+    }
+
+    int loaded = 0, ret = 1;
+    for (int i = 0; i < count; i++) {
+        const struct builtin_cmd *old = find_builtin(names[i]);
+        if (old && old->id != CMD_DYNAMIC) {
+            pprintf(STDERR_FILENO, "builtin: %s: cannot replace a static built-in\n", names[i]);
+            ret = -1;
+            continue;
+        }
+
+        builtin_fn fn;
+        *(void **) &fn = dlsym(handle, names[i]);
+        if (!fn) {
+            pprintf(STDERR_FILENO, "builtin: %s: %s\n", names[i], dlerror());
+            ret = -1;
+            continue;
+        }
+
+        struct builtin_cmd *b = (struct builtin_cmd *) old;
+        if (!b) {
+            if (num_dyn_builtins == MAX_DYN_BUILTINS) {
+                pprintf(STDERR_FILENO, "builtin: %s: too many loaded built-ins\n", names[i]);
+                ret = -1;
+                continue;
+            }
+            b = &dyn_builtins[num_dyn_builtins++];
+            b->name = strdup(names[i]);
+            b->id = CMD_DYNAMIC;
+        } else {
+            dlclose(dyn_handles[b - dyn_builtins]);
+        }
+        b->func = fn;
+        dyn_handles[b - dyn_builtins] = handle;
+        if (loaded++)
+            dlopen(path, RTLD_NOW | RTLD_LOCAL); /* one reference per builtin */
+    }
+
+    if (!loaded)
+        dlclose(handle);
+    else
+        parsecache_clear(); /* templates hold the old lookup results */
+    return ret;
+}
+
+/* Helper: unload a builtin previously loaded with `builtin -f` */
+static int builtin_unload(const char *name)
+{
+    const struct builtin_cmd *b = find_builtin(name);
+    if (!b || b->id != CMD_DYNAMIC) {
+        pprintf(STDERR_FILENO, "builtin: %s: not a loaded built-in\n", name);
+        return -1;
+    }
+
+    int i = b - dyn_builtins;
+    free((char *) dyn_builtins[i].name);
+    dlclose(dyn_handles[i]);
+    num_dyn_builtins--;
+    dyn_builtins[i] = dyn_builtins[num_dyn_builtins];
+    dyn_handles[i] = dyn_handles[num_dyn_builtins];
+    parsecache_clear();
+    return 1;
+}
+
+/* Built-in: builtin [-f lib.so name... | -d name...] - list, load or unload built-ins */
+int cmd_builtin(struct process *proc, int in_fd, int out_fd)
+{
+    (void) in_fd;
+
+    if (proc->argc == 1) {
+        for (int i = 0; i < num_builtins; i++)
+            pprintf(out_fd, "builtin %s\n", builtins[i].name);
+        for (int i = 0; i < num_dyn_builtins; i++)
+            pprintf(out_fd, "builtin -f %s\n", dyn_builtins[i].name);
+        return 1;
+    }
+
+    if (strcmp(proc->argv[1], "-f") == 0) {
+        if (proc->argc < 4) {
+            pprintf(STDERR_FILENO, "usage: builtin -f lib.so name...\n");
+            return -1;
+        }
+        return builtin_load(proc->argv[2], proc->argv + 3, proc->argc - 3);
+    }
+
+    if (strcmp(proc->argv[1], "-d") == 0) {
+        if (proc->argc < 3) {
+            pprintf(STDERR_FILENO, "usage: builtin -d name...\n");
+            return -1;
+        }
+        int ret = 1;
+        for (int i = 2; i < proc->argc; i++) {
+            if (builtin_unload(proc->argv[i]) < 0)
+                ret = -1;
+        }
+        return ret;
+    }
+
+    /* builtin name...: report whether each name is a built-in */
+    int ret = 1;
+    for (int i = 1; i < proc->argc; i++) {
+        if (!find_builtin(proc->argv[i])) {
+            pprintf(STDERR_FILENO, "builtin: %s: not a shell built-in\n", proc->argv[i]);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
 /* Built-in: replay N - should not be called directly in normal cases
  * since replay is handled at parse time, but handle error cases */
 int cmd_replay(struct process *proc, int in_fd, int out_fd)
@@ -149,13 +401,16 @@ int cmd_replay(struct process *proc, int in_fd, int out_fd)
 
     /* This function should rarely be called since replay is handled in parse_line */
     if (proc->argc != 2) {
-        pprintf(STDERR_FILENO, "usage: replay N\n");
+        pprintf(STDERR_FILENO, "usage: replay N | replay ?PATTERN\n");
+        return -1;
+    }
+    if (proc->argv[1][0] == '?') {
+        pprintf(STDERR_FILENO, "replay: no entry contains %s\n", proc->argv[1] + 1);
         return -1;
     }
 
-    int idx = atoi(proc->argv[1]);
-    if (idx < 1 || idx > history_count) {
-        pprintf(STDERR_FILENO, "replay: invalid index %d\n", idx);
+    if (!history_get(strtoull(proc->argv[1], NULL, 10))) {
+        pprintf(STDERR_FILENO, "replay: invalid index %s\n", proc->argv[1]);
         return -1;
     }
 
@@ -8,172 +8,233 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "../include/arena.h"
 #include "../include/builtin.h"
 #include "../include/command.h"
+#include "../include/fastpath.h"
+#include "../include/histindex.h"
+#include "../include/history.h"
+#include "../include/lexer.h"
+#include "../include/parsecache.h"
+#include "../include/stats.h"
+#include "../include/trace.h"
 #include "../include/shell.h"
 
-/* Free a process and its resources */
-void free_process(struct process *p)
-{
-    if (!p)
-        return;
-    free(p->raw_cmd);
-
-    /* free individual argv strings */
-    if (p->argv) {
-        for (int i = 0; i < p->argc; i++) {
-            free(p->argv[i]);
-        }
-        free(p->argv);
-    }
-
-    free(p->infile);
-    free(p->outfile);
-    free(p);
-}
-
-/* Free a job and all its processes */
+/* Free a job and everything parsed into its arena */
 void free_job(struct job *j)
 {
     if (!j)
         return;
-
-    struct process *p = j->first;
-    while (p) {
-        struct process *next = p->next;
-        free_process(p);
-        p = next;
-    }
-
-    free(j->full_cmd);
-    free(j);
+    arena_destroy(j->arena);
 }
 
 /* Helper: process replay substitution in command line */
-char *process_replay(const char *line)
+char *process_replay(struct arena *a, const char *line)
 {
     /* Check if command starts with "replay " */
     if (strncmp(line, "replay ", 7) != 0) {
-        return strdup(line); /* No replay, return copy */
+        return arena_strdup(a, line); /* No replay, return copy */
     }
 
-    /* Find the replay number */
-    char *line_copy = strdup(line);
-    char *saveptr;
-    char *token = strtok_r(line_copy, " ", &saveptr); /* "replay" */
-    token = strtok_r(NULL, " ", &saveptr);            /* number */
-
-    if (!token) {
-        free(line_copy);
-        return strdup(line); /* Invalid format, return original */
+    /* Find the replay number, or ?PATTERN for the newest entry containing it */
+    const char *num = line + 7;
+    while (*num == ' ')
+        num++;
+    char *end;
+    const char *entry = NULL;
+    if (*num == '?') {
+        end = strchrnul(num, ' ');
+        char *pattern = arena_strndup(a, num + 1, end - num - 1);
+        entry = *pattern ? history_get(history_search(pattern, 0)) : NULL;
+    } else {
+        unsigned long long idx = strtoull(num, &end, 10);
+        entry = end != num ? history_get(idx) : NULL;
     }
 
-    int idx = atoi(token);
-
-    if (idx < 1 || idx > history_count) {
-        free(line_copy);
-        return strdup(line); /* Invalid index, return original */
+    if (!entry) {
+        return arena_strdup(a, line); /* Invalid format or index, return original */
     }
 
     /* Get the rest of the command line after "replay N" */
-    char *rest = strtok_r(NULL, "", &saveptr);
-
-    /* Build the new command: history[idx-1] + rest */
-    char *new_cmd = malloc(LINE_LEN);
-    strcpy(new_cmd, history[idx - 1]);
-
-    if (rest && *rest) {
+    const char *rest = end;
+    while (*rest == ' ')
+        rest++;
+
+    /* Build the new command: history entry N + rest */
+    size_t hist_len = strlen(entry);
+    size_t rest_len = strlen(rest);
+    char *new_cmd = arena_alloc(a, hist_len + rest_len + 2);
+    memcpy(new_cmd, entry, hist_len);
+    if (*rest) {
         /* Append the rest (e.g., "| head -1") */
-        strcat(new_cmd, rest);
+        new_cmd[hist_len++] = ' ';
+        memcpy(new_cmd + hist_len, rest, rest_len);
+        hist_len += rest_len;
     }
-
-    free(line_copy);
+    new_cmd[hist_len] = '\0';
     return new_cmd;
 }
 
-/* Parse a single command segment into a process struct */
-struct process *parse_segment(char *seg)
+/* Helper: build a process from the tokens of one pipeline segment.
+ * Words are unquoted in place in buf; argv is sized exactly from the spans. */
+static struct process *build_process(struct arena *a, char *buf, const struct token *toks, int ntok)
 {
-    char *token, *saveptr;
-    struct process *p = calloc(1, sizeof(*p));
-    p->raw_cmd = strdup(seg);
-
-    /* tokenize and collect args */
-    int cap = TOK_LEN, pos = 0;
-    p->argv = calloc(cap, sizeof(char *));
-    for (token = strtok_r(seg, TOK_DELIM, &saveptr); token; token = strtok_r(NULL, TOK_DELIM, &saveptr)) {
-        if (pos >= cap) {
-            cap *= 2;
-            p->argv = realloc(p->argv, cap * sizeof(char *));
+    struct process *p = arena_calloc(a, sizeof(*p));
+
+    /* keep the segment text before words are rewritten in place */
+    if (ntok > 0) {
+        const struct token *last = &toks[ntok - 1];
+        p->raw_cmd = arena_strndup(a, buf + toks[0].off, last->off + last->len - toks[0].off);
+    }
+
+    /* leading unquoted @cpu=/@nice=/@sched=/@pipe= words set up the stage, not argv */
+    while (ntok > 1 && toks[0].kind == LEX_WORD && !(toks[0].flags & LEXF_QUOTED) &&
+           buf[toks[0].off] == STAGE_PREFIX) {
+        const char *word = lex_word(buf, &toks[0]);
+        int r = stage_sched_parse(a, &p->sched, word);
+        if (r == 0)
+            r = pipe_opts_parse(&p->pipe, word);
+        if (r < 0)
+            return NULL;
+        if (r == 0)
+            break;
+        toks++;
+        ntok--;
+    }
+
+    int words = 0;
+    for (int i = 0; i < ntok; i++) {
+        if (toks[i].kind == LEX_WORD)
+            words++;
+    }
+    p->argv = arena_alloc(a, (words + 1) * sizeof(char *));
+
+    int pos = 0;
+    for (int i = 0; i < ntok; i++) {
+        const struct token *t = &toks[i];
+        if (t->kind == LEX_WORD) {
+            p->argv[pos++] = lex_word(buf, t);
+            continue;
         }
+
         /* handle redirection tokens */
-        if (strcmp(token, "<") == 0) {
-            token = strtok_r(NULL, TOK_DELIM, &saveptr);
-            p->infile = strdup(token);
-        } else if (strcmp(token, ">") == 0) {
-            token = strtok_r(NULL, TOK_DELIM, &saveptr);
-            p->outfile = strdup(token);
-        } else {
-            p->argv[pos++] = strdup(token);
+        if ((t->kind == LEX_IN || t->kind == LEX_OUT) && i + 1 < ntok && toks[i + 1].kind == LEX_WORD) {
+            char *path = lex_word(buf, &toks[++i]);
+            if (t->kind == LEX_IN)
+                p->infile = path;
+            else
+                p->outfile = path;
+            continue;
         }
+
+        pprintf(STDERR_FILENO, "syntax error near '%c'\n", buf[t->off]);
+        return NULL;
     }
     p->argc = pos;
     p->argv[pos] = NULL;
 
     /* determine built-in or external */
-    p->type = (p->argc > 0 ? get_cmd_id(p->argv[0]) : CMD_EXTERNAL);
+    p->builtin = (p->argc > 0 ? find_builtin(p->argv[0]) : NULL);
+    if (!p->builtin && p->argc > 0)
+        p->builtin = fastpath_find(p);
+    p->type = (p->builtin ? p->builtin->id : CMD_EXTERNAL);
     return p;
 }
 
-/* Parse input line into a job (possibly pipeline) */
-struct job *parse_line(char *line)
+/* Parse a single command segment into a process struct */
+struct process *parse_segment(struct arena *a, char *seg)
 {
+    struct token *toks;
+    int ntok = lex_line(a, seg, &toks);
+    if (ntok < 0)
+        return NULL;
+    return build_process(a, seg, toks, ntok);
+}
+
+/* Helper: parse_line() without the metrics */
+static struct job *parse_job(char *line)
+{
+    size_t line_len = strlen(line);
+    struct arena *a = arena_create(ARENA_BLOCK_SIZE + 4 * line_len);
+    struct job *j = arena_calloc(a, sizeof(*j));
+    j->arena = a;
+    j->mode = FG_EXEC;
+
     /* Process replay substitution first */
-    char *processed_line = process_replay(line);
+    TRACE_BEGIN(t_replay);
+    j->full_cmd = process_replay(a, line); /* use processed line for full command */
+    TRACE_END(t_replay, "replay", NULL);
 
     /* Add the processed command to history */
-    add_history(processed_line);
-
-    /* make a copy for processing */
-    char *line_copy = strdup(processed_line);
+    TRACE_BEGIN(t_history);
+    add_history(j->full_cmd);
+    TRACE_END(t_history, "history", NULL);
+
+    /* a line parsed before comes back as a copy of its template */
+    TRACE_BEGIN(t_cache);
+    int hit = parsecache_lookup(j);
+    TRACE_END(t_cache, "parsecache", hit ? "hit" : "miss");
+    if (hit)
+        return j;
+
+    /* one pass over a working copy; words end up as strings inside it */
+    TRACE_BEGIN(t_lex);
+    char *buf = arena_strdup(a, j->full_cmd);
+    struct token *toks;
+    int ntok = lex_line(a, buf, &toks);
+    TRACE_END(t_lex, "lex", NULL);
+    if (ntok < 0)
+        return j;
 
     /* detect background '&' */
-    int mode = FG_EXEC;
-    size_t len = strlen(line_copy);
-    if (len > 0 && line_copy[len - 1] == '&') {
-        mode = BG_EXEC;
-        line_copy[--len] = '\0';
-        /* trim any trailing spaces before & */
-        while (len > 0 && line_copy[len - 1] == ' ') {
-            line_copy[--len] = '\0';
-        }
+    if (ntok > 0 && toks[ntok - 1].kind == LEX_BG) {
+        j->mode = BG_EXEC;
+        ntok--;
+    }
+
+    /* `time` prefix: run the rest and report its resource usage */
+    if (ntok > 1 && toks[0].kind == LEX_WORD && !(toks[0].flags & LEXF_QUOTED) && toks[0].len == 4 &&
+        memcmp(buf + toks[0].off, "time", 4) == 0) {
+        j->timed = 1;
+        toks++;
+        ntok--;
     }
 
     /* split by '|' for pipeline */
-    char *seg, *saveptr;
-    struct job *j = calloc(1, sizeof(*j));
-    j->mode = mode;
-    j->full_cmd = strdup(processed_line); /* use processed line for full command */
-
-    int first = 1;
-    for (seg = strtok_r(line_copy, "|", &saveptr); seg; seg = strtok_r(NULL, "|", &saveptr)) {
-        /* trim leading spaces */
-        while (*seg == ' ')
-            seg++;
-        struct process *p = parse_segment(seg);
-        if (first)
-            j->first = p;
-        else {
-            /* attach to pipeline */
-            struct process *prev = j->first;
-            while (prev->next)
-                prev = prev->next;
-            prev->next = p;
+    struct process **tail = &j->first;
+    int start = 0;
+    for (int i = 0; i <= ntok; i++) {
+        if (i < ntok && toks[i].kind != LEX_PIPE)
+            continue;
+        if (i == start && (i < ntok || start > 0)) {
+            pprintf(STDERR_FILENO, "syntax error near '|'\n");
+            j->first = NULL;
+            return j;
         }
-        first = 0;
+        /* attach to pipeline */
+        *tail = build_process(a, buf, toks + start, i - start);
+        if (!*tail) {
+            j->first = NULL;
+            return j;
+        }
+        tail = &(*tail)->next;
+        start = i + 1;
     }
 
-    free(line_copy);
-    free(processed_line);
+    parsecache_insert(j);
+    return j;
+}
+
+/* Parse input line into a job (possibly pipeline); the job, its processes,
+ * argv arrays and token strings all live in one arena. On a syntax error the
+ * job comes back with no processes. */
+struct job *parse_line(char *line)
+{
+    long long start = acct_now();
+    struct job *j = parse_job(line);
+    stats_time(HIST_PARSE, acct_now() - start);
+    stats_add(STAT_LINES);
+    if (!j->first)
+        stats_add(STAT_PARSE_ERRORS);
     return j;
-}
\ No newline at end of file
+}
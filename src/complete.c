@@ -0,0 +1,525 @@
+/*
+ * complete.c - Tab completion: command trie over PATH, builtins and file names
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/builtin.h"
+#include "../include/complete.h"
+#include "../include/shell.h"
+
+/* Directory changes that can add, remove or re-mode an executable */
+#define DIR_EVENTS                                                                                        \
+    (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE_SELF | \
+     IN_MOVE_SELF | IN_ONLYDIR)
+
+/* One character of a command name */
+struct trie_node {
+    int child;           // first child, children sorted by c; -1 if none
+    int sibling;         // next child of the same parent; -1 if last
+    unsigned int words;  // names ending at or below this node
+    uint64_t dirs;       // bit i: PATH directory i holds the name ending here
+    unsigned char c;
+};
+
+/* PATH executables indexed by name */
+static struct {
+    struct trie_node *nodes;  // [0] is the root
+    int nnodes;
+    int cap;
+    char *path_env;                             // PATH the trie was built from
+    char *dirs[COMPLETE_MAX_DIRS];              // absolute PATH entries, in order
+    int wds[COMPLETE_MAX_DIRS];                 // inotify watch, -1 if none, -2 for a repeat
+    struct timespec mtimes[COMPLETE_MAX_DIRS];  // checked instead when there is no watch
+    int ndirs;
+    int inotify_fd;
+} trie = {.inotify_fd = -1};
+
+/* Candidates for one word */
+struct names {
+    char lcp[PATH_LEN];  // longest common prefix of every candidate
+    size_t lcp_len;
+    int total;           // candidates seen
+    int limit;           // names kept in v, 0 when only the prefix matters
+    int n;
+    char **v;
+};
+
+/* The word being completed */
+struct word {
+    char text[PATH_LEN];  // up to the cursor, quotes and backslashes removed
+    char quote;           // quote still open at the cursor, or 0
+    int cmd;              // first word of a pipeline stage
+};
+
+/* Trie ---------------------------------------------------------------------- */
+
+static int node_new(unsigned char c)
+{
+    if (trie.nnodes == trie.cap) {
+        int cap = trie.cap ? trie.cap * 2 : 1024;
+        struct trie_node *nodes = realloc(trie.nodes, cap * sizeof(*nodes));
+        if (!nodes)
+            return -1;
+        trie.nodes = nodes;
+        trie.cap = cap;
+    }
+    trie.nodes[trie.nnodes] = (struct trie_node){.child = -1, .sibling = -1, .c = c};
+    return trie.nnodes++;
+}
+
+/* Helper: child of node n for c, inserted in order if create is set; -1 if absent */
+static int trie_child(int n, unsigned char c, int create)
+{
+    int prev = -1, k = trie.nodes[n].child;
+    while (k >= 0 && trie.nodes[k].c < c) {
+        prev = k;
+        k = trie.nodes[k].sibling;
+    }
+    if (k >= 0 && trie.nodes[k].c == c)
+        return k;
+    if (!create)
+        return -1;
+
+    int m = node_new(c);
+    if (m < 0)
+        return -1;
+    trie.nodes[m].sibling = k;
+    if (prev >= 0)
+        trie.nodes[prev].sibling = m;
+    else
+        trie.nodes[n].child = m;
+    return m;
+}
+
+/* Helper: node reached by prefix, -1 if no name starts with it */
+static int trie_find(const char *prefix)
+{
+    int n = 0;
+    for (const unsigned char *s = (const unsigned char *) prefix; *s && n >= 0; s++)
+        n = trie_child(n, *s, 0);
+    return n;
+}
+
+/* Helper: record whether PATH directory dir holds executable name */
+static void trie_update(const char *name, int dir, int present)
+{
+    int path[NAME_MAX + 1];
+    int depth = 0, n = 0;
+
+    path[depth++] = 0;
+    for (const unsigned char *s = (const unsigned char *) name; *s; s++) {
+        if (depth > NAME_MAX || (n = trie_child(n, *s, present)) < 0)
+            return;
+        path[depth++] = n;
+    }
+
+    uint64_t old = trie.nodes[n].dirs, bit = 1ull << dir;
+    trie.nodes[n].dirs = present ? old | bit : old & ~bit;
+    int delta = (trie.nodes[n].dirs != 0) - (old != 0);
+    for (int i = 0; delta && i < depth; i++)
+        trie.nodes[path[i]].words += delta;
+}
+
+/* Helper: a regular file with an execute bit */
+static int is_exec_at(int dir_fd, const char *name)
+{
+    struct stat st;
+    return fstatat(dir_fd, name, &st, 0) == 0 && S_ISREG(st.st_mode) && (st.st_mode & 0111);
+}
+
+static void scan_dir(int i)
+{
+    DIR *d = opendir(trie.dirs[i]);
+    if (!d)
+        return;
+    struct dirent *e;
+    while ((e = readdir(d))) {
+        if (e->d_type != DT_DIR && is_exec_at(dirfd(d), e->d_name))
+            trie_update(e->d_name, i, 1);
+    }
+    closedir(d);
+}
+
+/* Helper: index every executable in path_env, watching each directory first so
+ * no change between the scan and the first event is lost */
+static void trie_build(const char *path_env)
+{
+    if (trie.inotify_fd >= 0)
+        close(trie.inotify_fd);
+    for (int i = 0; i < trie.ndirs; i++)
+        free(trie.dirs[i]);
+    trie.ndirs = 0;
+    trie.nnodes = 0;
+    free(trie.path_env);
+    trie.path_env = strdup(path_env);
+    if (node_new(0) < 0)
+        return;
+    trie.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    for (const char *dir = path_env; *dir && trie.ndirs < COMPLETE_MAX_DIRS;) {
+        const char *end = strchrnul(dir, ':');
+        /* relative entries (and the empty one, the current directory) move
+         * with cd; file-name completion covers them */
+        if (*dir == '/') {
+            int i = trie.ndirs++;
+            trie.dirs[i] = strndup(dir, end - dir);
+            trie.wds[i] = trie.inotify_fd >= 0 ? inotify_add_watch(trie.inotify_fd, trie.dirs[i], DIR_EVENTS) : -1;
+            /* the same directory twice (/bin linked to /usr/bin) is indexed once */
+            for (int j = 0; j < i && trie.wds[i] >= 0; j++) {
+                if (trie.wds[j] == trie.wds[i])
+                    trie.wds[i] = -2;
+            }
+            struct stat st;
+            trie.mtimes[i] = stat(trie.dirs[i], &st) == 0 ? st.st_mtim : (struct timespec){0};
+            if (trie.wds[i] != -2)
+                scan_dir(i);
+        }
+        dir = *end ? end + 1 : end;
+    }
+}
+
+/* Helper: apply queued inotify events; -1 when the trie has to be rebuilt */
+static int trie_poll(void)
+{
+    /* directories without a watch are compared by mtime */
+    for (int i = 0; i < trie.ndirs; i++) {
+        struct stat st;
+        if (trie.wds[i] != -1)
+            continue;
+        struct timespec m = stat(trie.dirs[i], &st) == 0 ? st.st_mtim : (struct timespec){0};
+        if (m.tv_sec != trie.mtimes[i].tv_sec || m.tv_nsec != trie.mtimes[i].tv_nsec)
+            return -1;
+    }
+    if (trie.inotify_fd < 0)
+        return 0;
+
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while ((n = read(trie.inotify_fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + n;) {
+            const struct inotify_event *ev = (const struct inotify_event *) p;
+            p += sizeof(*ev) + ev->len;
+            if (ev->mask & (IN_Q_OVERFLOW | IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+                return -1;
+
+            int i = 0;
+            while (i < trie.ndirs && trie.wds[i] != ev->wd)
+                i++;
+            if (i == trie.ndirs || ev->len == 0)
+                continue;
+            int present = 0;
+            if (!(ev->mask & (IN_DELETE | IN_MOVED_FROM))) {
+                char path[PATH_LEN];
+                snprintf(path, sizeof(path), "%s/%s", trie.dirs[i], ev->name);
+                present = is_exec_at(AT_FDCWD, path);
+            }
+            trie_update(ev->name, i, present);
+        }
+    }
+    return 0;
+}
+
+/* Helper: bring the trie up to date with PATH and its directories */
+static void trie_refresh(void)
+{
+    const char *env = getenv("PATH");
+    if (!env)
+        env = "";
+    if (!trie.nnodes || strcmp(trie.path_env, env) != 0 || trie_poll() < 0)
+        trie_build(env);
+}
+
+/* Candidates ----------------------------------------------------------------- */
+
+/* Helper: count candidates sharing s[0..len) */
+static void names_fold(struct names *l, const char *s, size_t len, int count)
+{
+    if (!l->total) {
+        l->lcp_len = len < sizeof(l->lcp) ? len : sizeof(l->lcp) - 1;
+        memcpy(l->lcp, s, l->lcp_len);
+    } else {
+        size_t k = 0;
+        while (k < l->lcp_len && k < len && l->lcp[k] == s[k])
+            k++;
+        l->lcp_len = k;
+    }
+    l->total += count;
+}
+
+/* Helper: keep a copy of a candidate for listing */
+static void names_keep(struct names *l, const char *s, size_t len)
+{
+    if (l->n < l->limit)
+        l->v[l->n++] = strndup(s, len);
+}
+
+/* Helper: one candidate, directories with a trailing '/' */
+static void names_add(struct names *l, const char *s, int dir)
+{
+    char name[PATH_LEN];
+    int len = snprintf(name, sizeof(name), "%s%s", s, dir ? "/" : "");
+    if (len >= (int) sizeof(name))
+        return;
+    names_fold(l, name, len, 1);
+    names_keep(l, name, len);
+}
+
+/* Helper: keep the names at or below node, in order; name[0..len) spells node */
+static void trie_collect(int node, char *name, size_t len, struct names *l)
+{
+    if (trie.nodes[node].dirs)
+        names_keep(l, name, len);
+    for (int k = trie.nodes[node].child; k >= 0 && l->n < l->limit; k = trie.nodes[k].sibling) {
+        if (trie.nodes[k].words) {
+            name[len] = trie.nodes[k].c;
+            trie_collect(k, name, len + 1, l);
+        }
+    }
+}
+
+/* Helper: builtins and PATH executables starting with prefix */
+static void command_names(const char *prefix, struct names *l)
+{
+    size_t plen = strlen(prefix);
+    if (plen > NAME_MAX)
+        return;
+    trie_refresh();
+
+    int node = trie.nnodes ? trie_find(prefix) : -1;
+    if (node >= 0 && trie.nodes[node].words) {
+        char name[NAME_MAX + 1];
+        memcpy(name, prefix, plen);
+        if (l->limit)
+            trie_collect(node, name, plen, l);
+
+        /* the names share the path down from node until it forks or a name ends */
+        int words = trie.nodes[node].words;
+        size_t len = plen;
+        while (!trie.nodes[node].dirs) {
+            int only = -1;
+            for (int k = trie.nodes[node].child; k >= 0; k = trie.nodes[k].sibling) {
+                if (!trie.nodes[k].words)
+                    continue;
+                if (only >= 0) {
+                    only = -1;
+                    break;
+                }
+                only = k;
+            }
+            if (only < 0)
+                break;
+            name[len++] = trie.nodes[only].c;
+            node = only;
+        }
+        names_fold(l, name, len, words);
+    }
+
+    const struct builtin_cmd *b;
+    for (int i = 0; (b = i < num_builtins ? &builtins[i] : loaded_builtin(i - num_builtins)); i++) {
+        if (strncmp(b->name, prefix, plen) != 0)
+            continue;
+        int t = trie.nnodes ? trie_find(b->name) : -1;
+        if (t < 0 || !trie.nodes[t].dirs) /* echo is both: count it once */
+            names_add(l, b->name, 0);
+    }
+}
+
+/* Helper: entries of the directory part of word that start with its last
+ * component; in command position only directories and executables */
+static void file_names(const char *word, int cmd, struct names *l)
+{
+    const char *slash = strrchr(word, '/');
+    const char *base = slash ? slash + 1 : word;
+    char dir[PATH_LEN];
+    int len;
+    if (!slash)
+        len = snprintf(dir, sizeof(dir), ".");
+    else if (slash == word)
+        len = snprintf(dir, sizeof(dir), "/");
+    else if (word[0] == '~' && word[1] == '/')
+        len = snprintf(dir, sizeof(dir), "%s%.*s", shell.home_dir, (int) (slash - word - 1), word + 1);
+    else
+        len = snprintf(dir, sizeof(dir), "%.*s", (int) (slash - word), word);
+    if (len >= (int) sizeof(dir))
+        return;
+
+    DIR *d = opendir(dir);
+    if (!d)
+        return;
+    size_t blen = strlen(base);
+    struct dirent *e;
+    while ((e = readdir(d))) {
+        const char *name = e->d_name;
+        if (strncmp(name, base, blen) != 0 || strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+            continue;
+        if (name[0] == '.' && base[0] != '.')
+            continue; /* hidden unless asked for */
+
+        int is_dir = e->d_type == DT_DIR, exec = 0;
+        if (e->d_type == DT_UNKNOWN || e->d_type == DT_LNK || (cmd && !is_dir)) {
+            struct stat st;
+            if (fstatat(dirfd(d), name, &st, 0) == 0) {
+                is_dir = S_ISDIR(st.st_mode);
+                exec = S_ISREG(st.st_mode) && (st.st_mode & 0111);
+            }
+        }
+        if (!cmd || is_dir || exec)
+            names_add(l, name, is_dir);
+    }
+    closedir(d);
+}
+
+/* Helper: find the word ending at pos and whether it names a command */
+static void current_word(const char *buf, int pos, struct word *w)
+{
+    size_t len = 0;
+    int cmd = 1, redirect = 0;
+
+    w->quote = 0;
+    for (int i = 0; i < pos; i++) {
+        char c = buf[i];
+        if (w->quote) {
+            if (c == w->quote)
+                w->quote = 0;
+            else if (len < sizeof(w->text) - 1)
+                w->text[len++] = c;
+            continue;
+        }
+        if (c == '\'' || c == '"') {
+            w->quote = c;
+            continue;
+        }
+        if (c == '\\' && i + 1 < pos) {
+            c = buf[++i];
+        } else if (c == ' ' || c == '\t' || c == '|' || c == '&' || c == '<' || c == '>') {
+            if (len) {
+                w->text[len] = '\0';
+                /* @-prefixes and `time` leave the next word in command position */
+                if (redirect)
+                    redirect = 0;
+                else if (w->text[0] != STAGE_PREFIX && strcmp(w->text, "time") != 0)
+                    cmd = 0;
+                len = 0;
+            }
+            if (c == '|' || c == '&')
+                cmd = 1;
+            else if (c == '<' || c == '>')
+                redirect = 1;
+            continue;
+        }
+        if (len < sizeof(w->text) - 1)
+            w->text[len++] = c;
+    }
+    w->text[len] = '\0';
+    w->cmd = cmd && !redirect;
+}
+
+/* Helper: candidates for w; returns how much of w->text they all extend */
+static size_t candidates(const struct word *w, struct names *l)
+{
+    const char *slash = strrchr(w->text, '/');
+    if (w->cmd && !slash) {
+        command_names(w->text, l);
+        return strlen(w->text);
+    }
+    file_names(w->text, w->cmd, l);
+    return strlen(slash ? slash + 1 : w->text);
+}
+
+int complete_word(const char *buf, int pos, char **insert)
+{
+    struct word w;
+    struct names l = {.limit = 0};
+    current_word(buf, pos, &w);
+    size_t typed = candidates(&w, &l);
+
+    const char *ext = l.lcp + typed;
+    size_t ext_len = l.total && l.lcp_len > typed ? l.lcp_len - typed : 0;
+    char *out = malloc(2 * ext_len + 3);
+    if (!out) {
+        *insert = NULL;
+        return 0;
+    }
+
+    /* outside quotes, characters the lexer would split on get a backslash */
+    size_t len = 0;
+    for (size_t i = 0; i < ext_len; i++) {
+        if (!w.quote && strchr(" \t\\'\"|&<>", ext[i]))
+            out[len++] = '\\';
+        out[len++] = ext[i];
+    }
+    /* a single candidate is finished, unless it is a directory to go into */
+    if (l.total == 1 && !(l.lcp_len && l.lcp[l.lcp_len - 1] == '/')) {
+        if (w.quote)
+            out[len++] = w.quote;
+        out[len++] = ' ';
+    }
+    out[len] = '\0';
+    *insert = out;
+    return l.total;
+}
+
+static int cmp_str(const void *a, const void *b)
+{
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+void complete_list(const char *buf, int pos, int cols, int out_fd)
+{
+    struct word w;
+    struct names l = {.limit = COMPLETE_LIST_MAX};
+    l.v = malloc(COMPLETE_LIST_MAX * sizeof(char *));
+    if (!l.v)
+        return;
+    current_word(buf, pos, &w);
+    candidates(&w, &l);
+    qsort(l.v, l.n, sizeof(char *), cmp_str);
+
+    /* sorted down the columns, like ls */
+    size_t width = 0;
+    for (int i = 0; i < l.n; i++) {
+        size_t len = strlen(l.v[i]);
+        width = len > width ? len : width;
+    }
+    width += 2;
+    int per_row = cols > (int) width ? cols / (int) width : 1;
+    int rows = (l.n + per_row - 1) / per_row;
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < per_row; c++) {
+            int i = c * rows + r;
+            if (i >= l.n)
+                break;
+            int last = c == per_row - 1 || i + rows >= l.n;
+            pprintf(out_fd, "%-*s", last ? 0 : (int) width, l.v[i]);
+        }
+        pprintf(out_fd, "\n");
+    }
+    if (l.total > l.n)
+        pprintf(out_fd, "... and %d more\n", l.total - l.n);
+
+    for (int i = 0; i < l.n; i++)
+        free(l.v[i]);
+    free(l.v);
+}
+
+#ifdef SHELL_BENCH
+int complete_command(const char *prefix, char *ext, size_t n)
+{
+    struct names l = {.limit = 0};
+    command_names(prefix, &l);
+    size_t plen = strlen(prefix);
+    snprintf(ext, n, "%.*s", l.total ? (int) (l.lcp_len - plen) : 0, l.total ? l.lcp + plen : "");
+    return l.total;
+}
+#endif
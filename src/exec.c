@@ -0,0 +1,664 @@
+/*
+ * exec.c - External command launch engines
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/builtin.h"
+#include "../include/command.h"
+#include "../include/exec.h"
+#include "../include/shell.h"
+#include "../include/stats.h"
+
+extern char **environ;
+
+/* Signals ignored or caught by the shell that every child gets back as SIG_DFL */
+static const int child_signals[] = {SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGCHLD};
+#define NUM_CHILD_SIGNALS (int) (sizeof(child_signals) / sizeof(*child_signals))
+
+/* Cached PATH resolution of one command name */
+struct path_entry {
+    char *name;               // command name as typed
+    char *path;               // resolved absolute path
+    unsigned long hits;       // launches served from this entry
+    struct path_entry *next;  // bucket chain
+};
+
+/* Shell-wide executable path cache */
+static struct {
+    struct path_entry *buckets[PATH_CACHE_BUCKETS];
+    char *path_env;  // PATH value the entries were resolved against
+    char *uncached;  // last resolution through a relative PATH element
+    unsigned long hits;
+    unsigned long misses;
+} path_cache;
+
+/* Helper: FNV-1a hash of a command name */
+static unsigned int path_hash(const char *name)
+{
+    unsigned int h = 2166136261u;
+    while (*name) {
+        h ^= (unsigned char) *name++;
+        h *= 16777619u;
+    }
+    return h % PATH_CACHE_BUCKETS;
+}
+
+/* Drop every cached entry */
+void path_cache_clear(void)
+{
+    for (int i = 0; i < PATH_CACHE_BUCKETS; i++) {
+        struct path_entry *e = path_cache.buckets[i];
+        while (e) {
+            struct path_entry *next = e->next;
+            free(e->name);
+            free(e->path);
+            free(e);
+            e = next;
+        }
+        path_cache.buckets[i] = NULL;
+    }
+}
+
+/* Helper: entries are only valid for the PATH they were resolved against */
+static void path_cache_check_env(void)
+{
+    const char *env = getenv("PATH");
+    if (!env)
+        env = "";
+    if (path_cache.path_env && strcmp(path_cache.path_env, env) == 0)
+        return;
+    path_cache_clear();
+    free(path_cache.path_env);
+    path_cache.path_env = strdup(env);
+}
+
+static struct path_entry **path_cache_find(const char *name)
+{
+    struct path_entry **e = &path_cache.buckets[path_hash(name)];
+    while (*e && strcmp((*e)->name, name) != 0)
+        e = &(*e)->next;
+    return e;
+}
+
+/* Remember name -> path, replacing an older entry; returns 0 or -1 */
+int path_cache_insert(const char *name, const char *path)
+{
+    path_cache_check_env();
+    struct path_entry **slot = path_cache_find(name);
+    struct path_entry *e = *slot;
+    if (!e) {
+        e = calloc(1, sizeof(*e));
+        if (!e)
+            return -1;
+        e->name = strdup(name);
+        *slot = e;
+    } else {
+        free(e->path);
+        e->hits = 0;
+    }
+    e->path = strdup(path);
+    return 0;
+}
+
+/* Forget a single name, e.g. after its cached binary vanished */
+void path_cache_forget(const char *name)
+{
+    struct path_entry **slot = path_cache_find(name);
+    struct path_entry *e = *slot;
+    if (!e)
+        return;
+    *slot = e->next;
+    free(e->name);
+    free(e->path);
+    free(e);
+}
+
+/* Helper: walk PATH once, like execvp would, and return a malloc'd path;
+ * *absolute tells whether it came from an absolute PATH element */
+static char *path_search(const char *name, int *absolute)
+{
+    const char *dir = path_cache.path_env;
+    size_t name_len = strlen(name);
+    char buf[PATH_LEN];
+    struct stat st;
+
+    while (*dir) {
+        const char *end = strchrnul(dir, ':');
+        size_t dir_len = end - dir;
+        if (dir_len == 0) {
+            /* empty PATH element means the current directory */
+            dir = ".";
+            dir_len = 1;
+        }
+        if (dir_len + name_len + 2 <= sizeof(buf)) {
+            memcpy(buf, dir, dir_len);
+            buf[dir_len] = '/';
+            memcpy(buf + dir_len + 1, name, name_len + 1);
+            if (stat(buf, &st) == 0 && S_ISREG(st.st_mode) && access(buf, X_OK) == 0) {
+                *absolute = buf[0] == '/';
+                return strdup(buf);
+            }
+        }
+        if (*end == '\0')
+            break;
+        dir = end + 1;
+    }
+    return NULL;
+}
+
+/* Resolve a command name to an executable path, consulting the cache first.
+ * Names containing '/' are returned as-is; NULL with errno = ENOENT if not found.
+ * A path found through a relative PATH element is not cached and stays valid
+ * until the next call. */
+const char *path_cache_lookup(const char *name)
+{
+    if (strchr(name, '/'))
+        return name;
+
+    path_cache_check_env();
+    struct path_entry *e = *path_cache_find(name);
+    if (e) {
+        path_cache.hits++;
+        e->hits++;
+        return e->path;
+    }
+
+    path_cache.misses++;
+    int absolute = 0;
+    char *path = path_search(name, &absolute);
+    if (path && !absolute) {
+        /* found through an empty or relative PATH element: that depends on
+         * the working directory, so resolve it again on the next launch */
+        free(path_cache.uncached);
+        path_cache.uncached = path;
+        return path;
+    }
+    if (!path || path_cache_insert(name, path) < 0) {
+        free(path);
+        errno = ENOENT;
+        return NULL;
+    }
+    free(path);
+    e = *path_cache_find(name);
+    e->hits++;
+    return e->path;
+}
+
+/* List cached entries and hit/miss counters */
+void path_cache_print(int out_fd)
+{
+    int empty = 1;
+    for (int i = 0; i < PATH_CACHE_BUCKETS; i++) {
+        for (struct path_entry *e = path_cache.buckets[i]; e; e = e->next) {
+            if (empty)
+                pprintf(out_fd, "hits\tcommand\n");
+            empty = 0;
+            pprintf(out_fd, "%4lu\t%s\n", e->hits, e->path);
+        }
+    }
+    if (empty)
+        pprintf(out_fd, "hash: hash table empty\n");
+    pprintf(out_fd, "hash: %lu hits, %lu misses\n", path_cache.hits, path_cache.misses);
+}
+
+static const char *const spawn_mode_names[] = {
+    [SPAWN_POSIX] = "posix",
+    [SPAWN_FORK] = "fork",
+    [SPAWN_ZYGOTE] = "zygote",
+};
+
+/* Pick the launch engine: build default unless MY_SHELL_SPAWN says otherwise */
+int spawn_mode_from_env(void)
+{
+    const char *env = getenv(SPAWN_ENV);
+    if (!env)
+        return DEFAULT_SPAWN_MODE;
+    for (int mode = 0; mode < (int) (sizeof(spawn_mode_names) / sizeof(*spawn_mode_names)); mode++) {
+        if (strcmp(env, spawn_mode_names[mode]) == 0)
+            return mode;
+    }
+    pprintf(STDERR_FILENO, "%s: unknown engine '%s', using %s\n", SPAWN_ENV, env,
+            spawn_mode_name(DEFAULT_SPAWN_MODE));
+    return DEFAULT_SPAWN_MODE;
+}
+
+const char *spawn_mode_name(int mode)
+{
+    return spawn_mode_names[mode];
+}
+
+/* posix_spawn engine: signal reset, pgid join and redirections are expressed as
+ * spawn attributes and file actions, so the parent never copies its page tables */
+static pid_t spawn_posix(struct job *j, struct process *p, const char *path, int in_fd, int out_fd)
+{
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_t actions;
+    sigset_t defaults;
+    pid_t pid;
+
+    sigemptyset(&defaults);
+    for (int i = 0; i < NUM_CHILD_SIGNALS; i++)
+        sigaddset(&defaults, child_signals[i]);
+
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setpgroup(&attr, j->pgid);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETPGROUP);
+
+    posix_spawn_file_actions_init(&actions);
+    if (in_fd != STDIN_FILENO) {
+        posix_spawn_file_actions_adddup2(&actions, in_fd, STDIN_FILENO);
+        posix_spawn_file_actions_addclose(&actions, in_fd);
+    }
+    if (out_fd != STDOUT_FILENO) {
+        posix_spawn_file_actions_adddup2(&actions, out_fd, STDOUT_FILENO);
+        posix_spawn_file_actions_addclose(&actions, out_fd);
+    }
+
+    int err = posix_spawn(&pid, path, &actions, &attr, p->argv, environ);
+    if (err == ENOENT && path != p->argv[0]) {
+        /* cached binary went away: re-resolve once */
+        path_cache_forget(p->argv[0]);
+        path = path_cache_lookup(p->argv[0]);
+        err = path ? posix_spawn(&pid, path, &actions, &attr, p->argv, environ) : ENOENT;
+    }
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0) {
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+/* Helper: what every forked child does first, before exec or a builtin */
+static void child_setup(struct job *j, struct process *p)
+{
+    for (int i = 0; i < NUM_CHILD_SIGNALS; i++)
+        signal(child_signals[i], SIG_DFL);
+    setpgid(0, j->pgid);
+    if (p->sched.flags)
+        stage_sched_apply(&p->sched);
+}
+
+/* Helper: read the status pipe of a child that is about to exec: its errno
+ * if the exec failed, 0 once it succeeded and the pipe closed */
+static int exec_status(int fd)
+{
+    int e;
+    ssize_t n;
+    while ((n = read(fd, &e, sizeof(e))) < 0 && errno == EINTR)
+        ;
+    return n == sizeof(e) ? e : 0;
+}
+
+/* Helper: fork a child that execs path. A failed exec writes its errno to a
+ * close-on-exec pipe, so reading it tells the parent how the exec went:
+ * *err is 0 once it succeeded, the child's errno otherwise. */
+static pid_t fork_exec(struct job *j, struct process *p, const char *path, int in_fd, int out_fd, int *err)
+{
+    int status[2];
+    *err = 0;
+    if (pipe2(status, O_CLOEXEC) < 0)
+        return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(status[0]);
+        child_setup(j, p);
+        if (in_fd != STDIN_FILENO) {
+            dup2(in_fd, STDIN_FILENO);
+            close(in_fd);
+        }
+        if (out_fd != STDOUT_FILENO) {
+            dup2(out_fd, STDOUT_FILENO);
+            close(out_fd);
+        }
+        execve(path, p->argv, environ);
+        int e = errno;
+        (void) !write(status[1], &e, sizeof(e));
+        _exit(EXIT_FAILURE);
+    }
+
+    int saved = errno;
+    close(status[1]);
+    if (pid > 0)
+        *err = exec_status(status[0]);
+    close(status[0]);
+    errno = saved;
+    return pid;
+}
+
+/* fork engine: child resets signals and I/O itself before exec */
+static pid_t spawn_fork(struct job *j, struct process *p, const char *path, int in_fd, int out_fd)
+{
+    int err;
+    pid_t pid = fork_exec(j, p, path, in_fd, out_fd, &err);
+    if (pid > 0 && err == ENOENT && path != p->argv[0]) {
+        /* cached binary went away: drop the entry and re-resolve once */
+        waitpid(pid, NULL, 0);
+        path_cache_forget(p->argv[0]);
+        path = path_cache_lookup(p->argv[0]);
+        pid = path ? fork_exec(j, p, path, in_fd, out_fd, &err) : -1;
+    }
+    if (pid > 0 && err) {
+        /* the exec failed: reap the child and report it like a failed posix_spawn */
+        waitpid(pid, NULL, 0);
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+/* Zygote engine ----------------------------------------------------------- */
+
+/* Request to the fork server: this header, then the path and argc argv strings,
+ * each NUL-terminated, in one datagram. The child's stdin, stdout, stderr and
+ * working directory travel alongside as SCM_RIGHTS descriptors. */
+struct zygote_req {
+    pid_t pgid;                // process group to join, 0 to lead a new one
+    int argc;                  // argv strings after the path
+    struct stage_sched sched;  // stage prefixes, cpus pointing at cpus below
+    cpu_set_t cpus;            // affinity mask when sched asks for one
+};
+
+struct zygote_reply {
+    pid_t pid;     // child pid, -1 if clone failed
+    int err;       // errno of the failed clone
+    int exec_err;  // errno of the child's failed execve(), 0 once it ran
+};
+
+/* Descriptors passed with every request, in this order */
+enum { ZFD_STDIN, ZFD_STDOUT, ZFD_STDERR, ZFD_CWD, ZYGOTE_NFDS };
+
+/* Shell side of the fork server */
+static struct {
+    int sock;  // SOCK_SEQPACKET to the server, -1 when not running
+    pid_t pid; // server pid
+} zygote = {-1, 0};
+
+/* Helper: clone(CLONE_PARENT): the child is the shell's, not the server's, so
+ * SIGCHLD, wait4() and pidfds in the shell work as for any other launch */
+static pid_t clone_parent(void)
+{
+    return syscall(SYS_clone, CLONE_PARENT | SIGCHLD, 0, 0, 0, 0);
+}
+
+/* Helper: child half of a server launch. A failed exec is not printed here:
+ * its errno goes back to the server on the close-on-exec status_fd, and the
+ * shell reports it like any other failed launch. */
+static void zygote_child(const struct zygote_req *req, const char *path, char **argv, const int *fds, int status_fd)
+{
+    for (int i = 0; i < NUM_CHILD_SIGNALS; i++)
+        signal(child_signals[i], SIG_DFL);
+    setpgid(0, req->pgid);
+    if (req->sched.flags) {
+        struct stage_sched sched = req->sched;
+        sched.cpus = (cpu_set_t *) &req->cpus;
+        stage_sched_apply(&sched);
+    }
+
+    /* descriptors arrived above 2, so dup2 never clobbers one still needed */
+    dup2(fds[ZFD_STDIN], STDIN_FILENO);
+    dup2(fds[ZFD_STDOUT], STDOUT_FILENO);
+    dup2(fds[ZFD_STDERR], STDERR_FILENO);
+    if (fchdir(fds[ZFD_CWD]) == 0)
+        execve(path, argv, environ);
+    int e = errno;
+    (void) !write(status_fd, &e, sizeof(e));
+    _exit(EXIT_FAILURE);
+}
+
+/* Helper: the fork server's loop; exits once the shell closes its end */
+static void zygote_serve(int sock)
+{
+    char *buf = malloc(ZYGOTE_MSG_MAX);
+    char **argv = NULL;
+    int argv_cap = 0;
+    union {
+        char buf[CMSG_SPACE(ZYGOTE_NFDS * sizeof(int))];
+        struct cmsghdr align;
+    } ctl;
+
+    while (buf) {
+        struct iovec iov = {buf, ZYGOTE_MSG_MAX};
+        struct msghdr msg = {.msg_iov = &iov, .msg_iovlen = 1, .msg_control = ctl.buf,
+                             .msg_controllen = sizeof(ctl.buf)};
+        ssize_t n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        if (!cm || cm->cmsg_type != SCM_RIGHTS || cm->cmsg_len != CMSG_LEN(ZYGOTE_NFDS * sizeof(int)))
+            break; /* the shell never sends this: stop rather than guess */
+        int fds[ZYGOTE_NFDS];
+        memcpy(fds, CMSG_DATA(cm), sizeof(fds));
+
+        /* argv points into buf; every string was checked to end inside it */
+        struct zygote_req req;
+        memcpy(&req, buf, sizeof(req));
+        struct zygote_reply reply = {-1, EINVAL, 0};
+        if (req.argc >= argv_cap) {
+            argv_cap = req.argc + 1;
+            argv = realloc(argv, argv_cap * sizeof(*argv));
+        }
+        char *s = buf + sizeof(req), *end = buf + n;
+        char *path = s;
+        int argc = -1;
+        while (argv && s < end && argc < req.argc) {
+            char *nul = memchr(s, '\0', end - s);
+            if (!nul)
+                break;
+            if (argc >= 0)
+                argv[argc] = s;
+            argc++;
+            s = nul + 1;
+        }
+
+        if (argv && argc == req.argc && req.argc > 0) {
+            argv[argc] = NULL;
+            int status[2] = {-1, -1};
+            pid_t pid = -1;
+            if (pipe2(status, O_CLOEXEC) == 0 && (pid = clone_parent()) == 0) {
+                close(status[0]);
+                zygote_child(&req, path, argv, fds, status[1]);
+            }
+            reply.pid = pid;
+            reply.err = pid < 0 ? errno : 0;
+            if (status[1] >= 0)
+                close(status[1]);
+            if (pid > 0)
+                reply.exec_err = exec_status(status[0]); /* wait for the exec */
+            if (status[0] >= 0)
+                close(status[0]);
+        }
+        for (int i = 0; i < ZYGOTE_NFDS; i++)
+            close(fds[i]);
+        if (send(sock, &reply, sizeof(reply), MSG_NOSIGNAL) < 0)
+            break;
+    }
+    _exit(EXIT_SUCCESS);
+}
+
+/* Start the fork server while the shell is still small; returns 0 or -1 */
+int zygote_start(void)
+{
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) < 0)
+        return -1;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(sv[0]);
+        zygote_serve(sv[1]);
+    }
+
+    close(sv[1]);
+    zygote.sock = sv[0];
+    zygote.pid = pid;
+    return 0;
+}
+
+/* Helper: the server is gone or misbehaved; launch with posix_spawn from now on */
+static void zygote_lost(void)
+{
+    pprintf(STDERR_FILENO, "zygote: fork server lost (%s), using posix_spawn\n", strerror(errno));
+    close(zygote.sock);
+    zygote.sock = -1;
+    shell.spawn_mode = SPAWN_POSIX;
+}
+
+/* Helper: have the fork server launch p; *err is the child's exec errno as
+ * for fork_exec(), 0 when the launch fell back to posix_spawn */
+static pid_t zygote_launch(struct job *j, struct process *p, const char *path, int in_fd, int out_fd, int *err)
+{
+    *err = 0;
+    size_t len = sizeof(struct zygote_req) + strlen(path) + 1;
+    for (int i = 0; i < p->argc; i++)
+        len += strlen(p->argv[i]) + 1;
+
+    int cwd = -1;
+    if (zygote.sock < 0 || len > ZYGOTE_MSG_MAX ||
+        (cwd = open(".", O_PATH | O_DIRECTORY | O_CLOEXEC)) < 0)
+        return spawn_posix(j, p, path, in_fd, out_fd); /* too long for one datagram, or no cwd to pass */
+
+    char *buf = malloc(len);
+    if (!buf) {
+        close(cwd);
+        return spawn_posix(j, p, path, in_fd, out_fd);
+    }
+    struct zygote_req req;
+    memset(&req, 0, sizeof(req));
+    req.pgid = j->pgid;
+    req.argc = p->argc;
+    req.sched = p->sched;
+    req.sched.cpus = NULL;
+    if (p->sched.cpus)
+        req.cpus = *p->sched.cpus;
+    memcpy(buf, &req, sizeof(req));
+    char *s = stpcpy(buf + sizeof(req), path) + 1;
+    for (int i = 0; i < p->argc; i++)
+        s = stpcpy(s, p->argv[i]) + 1;
+
+    union {
+        char buf[CMSG_SPACE(ZYGOTE_NFDS * sizeof(int))];
+        struct cmsghdr align;
+    } ctl;
+    memset(&ctl, 0, sizeof(ctl));
+    struct iovec iov = {buf, len};
+    struct msghdr msg = {.msg_iov = &iov, .msg_iovlen = 1, .msg_control = ctl.buf,
+                         .msg_controllen = sizeof(ctl.buf)};
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(ZYGOTE_NFDS * sizeof(int));
+    int fds[ZYGOTE_NFDS] = {in_fd, out_fd, STDERR_FILENO, cwd};
+    memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+
+    struct zygote_reply reply;
+    ssize_t n = sendmsg(zygote.sock, &msg, MSG_NOSIGNAL);
+    if (n == (ssize_t) len)
+        n = recv(zygote.sock, &reply, sizeof(reply), 0);
+    free(buf);
+    close(cwd);
+    if (n != sizeof(reply)) {
+        if (n >= 0)
+            errno = EPROTO;
+        zygote_lost();
+        return spawn_posix(j, p, path, in_fd, out_fd);
+    }
+
+    if (reply.pid < 0)
+        errno = reply.err;
+    *err = reply.exec_err;
+    return reply.pid;
+}
+
+/* zygote engine: the fork server clones the child, so launch cost follows the
+ * server's small address space instead of the shell's */
+static pid_t spawn_zygote(struct job *j, struct process *p, const char *path, int in_fd, int out_fd)
+{
+    int err;
+    pid_t pid = zygote_launch(j, p, path, in_fd, out_fd, &err);
+    if (pid > 0 && err == ENOENT && path != p->argv[0]) {
+        /* cached binary went away: drop the entry and re-resolve once */
+        waitpid(pid, NULL, 0);
+        path_cache_forget(p->argv[0]);
+        path = path_cache_lookup(p->argv[0]);
+        pid = path ? zygote_launch(j, p, path, in_fd, out_fd, &err) : -1;
+    }
+    if (pid > 0 && err) {
+        /* the exec failed: the child is the shell's, reap it and report the launch as failed */
+        waitpid(pid, NULL, 0);
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+/* Start an external command with the configured engine */
+pid_t spawn_process(struct job *j, struct process *p, int in_fd, int out_fd)
+{
+    pid_t pid = -1;
+    const char *path = path_cache_lookup(p->argv[0]);
+    if (path && (shell.spawn_mode == SPAWN_FORK || (p->sched.flags && shell.spawn_mode == SPAWN_POSIX)))
+        pid = spawn_fork(j, p, path, in_fd, out_fd); /* posix_spawn cannot set affinity or niceness */
+    else if (path && shell.spawn_mode == SPAWN_ZYGOTE)
+        pid = spawn_zygote(j, p, path, in_fd, out_fd);
+    else if (path)
+        pid = spawn_posix(j, p, path, in_fd, out_fd);
+
+    if (pid < 0)
+        p->acct.status = W_EXITCODE(path ? 126 : 127, 0); /* what sh reports */
+    if (!path) {
+        stats_add(STAT_NOT_FOUND);
+        pprintf(STDERR_FILENO, "%s: command not found\n", p->argv[0]);
+    } else if (pid < 0) {
+        stats_add(STAT_SPAWN_FAILURES);
+        pprintf(STDERR_FILENO, "%s: %s\n", p->argv[0], strerror(errno));
+    }
+    return pid;
+}
+
+/* Run a builtin in a forked child so the shell never blocks writing into a
+ * pipe whose reader has not been started yet */
+pid_t spawn_builtin(struct job *j, struct process *p, builtin_fn fn, int in_fd, int out_fd)
+{
+    pid_t pid = fork();
+    if (pid < 0) {
+        stats_add(STAT_SPAWN_FAILURES);
+        pprintf(STDERR_FILENO, "%s: %s\n", p->argv[0], strerror(errno));
+        return -1;
+    }
+    if (pid != 0)
+        return pid;
+
+    child_setup(j, p);
+    if (j->pipe_rd >= 0)
+        close(j->pipe_rd); /* no exec to drop it for us */
+    int ret = fn(p, in_fd, out_fd);
+    out_flush_all();
+    _exit(ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
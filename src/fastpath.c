@@ -0,0 +1,742 @@
+/*
+ * fastpath.c - In-shell cat, head, tail, wc and tee
+ */
+
+#define _GNU_SOURCE
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/builtin.h"
+#include "../include/command.h"
+#include "../include/fastpath.h"
+#include "../include/output.h"
+
+/* How fastpath_copy() moves bytes, cheapest first */
+enum {
+    MOVE_COPY_RANGE,  // file -> file inside the kernel
+    MOVE_SPLICE,      // either end is a pipe
+    MOVE_SENDFILE,    // file -> anything
+    MOVE_RW,          // read()/write() through rw_buf
+};
+
+#define RW_BUF_LEN 65536
+#define TAIL_TRIM_MIN (1 << 20)  // tail keeps at least this much before trimming
+
+/* Options shared by head and tail */
+struct count_opts {
+    long long count;   // lines or bytes to keep
+    int bytes;         // -c given
+    const char *file;  // NULL: read in_fd
+};
+
+/* Options of wc */
+struct wc_opts {
+    int lines, words, bytes;
+    const char *file;  // NULL: read in_fd
+};
+
+/* One fast-path command; cmd must stay first, see fastpath_dispatch() */
+struct fastpath {
+    struct builtin_cmd cmd;
+    builtin_fn run;
+    int (*accepts)(const struct process *p);
+};
+
+/* Sixteen bytes compared at once by count_newlines() (GCC vector extension) */
+typedef signed char nl_vec __attribute__((vector_size(16)));
+
+static char rw_buf[RW_BUF_LEN];
+
+/* Helper: parse a non-negative decimal count, -1 if s is anything else */
+static int parse_count(const char *s, long long *out)
+{
+    if (!s || !isdigit((unsigned char) *s))
+        return -1;
+    char *end;
+    errno = 0;
+    *out = strtoll(s, &end, 10);
+    return (*end || errno) ? -1 : 0;
+}
+
+/* Helper: parse head/tail options: -n N, -c N, -N and at most one file */
+static int count_opts_parse(const struct process *p, struct count_opts *o)
+{
+    o->count = 10;
+    o->bytes = 0;
+    o->file = NULL;
+
+    int i = 1;
+    for (; i < p->argc; i++) {
+        const char *a = p->argv[i];
+        if (a[0] != '-' || a[1] == '\0')
+            break;
+        const char *val = a + 1;
+        o->bytes = 0;
+        if (a[1] == 'n' || a[1] == 'c') {
+            o->bytes = (a[1] == 'c');
+            val = a[2] ? a + 2 : p->argv[++i];
+        }
+        if (parse_count(val, &o->count) < 0)
+            return -1; /* +N, -N suffixes and long options run the binary */
+    }
+
+    if (i < p->argc - 1)
+        return -1; /* several files need ==> name <== headers */
+    if (i == p->argc - 1 && strcmp(p->argv[i], "-") != 0)
+        o->file = p->argv[i];
+    return 0;
+}
+
+/* Helper: parse wc options: any mix of -l -w -c and at most one file */
+static int wc_opts_parse(const struct process *p, struct wc_opts *o)
+{
+    memset(o, 0, sizeof(*o));
+
+    int i = 1;
+    for (; i < p->argc; i++) {
+        const char *a = p->argv[i];
+        if (a[0] != '-' || a[1] == '\0')
+            break;
+        for (a++; *a; a++) {
+            if (*a == 'l')
+                o->lines = 1;
+            else if (*a == 'w')
+                o->words = 1;
+            else if (*a == 'c')
+                o->bytes = 1;
+            else
+                return -1;
+        }
+    }
+    if (!o->lines && !o->words && !o->bytes)
+        o->lines = o->words = o->bytes = 1;
+
+    if (i < p->argc - 1)
+        return -1; /* several files need a total line */
+    if (i == p->argc - 1 && strcmp(p->argv[i], "-") != 0)
+        o->file = p->argv[i];
+    return 0;
+}
+
+static int cat_accepts(const struct process *p)
+{
+    for (int i = 1; i < p->argc; i++) {
+        const char *a = p->argv[i];
+        if (a[0] == '-' && a[1] && strcmp(a, "-u") != 0)
+            return 0;
+    }
+    return 1;
+}
+
+static int head_tail_accepts(const struct process *p)
+{
+    struct count_opts o;
+    return count_opts_parse(p, &o) == 0;
+}
+
+static int wc_accepts(const struct process *p)
+{
+    struct wc_opts o;
+    return wc_opts_parse(p, &o) == 0;
+}
+
+static int tee_accepts(const struct process *p)
+{
+    for (int i = 1; i < p->argc; i++) {
+        const char *a = p->argv[i];
+        if (a[0] == '-' && strcmp(a, "-a") != 0)
+            return 0; /* includes "-", which tee treats as a file name */
+    }
+    return 1;
+}
+
+/* Helper: write all of buf, retrying short writes */
+static int write_all(int fd, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* Move up to limit bytes (all if limit < 0) from in to out.
+ * Prefers copy_file_range, splice or sendfile and drops to read()/write()
+ * whenever the kernel refuses the pair of files. */
+long long fastpath_copy(int in, int out, long long limit)
+{
+    struct stat si, so;
+    int mode = MOVE_RW;
+    if (fstat(in, &si) == 0 && fstat(out, &so) == 0) {
+        if (S_ISREG(si.st_mode) && S_ISREG(so.st_mode))
+            mode = MOVE_COPY_RANGE;
+        else if (S_ISFIFO(si.st_mode) || S_ISFIFO(so.st_mode))
+            mode = MOVE_SPLICE;
+        else if (S_ISREG(si.st_mode))
+            mode = MOVE_SENDFILE;
+    }
+
+    long long total = 0;
+    while (limit < 0 || total < limit) {
+        size_t chunk = FASTPATH_CHUNK;
+        if (limit >= 0 && limit - total < (long long) chunk)
+            chunk = limit - total;
+
+        ssize_t n;
+        switch (mode) {
+        case MOVE_COPY_RANGE:
+            n = copy_file_range(in, NULL, out, NULL, chunk, 0);
+            break;
+        case MOVE_SPLICE:
+            n = splice(in, NULL, out, NULL, chunk, SPLICE_F_MOVE);
+            break;
+        case MOVE_SENDFILE:
+            n = sendfile(out, in, NULL, chunk);
+            break;
+        default:
+            n = read(in, rw_buf, chunk < RW_BUF_LEN ? chunk : RW_BUF_LEN);
+            if (n > 0 && write_all(out, rw_buf, n) < 0)
+                return -1;
+        }
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (mode != MOVE_RW && (errno == EINVAL || errno == ENOSYS || errno == EXDEV || errno == EBADF ||
+                                    errno == EOPNOTSUPP)) {
+                mode = (mode == MOVE_COPY_RANGE ? MOVE_SENDFILE : MOVE_RW);
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0 && total == 0 && mode != MOVE_RW && mode != MOVE_SPLICE) {
+            mode = MOVE_RW; /* /proc and friends report size 0 but have data */
+            continue;
+        }
+        if (n == 0)
+            break;
+        total += n;
+    }
+    return total;
+}
+
+/* Helper: map the unread part of a regular file, NULL if empty or not mappable.
+ * flags adds MAP_POPULATE for callers that will read every page. */
+static const char *map_rest(int fd, int flags, off_t *cur, size_t *len, void **base, size_t *maplen)
+{
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+        return NULL;
+    *cur = lseek(fd, 0, SEEK_CUR);
+    if (*cur < 0 || *cur >= st.st_size)
+        return NULL;
+
+    off_t page = *cur & ~((off_t) sysconf(_SC_PAGESIZE) - 1);
+    *maplen = st.st_size - page;
+    *base = mmap(NULL, *maplen, PROT_READ, MAP_PRIVATE | flags, fd, page);
+    if (*base == MAP_FAILED)
+        return NULL;
+    *len = st.st_size - *cur;
+    return (const char *) *base + (*cur - page);
+}
+
+/* Helper: offset where the last count lines (or bytes) of buf begin */
+static size_t tail_offset(const char *buf, size_t len, long long count, int bytes)
+{
+    if (bytes)
+        return (long long) len > count ? len - count : 0;
+    if (count == 0)
+        return len;
+
+    size_t end = len;
+    if (end > 0 && buf[end - 1] == '\n')
+        end--; /* the final newline ends the last line, it does not start one */
+    while (end > 0) {
+        const char *nl = memrchr(buf, '\n', end);
+        if (!nl)
+            return 0;
+        if (--count == 0)
+            return nl - buf + 1;
+        end = nl - buf;
+    }
+    return 0;
+}
+
+/* Helper: length of the first count lines of buf; *count drops by the lines found */
+static size_t head_length(const char *buf, size_t len, long long *count)
+{
+    const char *s = buf, *end = buf + len, *nl;
+    while (*count > 0 && (nl = memchr(s, '\n', end - s))) {
+        (*count)--;
+        s = nl + 1;
+    }
+    return *count > 0 ? len : (size_t) (s - buf);
+}
+
+/* Helper: open the named input file, or use in_fd */
+static int open_input(const char *cmd, const char *file, int in_fd)
+{
+    if (!file)
+        return in_fd;
+    int fd = open(file, O_RDONLY);
+    if (fd < 0)
+        pprintf(STDERR_FILENO, "%s: %s: %s\n", cmd, file, strerror(errno));
+    return fd;
+}
+
+/* Helper: report a failed copy; a reader that went away is not an error */
+static int copy_failed(const char *cmd)
+{
+    if (errno != EPIPE)
+        pprintf(STDERR_FILENO, "%s: %s\n", cmd, strerror(errno));
+    return -1;
+}
+
+/* Helper: copy one cat operand ("-" is in_fd) to out_fd */
+static int cat_file(const char *file, int in_fd, int out_fd)
+{
+    int fd = open_input("cat", strcmp(file, "-") == 0 ? NULL : file, in_fd);
+    if (fd < 0)
+        return -1;
+    long long n = fastpath_copy(fd, out_fd, -1);
+    if (fd != in_fd)
+        close(fd);
+    return n < 0 ? copy_failed("cat") : 1;
+}
+
+/* Fast path: cat [-u] [file...] */
+static int fp_cat(struct process *p, int in_fd, int out_fd)
+{
+    int ret = 1, nfiles = 0;
+    for (int i = 1; i < p->argc; i++) {
+        if (strcmp(p->argv[i], "-u") == 0)
+            continue; /* output is never buffered anyway */
+        nfiles++;
+        if (cat_file(p->argv[i], in_fd, out_fd) < 0) {
+            ret = -1;
+            if (errno == EPIPE)
+                break;
+        }
+    }
+    if (nfiles == 0)
+        ret = cat_file("-", in_fd, out_fd);
+    return ret;
+}
+
+/* Fast path: head [-n N | -c N | -N] [file] */
+static int fp_head(struct process *p, int in_fd, int out_fd)
+{
+    struct count_opts o;
+    count_opts_parse(p, &o);
+    int fd = open_input("head", o.file, in_fd);
+    if (fd < 0)
+        return -1;
+
+    long long n = 0;
+    off_t cur;
+    size_t len, maplen;
+    void *base;
+    const char *map;
+    if (o.bytes || o.count == 0) {
+        n = fastpath_copy(fd, out_fd, o.count);
+    } else if ((map = map_rest(fd, 0, &cur, &len, &base, &maplen))) {
+        /* regular file: find the cut in the mapping, then send just that prefix */
+        size_t keep = head_length(map, len, &o.count);
+        munmap(base, maplen);
+        n = fastpath_copy(fd, out_fd, keep);
+    } else {
+        ssize_t r;
+        while (o.count > 0 && (r = read(fd, rw_buf, RW_BUF_LEN)) != 0) {
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                n = -1;
+                break;
+            }
+            if (write_all(out_fd, rw_buf, head_length(rw_buf, r, &o.count)) < 0) {
+                n = -1;
+                break;
+            }
+        }
+    }
+
+    if (fd != in_fd)
+        close(fd);
+    return n < 0 ? copy_failed("head") : 1;
+}
+
+/* Fast path: tail [-n N | -c N | -N] [file] */
+static int fp_tail(struct process *p, int in_fd, int out_fd)
+{
+    struct count_opts o;
+    count_opts_parse(p, &o);
+    int fd = open_input("tail", o.file, in_fd);
+    if (fd < 0)
+        return -1;
+
+    long long n = 0;
+    off_t cur;
+    size_t len, maplen;
+    void *base;
+    const char *map;
+    if ((map = map_rest(fd, 0, &cur, &len, &base, &maplen))) {
+        /* regular file: search backwards in the mapping, then send the suffix */
+        size_t off = tail_offset(map, len, o.count, o.bytes);
+        munmap(base, maplen);
+        if (lseek(fd, cur + off, SEEK_SET) < 0 || (n = fastpath_copy(fd, out_fd, len - off)) < 0)
+            n = -1;
+    } else {
+        /* stream: keep only the candidate suffix, trimming as the buffer grows */
+        char *buf = NULL;
+        size_t blen = 0, cap = 0, trim_at = TAIL_TRIM_MIN;
+        for (;;) {
+            if (cap - blen < RW_BUF_LEN) {
+                char *nbuf = realloc(buf, cap ? cap * 2 : 2 * RW_BUF_LEN);
+                if (!nbuf) {
+                    n = -1;
+                    break;
+                }
+                buf = nbuf;
+                cap = cap ? cap * 2 : 2 * RW_BUF_LEN;
+            }
+            ssize_t r = read(fd, buf + blen, cap - blen);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0) {
+                n = r;
+                break;
+            }
+            blen += r;
+            if (blen >= trim_at) {
+                size_t off = tail_offset(buf, blen, o.count, o.bytes);
+                memmove(buf, buf + off, blen - off);
+                blen -= off;
+                trim_at = (2 * blen > TAIL_TRIM_MIN ? 2 * blen : TAIL_TRIM_MIN);
+            }
+        }
+        if (n == 0) {
+            size_t off = tail_offset(buf, blen, o.count, o.bytes);
+            n = write_all(out_fd, buf + off, blen - off);
+        }
+        free(buf);
+    }
+
+    if (fd != in_fd)
+        close(fd);
+    return n < 0 ? copy_failed("tail") : 1;
+}
+
+/* Helper: count '\n' in buf sixteen bytes at a time; lines here are short,
+ * so one memchr() call per line costs more than comparing every byte */
+static long long count_newlines(const char *buf, size_t len)
+{
+    const nl_vec nl = (nl_vec){0} + '\n';
+    long long n = 0;
+    size_t i = 0;
+    while (i + sizeof(nl_vec) <= len) {
+        nl_vec acc = {0}; /* one counter per lane, at most 255 each */
+        for (int k = 0; k < 255 && i + sizeof(nl_vec) <= len; k++, i += sizeof(nl_vec)) {
+            nl_vec w;
+            memcpy(&w, buf + i, sizeof(w));
+            acc -= (w == nl); /* a match compares as -1 */
+        }
+        for (size_t j = 0; j < sizeof(nl_vec); j++)
+            n += (unsigned char) acc[j];
+    }
+    for (; i < len; i++)
+        n += (buf[i] == '\n');
+    return n;
+}
+
+/* Helper: add the counts of one buffer; *in_word carries across buffers */
+static void wc_add(const char *buf, size_t len, const struct wc_opts *o, long long counts[3], int *in_word)
+{
+    counts[2] += len;
+    if (o->lines)
+        counts[0] += count_newlines(buf, len);
+    if (!o->words)
+        return;
+    for (size_t i = 0; i < len; i++) {
+        if (isspace((unsigned char) buf[i])) {
+            *in_word = 0;
+        } else if (!*in_word) {
+            *in_word = 1;
+            counts[1]++;
+        }
+    }
+}
+
+/* Fast path: wc [-lwc] [file] */
+static int fp_wc(struct process *p, int in_fd, int out_fd)
+{
+    struct wc_opts o;
+    wc_opts_parse(p, &o);
+    int fd = open_input("wc", o.file, in_fd);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    int regular = (fstat(fd, &st) == 0 && S_ISREG(st.st_mode));
+    long long counts[3] = {0, 0, 0}; /* lines, words, bytes */
+    int in_word = 0, err = 0;
+
+    off_t cur;
+    size_t len, maplen;
+    void *base;
+    const char *map;
+    if (!o.lines && !o.words && regular && (cur = lseek(fd, 0, SEEK_CUR)) >= 0) {
+        counts[2] = (st.st_size > cur ? st.st_size - cur : 0); /* -c on a file is just its size */
+    } else if ((map = map_rest(fd, MAP_POPULATE, &cur, &len, &base, &maplen))) {
+        wc_add(map, len, &o, counts, &in_word);
+        munmap(base, maplen);
+        lseek(fd, cur + len, SEEK_SET);
+    } else {
+        ssize_t r;
+        while ((r = read(fd, rw_buf, RW_BUF_LEN)) != 0) {
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                err = errno;
+                break;
+            }
+            wc_add(rw_buf, r, &o, counts, &in_word);
+        }
+    }
+    if (fd != in_fd)
+        close(fd);
+    if (err) {
+        pprintf(STDERR_FILENO, "wc: %s\n", strerror(err));
+        return -1;
+    }
+
+    /* same column width as GNU wc */
+    int width = 1;
+    if (o.lines + o.words + o.bytes > 1) {
+        if (!regular)
+            width = 7;
+        else
+            for (long long size = st.st_size; size >= 10; size /= 10)
+                width++;
+    }
+
+    const char *sep = "";
+    const int selected[3] = {o.lines, o.words, o.bytes};
+    for (int i = 0; i < 3; i++) {
+        if (selected[i]) {
+            pprintf(out_fd, "%s%*lld", sep, width, counts[i]);
+            sep = " ";
+        }
+    }
+    if (o.file)
+        pprintf(out_fd, " %s", o.file);
+    pprintf(out_fd, "\n");
+    return 1;
+}
+
+/* Helper: tee(2) in into out and splice the same bytes into file, no user-space copy */
+static long long tee_splice(int in, int out, int file)
+{
+    long long total = 0;
+    for (;;) {
+        ssize_t n = tee(in, out, FASTPATH_CHUNK, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return n < 0 ? -1 : total;
+        for (ssize_t left = n; left > 0;) {
+            ssize_t m = splice(in, NULL, file, NULL, left, SPLICE_F_MOVE);
+            if (m < 0 && errno == EINTR)
+                continue;
+            if (m < 0 && errno == EINVAL) {
+                /* file cannot take splice (e.g. O_APPEND): copy these bytes */
+                m = read(in, rw_buf, left < RW_BUF_LEN ? left : RW_BUF_LEN);
+                if (m > 0 && write_all(file, rw_buf, m) < 0)
+                    return -1;
+            }
+            if (m <= 0)
+                return -1;
+            left -= m;
+        }
+        total += n;
+    }
+}
+
+/* Fast path: tee [-a] [file...] */
+static int fp_tee(struct process *p, int in_fd, int out_fd)
+{
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    int fds[p->argc];
+    int nfds = 0, ret = 1;
+
+    for (int i = 1; i < p->argc; i++) {
+        if (strcmp(p->argv[i], "-a") == 0)
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+    }
+    for (int i = 1; i < p->argc; i++) {
+        if (strcmp(p->argv[i], "-a") == 0)
+            continue;
+        int fd = open(p->argv[i], flags, 0644);
+        if (fd < 0) {
+            pprintf(STDERR_FILENO, "tee: %s: %s\n", p->argv[i], strerror(errno));
+            ret = -1;
+            continue;
+        }
+        fds[nfds++] = fd;
+    }
+
+    struct stat si, so;
+    int pipes = (fstat(in_fd, &si) == 0 && S_ISFIFO(si.st_mode) && fstat(out_fd, &so) == 0 && S_ISFIFO(so.st_mode));
+    long long n = 0;
+    if (nfds == 0) {
+        n = fastpath_copy(in_fd, out_fd, -1);
+    } else if (nfds == 1 && pipes) {
+        n = tee_splice(in_fd, out_fd, fds[0]);
+    } else {
+        ssize_t r;
+        while ((r = read(in_fd, rw_buf, RW_BUF_LEN)) != 0) {
+            if (r < 0) {
+                if (errno == EINTR)
+                    continue;
+                n = -1;
+                break;
+            }
+            if (write_all(out_fd, rw_buf, r) < 0) {
+                n = -1;
+                break;
+            }
+            for (int i = 0; i < nfds; i++) {
+                if (fds[i] >= 0 && write_all(fds[i], rw_buf, r) < 0) {
+                    pprintf(STDERR_FILENO, "tee: %s\n", strerror(errno));
+                    close(fds[i]);
+                    fds[i] = -1;
+                    ret = -1;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < nfds; i++) {
+        if (fds[i] >= 0)
+            close(fds[i]);
+    }
+    return n < 0 ? copy_failed("tee") : ret;
+}
+
+static int fastpath_dispatch(struct process *p, int in_fd, int out_fd);
+
+static struct fastpath fastpaths[] = {
+    {{"cat", fastpath_dispatch, CMD_FASTPATH}, fp_cat, cat_accepts},
+    {{"head", fastpath_dispatch, CMD_FASTPATH}, fp_head, head_tail_accepts},
+    {{"tail", fastpath_dispatch, CMD_FASTPATH}, fp_tail, head_tail_accepts},
+    {{"wc", fastpath_dispatch, CMD_FASTPATH}, fp_wc, wc_accepts},
+    {{"tee", fastpath_dispatch, CMD_FASTPATH}, fp_tee, tee_accepts},
+};
+#define NUM_FASTPATHS (int) (sizeof(fastpaths) / sizeof(*fastpaths))
+
+/* Bit i set: fastpaths[i] is enabled */
+static unsigned int fastpath_enabled = (1u << NUM_FASTPATHS) - 1;
+
+/* Run a fast path. SIGPIPE is ignored meanwhile: when it runs inside the
+ * shell, a reader that exits early must end the stage, not the shell. */
+static int fastpath_dispatch(struct process *p, int in_fd, int out_fd)
+{
+    const struct fastpath *fp = (const struct fastpath *) p->builtin;
+
+    out_flush_all(); /* output queued so far goes first */
+    void (*old)(int) = signal(SIGPIPE, SIG_IGN);
+    int ret = fp->run(p, in_fd, out_fd);
+    out_flush_all();
+    signal(SIGPIPE, old);
+    return ret;
+}
+
+/* Helper: whether opening name cannot block or stream forever: a regular
+ * file, or nothing (the fast path then just reports the error) */
+static int plain_file(const char *name)
+{
+    struct stat st;
+    return stat(name, &st) < 0 || S_ISREG(st.st_mode);
+}
+
+int fastpath_in_shell(const struct process *p, int in_fd, int shell_pipe)
+{
+    const struct fastpath *fp = (const struct fastpath *) p->builtin;
+    int reads_in = 1;
+
+    if (fp->run == fp_cat) {
+        int nfiles = 0;
+        reads_in = 0;
+        for (int i = 1; i < p->argc; i++) {
+            if (strcmp(p->argv[i], "-u") == 0)
+                continue;
+            nfiles++;
+            if (strcmp(p->argv[i], "-") == 0)
+                reads_in = 1;
+            else if (!plain_file(p->argv[i]))
+                return 0;
+        }
+        reads_in |= (nfiles == 0);
+    } else if (fp->run == fp_tee) {
+        for (int i = 1; i < p->argc; i++) {
+            if (strcmp(p->argv[i], "-a") != 0 && !plain_file(p->argv[i]))
+                return 0; /* a FIFO blocks in open() until it has a reader */
+        }
+    } else {
+        struct count_opts co;
+        struct wc_opts wo;
+        const char *file = NULL;
+        if (fp->run == fp_wc)
+            file = (wc_opts_parse(p, &wo) == 0 ? wo.file : NULL);
+        else
+            file = (count_opts_parse(p, &co) == 0 ? co.file : NULL);
+        if (file && !plain_file(file))
+            return 0;
+        reads_in = !file;
+    }
+
+    struct stat st;
+    return !reads_in || shell_pipe || (fstat(in_fd, &st) == 0 && S_ISREG(st.st_mode));
+}
+
+/* Read MY_SHELL_FASTPATH: all (default), none, or a comma separated list */
+void fastpath_init(void)
+{
+    const char *env = getenv(FASTPATH_ENV);
+    if (!env || strcmp(env, "all") == 0)
+        return;
+
+    fastpath_enabled = 0;
+    for (const char *s = env; *s;) {
+        size_t len = strcspn(s, ",");
+        for (int i = 0; i < NUM_FASTPATHS; i++) {
+            if (strlen(fastpaths[i].cmd.name) == len && strncmp(s, fastpaths[i].cmd.name, len) == 0)
+                fastpath_enabled |= 1u << i;
+        }
+        s += len + (s[len] == ',');
+    }
+}
+
+/* Fast-path entry for p, or NULL when p must run the external command */
+const struct builtin_cmd *fastpath_find(const struct process *p)
+{
+    for (int i = 0; i < NUM_FASTPATHS; i++) {
+        if ((fastpath_enabled & (1u << i)) && strcmp(p->argv[0], fastpaths[i].cmd.name) == 0)
+            return fastpaths[i].accepts(p) ? &fastpaths[i].cmd : NULL;
+    }
+    return NULL;
+}
@@ -0,0 +1,296 @@
+/*
+ * histindex.c - Trigram index for history search
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/histindex.h"
+#include "../include/history.h"
+
+#define POSTING_USED (1u << 24)    // set in every key, so 0 marks a free slot
+#define POSTING_BIGRAM (1u << 25)  // key holds two bytes rather than three
+#define SEARCH_LISTS 8           // shortest posting lists intersected per query
+
+/* Entries filed under one trigram */
+struct posting {
+    uint32_t key;    // the bytes | POSTING_USED (| POSTING_BIGRAM), 0 for a free slot
+    uint32_t len;
+    uint32_t cap;
+    uint32_t *ids;   // entry ids relative to tri.base, ascending
+};
+
+/* This shell's index of the history store */
+static struct {
+    struct posting *slots;  // open addressing, linear probing
+    uint32_t nslots;        // a power of two
+    uint32_t used;
+    int shift;              // 32 - log2(nslots)
+    uint64_t base;          // ids are stored as id - base
+    uint64_t last;          // newest id indexed
+    uint64_t added;         // ids indexed since the last prune
+    int built;
+} tri;
+
+/* Helper: slot for key, NULL when absent and create is not set */
+static struct posting *posting_find(uint32_t key, int create);
+
+static int table_alloc(uint32_t nslots)
+{
+    tri.slots = calloc(nslots, sizeof(*tri.slots));
+    if (!tri.slots)
+        return -1;
+    tri.nslots = nslots;
+    tri.used = 0;
+    tri.shift = 32 - __builtin_ctz(nslots);
+    return 0;
+}
+
+/* Helper: double the table, moving every list */
+static int table_grow(void)
+{
+    struct posting *old = tri.slots;
+    uint32_t n = tri.nslots;
+    if (table_alloc(n * 2) < 0) {
+        tri.slots = old;
+        tri.nslots = n;
+        return -1;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        if (old[i].key)
+            *posting_find(old[i].key, 1) = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+static struct posting *posting_find(uint32_t key, int create)
+{
+    if (create && (tri.used + 1) * 2 > tri.nslots && table_grow() < 0)
+        return NULL;
+    uint32_t i = (key * 2654435761u) >> tri.shift;
+    while (tri.slots[i].key && tri.slots[i].key != key)
+        i = (i + 1) & (tri.nslots - 1);
+    if (tri.slots[i].key)
+        return &tri.slots[i];
+    if (!create)
+        return NULL;
+    tri.slots[i].key = key;
+    tri.used++;
+    return &tri.slots[i];
+}
+
+static uint32_t trigram(const char *s)
+{
+    const unsigned char *u = (const unsigned char *) s;
+    return (u[0] << 16 | u[1] << 8 | u[2]) | POSTING_USED;
+}
+
+/* The second byte may be the terminating NUL: every byte of a line then
+ * starts a bigram, which is what one-byte patterns are looked up by */
+static uint32_t bigram(unsigned char a, unsigned char b)
+{
+    return (a << 8 | b) | POSTING_USED | POSTING_BIGRAM;
+}
+
+/* Helper: append off to the list for key unless it is already last */
+static void posting_add(uint32_t key, uint32_t off)
+{
+    struct posting *p = posting_find(key, 1);
+    if (!p || (p->len && p->ids[p->len - 1] == off))
+        return; /* no memory, or a repeat within the line */
+    if (p->len == p->cap) {
+        uint32_t cap = p->cap ? p->cap * 2 : 4;
+        uint32_t *ids = realloc(p->ids, cap * sizeof(*ids));
+        if (!ids)
+            return;
+        p->ids = ids;
+        p->cap = cap;
+    }
+    p->ids[p->len++] = off;
+}
+
+/* Helper: file entry id under each distinct bigram and trigram of line */
+static void index_entry(uint64_t id, const char *line)
+{
+    const unsigned char *u = (const unsigned char *) line;
+    uint32_t off = id - tri.base;
+    for (size_t i = 0; u[i]; i++) {
+        posting_add(bigram(u[i], u[i + 1]), off);
+        if (u[i + 1] && u[i + 2])
+            posting_add(trigram(line + i), off);
+    }
+}
+
+/* Helper: drop ids the store no longer holds from every list */
+static void prune(void)
+{
+    uint64_t first = history_first();
+    uint32_t keep = first > tri.base ? first - tri.base : 0;
+    for (uint32_t i = 0; i < tri.nslots; i++) {
+        struct posting *p = &tri.slots[i];
+        if (!p->key)
+            continue;
+        uint32_t k = 0;
+        while (k < p->len && p->ids[k] < keep)
+            k++;
+        memmove(p->ids, p->ids + k, (p->len - k) * sizeof(*p->ids));
+        p->len -= k;
+    }
+    tri.added = 0;
+}
+
+/* Helper: (re)index the whole store */
+static void build(void)
+{
+    for (uint32_t i = 0; tri.slots && i < tri.nslots; i++)
+        free(tri.slots[i].ids);
+    free(tri.slots);
+    tri.slots = NULL;
+    if (table_alloc(HISTINDEX_SLOTS) < 0)
+        return;
+
+    uint64_t first = history_first();
+    tri.base = first ? first - 1 : history_last();
+    tri.last = tri.base;
+    tri.added = 0;
+    tri.built = 1;
+    histindex_update();
+}
+
+void histindex_update(void)
+{
+    if (!tri.built)
+        return;
+    uint64_t last = history_last();
+    if (last <= tri.last)
+        return;
+    if (last - tri.base > UINT32_MAX) {
+        tri.built = 0; /* ids no longer fit relative to base */
+        build();
+        return;
+    }
+
+    uint64_t first = history_first();
+    for (uint64_t id = tri.last + 1 > first ? tri.last + 1 : first; id <= last; id++) {
+        const char *line = history_get(id);
+        if (line)
+            index_entry(id, line);
+    }
+    tri.added += last - tri.last;
+    tri.last = last;
+
+    /* once the store may have turned over, forget what it overwrote */
+    if (first && tri.added > last - first + 1)
+        prune();
+}
+
+/* Helper: position of the first id in p greater than off */
+static uint32_t upper_bound(const struct posting *p, uint32_t off)
+{
+    uint32_t lo = 0, hi = p->len;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (p->ids[mid] <= off)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static int contains(const struct posting *p, uint32_t off)
+{
+    uint32_t k = upper_bound(p, off);
+    return k > 0 && p->ids[k - 1] == off;
+}
+
+/* Helper: newest id at or below off in any list of a bigram starting with c */
+static int64_t newest_with_byte(unsigned char c, uint32_t off)
+{
+    int64_t best = -1;
+    for (int b = 0; b < 256; b++) {
+        struct posting *p = posting_find(bigram(c, b), 0);
+        uint32_t k = p ? upper_bound(p, off) : 0;
+        if (k > 0 && p->ids[k - 1] > best)
+            best = p->ids[k - 1];
+    }
+    return best;
+}
+
+uint64_t history_search(const char *pattern, uint64_t before)
+{
+    uint64_t first = history_first(), last = history_last();
+    if (before && before <= last)
+        last = before - 1;
+    if (!*pattern || !first || last < first)
+        return 0;
+
+    if (!tri.built)
+        build();
+    else
+        histindex_update();
+    if (!tri.slots)
+        return 0;
+
+    /* one byte: the newest entry among the lists of its bigrams */
+    size_t len = strlen(pattern);
+    if (len == 1) {
+        int64_t off = last - tri.base;
+        while (off >= 0 && (off = newest_with_byte(pattern[0], off)) >= 0 && off + tri.base >= first) {
+            const char *line = history_get(off + tri.base);
+            if (line && strchr(line, pattern[0]))
+                return off + tri.base;
+            off--;
+        }
+        return 0;
+    }
+
+    /* the shortest lists of the pattern's trigrams (its bigram when it has
+     * two bytes), shortest first */
+    struct posting *lists[SEARCH_LISTS];
+    int n = 0;
+    if (len == 2) {
+        lists[n++] = posting_find(bigram(pattern[0], pattern[1]), 0);
+        if (!lists[0])
+            return 0;
+    }
+    for (size_t i = 0; i + 3 <= len; i++) {
+        struct posting *p = posting_find(trigram(pattern + i), 0);
+        if (!p || p->len == 0)
+            return 0; /* some trigram occurs nowhere */
+        int k = 0;
+        while (k < n && lists[k] != p && lists[k]->len <= p->len)
+            k++;
+        if (k < n && lists[k] == p)
+            continue;
+        if (k == SEARCH_LISTS)
+            continue;
+        if (n < SEARCH_LISTS)
+            n++;
+        memmove(lists + k + 1, lists + k, (n - 1 - k) * sizeof(*lists));
+        lists[k] = p;
+    }
+
+    if (n == 0)
+        return 0; /* not reached: two or more bytes give at least one list */
+
+    /* candidates newest first; the other lists and strstr() confirm them */
+    struct posting *s = lists[0];
+    for (uint32_t k = upper_bound(s, last - tri.base); k-- > 0;) {
+        uint64_t id = s->ids[k] + tri.base;
+        if (id < first)
+            break;
+        int i = 1;
+        while (i < n && contains(lists[i], s->ids[k]))
+            i++;
+        if (i < n)
+            continue;
+        const char *line = history_get(id);
+        if (line && strstr(line, pattern))
+            return id;
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ * history.c - Persistent ring-buffer command history
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/histindex.h"
+#include "../include/history.h"
+#include "../include/shell.h"
+
+#define REC_ALIGN 8
+#define HIST_MIN_DATA 4096
+#define REC_SIZE(len) ((sizeof(struct hist_record) + (len) + 1 + REC_ALIGN - 1) & ~(uint64_t) (REC_ALIGN - 1))
+
+/* Mapped store */
+static struct {
+    struct hist_header *hdr;
+    uint64_t *index;  // logical offset of entry id at index[id % max_entries]
+    char *data;
+    size_t map_len;
+    int fd;  // -1 for an anonymous store
+} hist = {.fd = -1};
+
+/* Helper: positive size from the environment, or the default */
+static uint64_t env_size(const char *name, uint64_t def)
+{
+    const char *env = getenv(name);
+    if (!env || !*env)
+        return def;
+    char *end;
+    unsigned long long v = strtoull(env, &end, 10);
+    return (*end == '\0' && v > 0) ? v : def;
+}
+
+static size_t map_size(uint32_t entries, uint64_t data_size)
+{
+    return sizeof(struct hist_header) + (size_t) entries * sizeof(uint64_t) + data_size;
+}
+
+/* Helper: point the index/data views into a mapping */
+static void attach(void *map, size_t len)
+{
+    hist.hdr = map;
+    hist.index = (uint64_t *) (hist.hdr + 1);
+    hist.data = (char *) (hist.index + hist.hdr->max_entries);
+    hist.map_len = len;
+}
+
+static void header_init(struct hist_header *h, uint32_t entries, uint64_t data_size)
+{
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, HIST_MAGIC, sizeof(h->magic));
+    h->version = HIST_VERSION;
+    h->max_entries = entries;
+    h->data_size = data_size;
+    h->next_id = 1;
+}
+
+/* Helper: history kept in memory only, for this session */
+static int open_anonymous(uint32_t entries, uint64_t data_size)
+{
+    size_t len = map_size(entries, data_size);
+    void *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (map == MAP_FAILED)
+        return -1;
+    header_init(map, entries, data_size);
+    attach(map, len);
+    return 0;
+}
+
+/* Helper: whether h describes a store that fills a file of size bytes */
+static int header_valid(const struct hist_header *h, uint64_t size)
+{
+    return memcmp(h->magic, HIST_MAGIC, sizeof(h->magic)) == 0 && h->version == HIST_VERSION &&
+           h->max_entries >= MAX_HISTORY && h->data_size >= HIST_MIN_DATA && h->data_size % REC_ALIGN == 0 &&
+           h->data_size <= size && h->next_id > 0 && size == map_size(h->max_entries, h->data_size);
+}
+
+/* Helper: map the shared history file, creating it with the given sizes */
+static int open_file(const char *path, uint32_t entries, uint64_t data_size)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return -1;
+    flock(fd, LOCK_EX);
+
+    struct stat st;
+    struct hist_header h;
+    if (fstat(fd, &st) < 0)
+        goto fail;
+    int fresh = (st.st_size == 0);
+    if (!fresh) {
+        ssize_t n = pread(fd, &h, sizeof(h), 0);
+        size_t magic_len = n < (ssize_t) sizeof(h.magic) ? (size_t) (n > 0 ? n : 0) : sizeof(h.magic);
+        if (n != sizeof(h) || !header_valid(&h, st.st_size)) {
+            if (n <= 0 || memcmp(h.magic, HIST_MAGIC, magic_len) != 0) {
+                errno = EINVAL; /* someone else's file: leave it alone */
+                goto fail;
+            }
+            /* ours but truncated or corrupt: its sizes cannot be trusted */
+            pprintf(STDERR_FILENO, "history: %s: damaged history file, starting a new one\n", path);
+            if (ftruncate(fd, 0) < 0)
+                goto fail;
+            fresh = 1;
+        }
+    }
+    if (fresh) {
+        /* new store: sparse file, pages get allocated as history grows */
+        header_init(&h, entries, data_size);
+        if (ftruncate(fd, map_size(entries, data_size)) < 0 || pwrite(fd, &h, sizeof(h), 0) != sizeof(h))
+            goto fail;
+    }
+
+    /* sizes from the header: an existing store keeps those it was created with */
+    size_t len = map_size(h.max_entries, h.data_size);
+    void *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        goto fail;
+    flock(fd, LOCK_UN);
+    attach(map, len);
+    hist.fd = fd;
+    return 0;
+
+fail:
+    close(fd);
+    return -1;
+}
+
+int history_init(void)
+{
+    uint32_t entries = env_size(HIST_SIZE_ENV, HIST_ENTRIES);
+    uint64_t data_size = env_size(HIST_BYTES_ENV, HIST_DATA_SIZE);
+    if (entries < MAX_HISTORY)
+        entries = MAX_HISTORY;
+    if (data_size < HIST_MIN_DATA)
+        data_size = HIST_MIN_DATA;
+    data_size = (data_size + REC_ALIGN - 1) & ~(uint64_t) (REC_ALIGN - 1);
+
+    /* persistent by default for interactive shells, opt-in otherwise */
+    char path[PATH_LEN + sizeof(HIST_FILE) + 1];
+    const char *file = getenv(HIST_FILE_ENV);
+    if (!file && shell.interactive && shell.home_dir[0]) {
+        snprintf(path, sizeof(path), "%s/%s", shell.home_dir, HIST_FILE);
+        file = path;
+    }
+
+    if (file && *file) {
+        if (open_file(file, entries, data_size) == 0)
+            return 0;
+        pprintf(STDERR_FILENO, "history: %s: %s, keeping history in memory\n", file, strerror(errno));
+    }
+    return open_anonymous(entries, data_size);
+}
+
+/* Helper: record for id if it is still intact, else NULL */
+static const struct hist_record *record_of(uint64_t id)
+{
+    struct hist_header *h = hist.hdr;
+    uint64_t next = __atomic_load_n(&h->next_id, __ATOMIC_ACQUIRE);
+    if (id == 0 || id >= next || next - id > h->max_entries)
+        return NULL;
+
+    uint64_t off = hist.index[id % h->max_entries];
+    uint64_t head = __atomic_load_n(&h->data_head, __ATOMIC_ACQUIRE);
+    if (head > h->data_size && off < head - h->data_size)
+        return NULL; /* data ring has wrapped past it */
+
+    const struct hist_record *r = (const struct hist_record *) (hist.data + off % h->data_size);
+    return r->id == id ? r : NULL;
+}
+
+const char *history_get(uint64_t id)
+{
+    if (!hist.hdr)
+        return NULL;
+    const struct hist_record *r = record_of(id);
+    return r ? (const char *) (r + 1) : NULL;
+}
+
+uint64_t history_last(void)
+{
+    if (!hist.hdr)
+        return 0;
+    return __atomic_load_n(&hist.hdr->next_id, __ATOMIC_ACQUIRE) - 1;
+}
+
+uint64_t history_first(void)
+{
+    uint64_t last = history_last();
+    if (last == 0)
+        return 0;
+
+    /* start at the oldest index slot; a few more may have lost their data */
+    uint64_t id = last >= hist.hdr->max_entries ? last - hist.hdr->max_entries + 1 : 1;
+    while (id <= last && !record_of(id))
+        id++;
+    return id <= last ? id : 0;
+}
+
+/* Add command line to history buffer */
+void add_history(const char *line)
+{
+    if (*line == '\0')
+        return;
+    if (!hist.hdr && history_init() < 0)
+        return;
+
+    struct hist_header *h = hist.hdr;
+    size_t len = strlen(line);
+    if (REC_SIZE(len) > h->data_size / 4)
+        len = h->data_size / 4 - sizeof(struct hist_record) - REC_ALIGN; /* absurdly long line */
+
+    /* concurrent shells serialize appends on the file lock */
+    if (hist.fd >= 0)
+        flock(hist.fd, LOCK_EX);
+
+    uint64_t id = h->next_id;
+    uint64_t head = h->data_head;
+    uint64_t size = REC_SIZE(len);
+    uint64_t pos = head % h->data_size;
+    if (pos + size > h->data_size) {
+        /* records never straddle the end of the ring */
+        head += h->data_size - pos;
+        pos = 0;
+    }
+
+    struct hist_record *r = (struct hist_record *) (hist.data + pos);
+    r->id = id;
+    r->len = len;
+    r->pad = 0;
+    memcpy(r + 1, line, len);
+    ((char *) (r + 1))[len] = '\0';
+
+    hist.index[id % h->max_entries] = head;
+    __atomic_store_n(&h->data_head, head + size, __ATOMIC_RELEASE);
+    __atomic_store_n(&h->next_id, id + 1, __ATOMIC_RELEASE);
+
+    if (hist.fd >= 0)
+        flock(hist.fd, LOCK_UN);
+
+    histindex_update();
+}
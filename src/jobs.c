@@ -0,0 +1,233 @@
+/*
+ * jobs.c - Background job table and SIGCHLD reaper
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/acct.h"
+#include "../include/command.h"
+#include "../include/jobs.h"
+#include "../include/shell.h"
+#include "../include/stats.h"
+
+/* Shell-wide table of background jobs */
+static struct {
+    struct job **by_id;         // by_id[id], index 0 unused
+    int id_cap;                 // slots in by_id
+    int max_id;                 // highest id in use, 0 when empty
+    struct process **buckets;   // pid hash, chained through pid_next
+    unsigned int nbuckets;      // power of two
+    unsigned int nprocs;        // processes in the hash
+} table;
+
+/* SIGCHLD self-pipe: the handler only writes a byte, jobs_reap() does the work */
+static int sigchld_pipe[2] = {-1, -1};
+static volatile sig_atomic_t sigchld_pending;  // spares jobs_reap() a read() per line
+
+static void sigchld_handler(int sig)
+{
+    (void) sig;
+    int saved = errno;
+    sigchld_pending = 1;
+    (void) !write(sigchld_pipe[1], "", 1); /* full pipe: a wakeup is already pending */
+    errno = saved;
+}
+
+/* Install the SIGCHLD handler and its self-pipe */
+void jobs_init(void)
+{
+    if (pipe2(sigchld_pipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+        perror("pipe");
+        return;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sigchld_handler;
+    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGCHLD, &sa, NULL);
+}
+
+/* Helper: bucket of pid */
+static struct process **pid_bucket(pid_t pid)
+{
+    return &table.buckets[((unsigned int) pid * 2654435761u) & (table.nbuckets - 1)];
+}
+
+/* Helper: double the pid hash and rechain every process */
+static int grow_buckets(void)
+{
+    unsigned int old_n = table.nbuckets;
+    struct process **old = table.buckets;
+    unsigned int n = old_n ? old_n * 2 : JOB_TABLE_MIN;
+
+    struct process **buckets = calloc(n, sizeof(*buckets));
+    if (!buckets)
+        return -1;
+    table.buckets = buckets;
+    table.nbuckets = n;
+
+    for (unsigned int i = 0; i < old_n; i++) {
+        struct process *p = old[i];
+        while (p) {
+            struct process *next = p->pid_next;
+            struct process **b = pid_bucket(p->pid);
+            p->pid_next = *b;
+            *b = p;
+            p = next;
+        }
+    }
+    free(old);
+    return 0;
+}
+
+/* Helper: lowest id above every id in use, growing by_id when needed */
+static int next_id(void)
+{
+    int id = table.max_id + 1;
+    if (id >= table.id_cap) {
+        int cap = table.id_cap ? table.id_cap * 2 : JOB_TABLE_MIN;
+        struct job **by_id = realloc(table.by_id, cap * sizeof(*by_id));
+        if (!by_id)
+            return -1;
+        memset(by_id + table.id_cap, 0, (cap - table.id_cap) * sizeof(*by_id));
+        table.by_id = by_id;
+        table.id_cap = cap;
+    }
+    return id;
+}
+
+/* Track a launched background job; returns its id, or -1 if out of memory */
+int job_add(struct job *j)
+{
+    if (table.nprocs + j->running > table.nbuckets && grow_buckets() < 0)
+        return -1;
+    int id = next_id();
+    if (id < 0)
+        return -1;
+
+    for (struct process *p = j->first; p; p = p->next) {
+        if (p->pid <= 0)
+            continue;
+        struct process **b = pid_bucket(p->pid);
+        p->job = j;
+        p->pid_next = *b;
+        *b = p;
+        table.nprocs++;
+    }
+
+    j->id = id;
+    table.by_id[id] = j;
+    table.max_id = id;
+    return id;
+}
+
+/* Look up the job with id */
+struct job *job_find_id(int id)
+{
+    return (id > 0 && id <= table.max_id) ? table.by_id[id] : NULL;
+}
+
+/* Look up the tracked process with pid; a pgid finds the group leader */
+struct process *job_find_pid(pid_t pid)
+{
+    if (!table.nbuckets)
+        return NULL;
+    for (struct process *p = *pid_bucket(pid); p; p = p->pid_next) {
+        if (p->pid == pid)
+            return p;
+    }
+    return NULL;
+}
+
+/* Helper: unchain a reaped process from the pid hash */
+static void forget_pid(struct process *p)
+{
+    for (struct process **pp = pid_bucket(p->pid); *pp; pp = &(*pp)->pid_next) {
+        if (*pp == p) {
+            *pp = p->pid_next;
+            table.nprocs--;
+            return;
+        }
+    }
+}
+
+/* Helper: drop a finished job from the table */
+static void job_remove(struct job *j)
+{
+    table.by_id[j->id] = NULL;
+    while (table.max_id > 0 && !table.by_id[table.max_id])
+        table.max_id--; /* like other shells, ids restart once the top jobs finish */
+}
+
+/* Record the exit of a tracked background process; frees its job once
+ * the last process is gone, reporting it first when asked */
+void job_exited(struct process *p, int status, int report)
+{
+    p->state = WIFSIGNALED(status) ? PROC_TERMINATED : PROC_DONE;
+    forget_pid(p);
+
+    struct job *j = p->job;
+    if (--j->running > 0)
+        return;
+    stats_add(STAT_BG_DONE);
+
+    if (report) {
+        const char *what = "Done";
+        for (struct process *q = j->first; q; q = q->next) {
+            if (q->state == PROC_TERMINATED)
+                what = "Terminated";
+        }
+        pprintf(STDOUT_FILENO, "[%d] %s\t%s\n", j->id, what, j->full_cmd);
+    }
+    acct_report(j);
+    job_remove(j);
+    free_job(j);
+}
+
+/* Reap finished background children; report and free finished jobs */
+void jobs_reap(int report)
+{
+    if (!sigchld_pending)
+        return; /* no SIGCHLD since the last call */
+    sigchld_pending = 0;
+
+    char buf[64];
+    while (read(sigchld_pipe[0], buf, sizeof(buf)) > 0)
+        ;
+
+    int status;
+    struct rusage ru;
+    pid_t pid;
+    while ((pid = wait4(-1, &status, WNOHANG, &ru)) > 0) {
+        struct process *p = job_find_pid(pid);
+        if (!p)
+            continue; /* already waited for */
+        acct_exit(p, status, &ru);
+        job_exited(p, status, report);
+    }
+    if (report)
+        out_flush(STDOUT_FILENO);
+}
+
+/* Highest job id in use, 0 when there are no background jobs */
+int jobs_max_id(void)
+{
+    return table.max_id;
+}
+
+/* Read end of the SIGCHLD self-pipe, for event loops */
+int jobs_sigchld_fd(void)
+{
+    return sigchld_pipe[0];
+}
@@ -0,0 +1,134 @@
+/*
+ * lexer.c - Single-pass command line tokenizer
+ */
+
+#include <unistd.h>
+
+#include "../include/arena.h"
+#include "../include/lexer.h"
+#include "../include/shell.h"
+
+/* Initial token array capacity */
+#define LEX_TOKENS 16
+
+/* Character classes for the single pass */
+enum {
+    CH_WORD = 0,  // ordinary word character
+    CH_END,       // NUL
+    CH_SEP,       // separator, same set as TOK_DELIM
+    CH_OP,        // | < > &
+    CH_QUOTE,     // ' " or backslash
+};
+
+static const unsigned char char_class[256] = {
+    ['\0'] = CH_END,  [' '] = CH_SEP,   ['\t'] = CH_SEP,  ['\r'] = CH_SEP,  ['\n'] = CH_SEP,
+    ['\a'] = CH_SEP,  ['|'] = CH_OP,    ['<'] = CH_OP,    ['>'] = CH_OP,    ['&'] = CH_OP,
+    ['\''] = CH_QUOTE, ['"'] = CH_QUOTE, ['\\'] = CH_QUOTE,
+};
+
+#define CLASS(c) char_class[(unsigned char) (c)]
+
+/* Helper: token kind of an operator character */
+static int op_kind(char c)
+{
+    switch (c) {
+    case '|':
+        return LEX_PIPE;
+    case '<':
+        return LEX_IN;
+    case '>':
+        return LEX_OUT;
+    default:
+        return LEX_BG;
+    }
+}
+
+int lex_line(struct arena *a, const char *line, struct token **toks)
+{
+    int cap = LEX_TOKENS, n = 0;
+    struct token *t = arena_alloc(a, cap * sizeof(*t));
+    const char *s = line;
+
+    while (1) {
+        /* skip separators */
+        while (CLASS(*s) == CH_SEP)
+            s++;
+        if (*s == '\0')
+            break;
+
+        if (n == cap) {
+            t = arena_realloc(a, t, cap * sizeof(*t), cap * 2 * sizeof(*t));
+            cap *= 2;
+        }
+        struct token *tok = &t[n++];
+        tok->off = s - line;
+        tok->flags = 0;
+
+        if (CLASS(*s) == CH_OP) {
+            tok->kind = op_kind(*s);
+            tok->len = 1;
+            s++;
+            continue;
+        }
+
+        /* word: runs until an unquoted separator or operator */
+        tok->kind = LEX_WORD;
+        while (CLASS(*s) == CH_WORD || CLASS(*s) == CH_QUOTE) {
+            if (CLASS(*s) == CH_WORD) {
+                s++;
+            } else if (*s == '\\') {
+                tok->flags |= LEXF_QUOTED;
+                s += s[1] ? 2 : 1;
+            } else {
+                char q = *s++;
+                tok->flags |= LEXF_QUOTED;
+                while (*s && *s != q) {
+                    if (q == '"' && *s == '\\' && (s[1] == '"' || s[1] == '\\'))
+                        s++;
+                    s++;
+                }
+                if (*s == '\0') {
+                    pprintf(STDERR_FILENO, "syntax error: unterminated %c\n", q);
+                    return -1;
+                }
+                s++;
+            }
+        }
+        tok->len = (s - line) - tok->off;
+    }
+
+    *toks = t;
+    return n;
+}
+
+char *lex_word(char *buf, const struct token *t)
+{
+    char *start = buf + t->off;
+    char *end = start + t->len;
+
+    if (!(t->flags & LEXF_QUOTED)) {
+        *end = '\0';
+        return start;
+    }
+
+    /* compact the unquoted text towards the start of the span */
+    char *r = start, *w = start;
+    while (r < end) {
+        if (*r == '\\' && r + 1 < end) {
+            *w++ = r[1];
+            r += 2;
+        } else if (*r == '\'' || *r == '"') {
+            char q = *r++;
+            while (*r != q) {
+                if (q == '"' && *r == '\\' && (r[1] == '"' || r[1] == '\\'))
+                    r++;
+                *w++ = *r++;
+            }
+            r++;
+        } else {
+            *w++ = *r++;
+        }
+    }
+    *w = '\0';
+    return start;
+}
@@ -0,0 +1,491 @@
+/*
+ * lineedit.c - Raw-mode line editor with history, search and tab completion
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "../include/complete.h"
+#include "../include/histindex.h"
+#include "../include/history.h"
+#include "../include/lineedit.h"
+#include "../include/shell.h"
+
+#define KEY_CTRL(c) ((c) & 0x1f)
+
+/* Keys that arrive as escape sequences */
+enum {
+    KEY_NONE = 256,
+    KEY_UP,
+    KEY_DOWN,
+    KEY_RIGHT,
+    KEY_LEFT,
+    KEY_HOME,
+    KEY_END,
+    KEY_DELETE,
+};
+
+/* State of the line being edited */
+struct editor {
+    char *buf;           // the line, NUL-terminated
+    size_t len;
+    size_t cap;
+    size_t pos;          // cursor offset in buf
+    const char *prompt;
+    size_t prompt_cols;  // prompt width on screen
+    uint64_t hist_id;    // history entry shown, 0 for the line being typed
+    char *saved;         // the line being typed while the history is shown
+};
+
+int lineedit_available(void)
+{
+    const char *term = getenv("TERM");
+    return isatty(STDIN_FILENO) && isatty(STDOUT_FILENO) && !(term && strcmp(term, "dumb") == 0);
+}
+
+/* Helper: terminal width, 80 when unknown */
+static size_t term_cols(void)
+{
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) < 0 || ws.ws_col == 0)
+        return 80;
+    return ws.ws_col;
+}
+
+/* Helper: columns taken by the first n bytes of s, counting UTF-8 sequences once */
+static size_t span_cols(const char *s, size_t n)
+{
+    size_t cols = 0;
+    for (size_t i = 0; i < n; i++)
+        cols += ((unsigned char) s[i] & 0xc0) != 0x80;
+    return cols;
+}
+
+/* Helper: columns taken by the NUL-terminated s */
+static size_t text_cols(const char *s)
+{
+    return span_cols(s, strlen(s));
+}
+
+/* Helper: length of the UTF-8 sequence that starts s, at most n bytes */
+static size_t char_len(const char *s, size_t n)
+{
+    size_t i = 1;
+    while (i < n && ((unsigned char) s[i] & 0xc0) == 0x80)
+        i++;
+    return i;
+}
+
+/* Helper: start of the UTF-8 sequence that ends before offset pos of s */
+static size_t char_start(const char *s, size_t pos)
+{
+    while (pos > 0 && ((unsigned char) s[--pos] & 0xc0) == 0x80)
+        ;
+    return pos;
+}
+
+static void write_all(const char *s, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(STDOUT_FILENO, s, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        s += n;
+        len -= n;
+    }
+}
+
+/* Helper: one byte of input, -1 at end of input; SIGCHLD does not count */
+static int read_byte(void)
+{
+    unsigned char c;
+    for (;;) {
+        ssize_t n = read(STDIN_FILENO, &c, 1);
+        if (n == 1)
+            return c;
+        if (n < 0 && errno == EINTR)
+            continue;
+        return -1;
+    }
+}
+
+/* Helper: next key, with ESC [ and ESC O sequences folded into KEY_* */
+static int read_key(void)
+{
+    int c = read_byte();
+    if (c != 27)
+        return c;
+
+    int s0 = read_byte(), s1 = read_byte();
+    if (s0 == '[' && s1 >= '0' && s1 <= '9') {
+        if (read_byte() != '~')
+            return KEY_NONE;
+        switch (s1) {
+        case '1':
+        case '7':
+            return KEY_HOME;
+        case '4':
+        case '8':
+            return KEY_END;
+        case '3':
+            return KEY_DELETE;
+        }
+        return KEY_NONE;
+    }
+    if (s0 != '[' && s0 != 'O')
+        return s0 < 0 || s1 < 0 ? -1 : KEY_NONE;
+    switch (s1) {
+    case 'A':
+        return KEY_UP;
+    case 'B':
+        return KEY_DOWN;
+    case 'C':
+        return KEY_RIGHT;
+    case 'D':
+        return KEY_LEFT;
+    case 'H':
+        return KEY_HOME;
+    case 'F':
+        return KEY_END;
+    }
+    return s1 < 0 ? -1 : KEY_NONE;
+}
+
+/* Redraw prompt and line, scrolled sideways so the cursor stays on screen */
+static void refresh(struct editor *e)
+{
+    size_t cols = term_cols();
+    const char *b = e->buf;
+    size_t len = e->len, pos = e->pos;
+    size_t pos_cols = span_cols(b, pos);  // cursor column after the prompt
+    while (pos > 0 && e->prompt_cols + pos_cols >= cols) {
+        size_t skip = char_len(b, pos);
+        b += skip;
+        len -= skip;
+        pos -= skip;
+        pos_cols--;
+    }
+    size_t shown = 0, shown_cols = 0;  // bytes and columns that fit after the prompt
+    while (shown < len && e->prompt_cols + shown_cols < cols) {
+        shown += char_len(b + shown, len - shown);
+        shown_cols++;
+    }
+    len = shown;
+
+    size_t plen = strlen(e->prompt);
+    char *out = malloc(plen + len + 32);
+    if (!out)
+        return;
+    size_t n = 0;
+    out[n++] = '\r';
+    memcpy(out + n, e->prompt, plen);
+    n += plen;
+    memcpy(out + n, b, len);
+    n += len;
+    n += sprintf(out + n, "\x1b[0K\r");
+    if (e->prompt_cols + pos_cols)
+        n += sprintf(out + n, "\x1b[%zuC", e->prompt_cols + pos_cols);
+    write_all(out, n);
+    free(out);
+}
+
+/* Helper: replace bytes [from, to) of the line with s[0..n) and put the cursor after them */
+static int splice_text(struct editor *e, size_t from, size_t to, const char *s, size_t n)
+{
+    size_t len = e->len - (to - from) + n;
+    if (len + 1 > e->cap) {
+        size_t cap = e->cap * 2 > len + 1 ? e->cap * 2 : len + 1;
+        char *buf = realloc(e->buf, cap);
+        if (!buf)
+            return -1;
+        e->buf = buf;
+        e->cap = cap;
+    }
+    memmove(e->buf + from + n, e->buf + to, e->len - to + 1);
+    memcpy(e->buf + from, s, n);
+    e->len = len;
+    e->pos = from + n;
+    return 0;
+}
+
+/* Helper: show history entry id, or the line being typed for 0 */
+static void history_show(struct editor *e, uint64_t id)
+{
+    if (e->hist_id == 0) {
+        free(e->saved);
+        e->saved = strdup(e->buf);
+    }
+    const char *line = id ? history_get(id) : e->saved;
+    if (!line)
+        line = "";
+    splice_text(e, 0, e->len, line, strlen(line));
+    e->hist_id = id;
+}
+
+/* Helper: Up (dir -1) or Down (dir 1) through the history; 0 when there is no such entry */
+static int history_move(struct editor *e, int dir)
+{
+    uint64_t first = history_first(), last = history_last();
+    if (dir < 0) {
+        uint64_t id = e->hist_id ? e->hist_id - 1 : last;
+        if (!first || id < first || !history_get(id))
+            return 0;
+        history_show(e, id);
+    } else {
+        if (!e->hist_id)
+            return 0;
+        history_show(e, e->hist_id < last ? e->hist_id + 1 : 0);
+    }
+    return 1;
+}
+
+/* Helper: Tab; a second one in a row lists the candidates when nothing was added */
+static int complete(struct editor *e, int again)
+{
+    char *insert;
+    int count = complete_word(e->buf, e->pos, &insert);
+    if (!insert)
+        return 0;
+    int done = 1;
+    if (*insert) {
+        splice_text(e, e->pos, e->pos, insert, strlen(insert));
+    } else if (count > 1 && again) {
+        write_all("\n", 1);
+        complete_list(e->buf, e->pos, term_cols(), STDOUT_FILENO);
+        out_flush(STDOUT_FILENO);
+    } else {
+        done = 0;
+    }
+    free(insert);
+    return done;
+}
+
+/* Helper: ^R incremental search through the history index. Returns the key
+ * that ended it, to be handled as usual on the line found, or 0 after ^G or
+ * ^C put the original line back. */
+static int reverse_search(struct editor *e)
+{
+    const char *prompt = e->prompt;
+    size_t prompt_cols = e->prompt_cols;
+    char *orig = strdup(e->buf);
+    size_t orig_pos = e->pos;
+    char pattern[LINE_LEN] = "";
+    size_t len = 0;
+    uint64_t match = 0;  // entry shown
+    int failed = 0, c;
+
+    for (;;) {
+        char search_prompt[LINE_LEN + 32];
+        snprintf(search_prompt, sizeof(search_prompt), "(%sreverse-i-search)`%s': ", failed ? "failed " : "",
+                 pattern);
+        e->prompt = search_prompt;
+        e->prompt_cols = text_cols(search_prompt);
+        refresh(e);
+        e->prompt = prompt;
+        e->prompt_cols = prompt_cols;
+
+        /* entries older than from are searched, 0 for all of them */
+        uint64_t from;
+        c = read_key();
+        if (c == KEY_CTRL('R')) {
+            from = match;
+        } else if (c == 127 || c == KEY_CTRL('H')) {
+            if (len)
+                pattern[--len] = '\0';
+            from = 0;
+        } else if (c >= ' ' && c < 127 && len < sizeof(pattern) - 1) {
+            pattern[len++] = c;
+            pattern[len] = '\0';
+            from = match ? match + 1 : 0; /* the entry shown may still match */
+        } else {
+            break;
+        }
+
+        uint64_t id = len ? history_search(pattern, from) : 0;
+        failed = len && !id;
+        if (failed)
+            write_all("\a", 1);
+        const char *line = id ? history_get(id) : NULL;
+        if (line) {
+            splice_text(e, 0, e->len, line, strlen(line));
+            e->pos = strstr(line, pattern) - line;
+            match = id;
+        }
+    }
+
+    if (c == KEY_CTRL('G') || c == KEY_CTRL('C')) {
+        if (orig) {
+            splice_text(e, 0, e->len, orig, strlen(orig));
+            e->pos = orig_pos;
+        }
+        free(orig);
+        c = 0;
+    } else if (match) {
+        /* Up and Down go on from the entry found */
+        if (e->hist_id == 0) {
+            free(e->saved);
+            e->saved = orig;
+        } else {
+            free(orig);
+        }
+        e->hist_id = match;
+    } else {
+        free(orig);
+    }
+    refresh(e);
+    return c;
+}
+
+/* Helper: edit until Enter or end of input; the terminal is already raw */
+static char *edit(struct editor *e)
+{
+    int last = 0, pending = 0;
+    refresh(e);
+    for (;;) {
+        int c = pending ? pending : read_key();
+        int ok = 1;
+        pending = 0;
+
+        switch (c) {
+        case -1:
+            return NULL;
+        case '\r':
+        case '\n':
+            write_all("\n", 1);
+            return e->buf;
+        case '\t':
+            ok = complete(e, last == '\t');
+            break;
+        case KEY_CTRL('C'):
+            write_all("^C\n", 3);
+            splice_text(e, 0, e->len, "", 0);
+            e->hist_id = 0;
+            break;
+        case KEY_CTRL('D'):
+            if (e->len == 0) {
+                write_all("\n", 1);
+                return NULL;
+            }
+            /* fall through */
+        case KEY_DELETE:
+            if ((ok = e->pos < e->len))
+                splice_text(e, e->pos, e->pos + char_len(e->buf + e->pos, e->len - e->pos), "", 0);
+            break;
+        case 127:
+        case KEY_CTRL('H'):
+            if ((ok = e->pos > 0))
+                splice_text(e, char_start(e->buf, e->pos), e->pos, "", 0);
+            break;
+        case KEY_LEFT:
+        case KEY_CTRL('B'):
+            if ((ok = e->pos > 0))
+                e->pos = char_start(e->buf, e->pos);
+            break;
+        case KEY_RIGHT:
+        case KEY_CTRL('F'):
+            if ((ok = e->pos < e->len))
+                e->pos += char_len(e->buf + e->pos, e->len - e->pos);
+            break;
+        case KEY_HOME:
+        case KEY_CTRL('A'):
+            e->pos = 0;
+            break;
+        case KEY_END:
+        case KEY_CTRL('E'):
+            e->pos = e->len;
+            break;
+        case KEY_CTRL('K'):
+            splice_text(e, e->pos, e->len, "", 0);
+            break;
+        case KEY_CTRL('U'):
+            splice_text(e, 0, e->pos, "", 0);
+            break;
+        case KEY_CTRL('W'): {
+            size_t from = e->pos;
+            while (from > 0 && e->buf[from - 1] == ' ')
+                from--;
+            while (from > 0 && e->buf[from - 1] != ' ')
+                from--;
+            splice_text(e, from, e->pos, "", 0);
+            break;
+        }
+        case KEY_UP:
+        case KEY_CTRL('P'):
+            ok = history_move(e, -1);
+            break;
+        case KEY_DOWN:
+        case KEY_CTRL('N'):
+            ok = history_move(e, 1);
+            break;
+        case KEY_CTRL('L'):
+            write_all("\x1b[H\x1b[2J", 7);
+            break;
+        case KEY_CTRL('R'):
+            pending = reverse_search(e);
+            break;
+        default:
+            if (c >= ' ' && c < 256 && c != 127) {
+                char ch = c;
+                splice_text(e, e->pos, e->pos, &ch, 1);
+            } else {
+                ok = 0;
+            }
+            break;
+        }
+
+        if (!ok)
+            write_all("\a", 1);
+        refresh(e);
+        last = c;
+    }
+}
+
+char *lineedit_read(const char *prompt)
+{
+    out_flush_all(); /* anything queued belongs above the prompt */
+
+    struct termios orig, raw;
+    if (tcgetattr(STDIN_FILENO, &orig) < 0) {
+        /* not a terminal after all: plain line input */
+        char *line = NULL;
+        size_t cap = 0;
+        write_all(prompt, strlen(prompt));
+        if (getline(&line, &cap, stdin) < 0) {
+            free(line);
+            return NULL;
+        }
+        line[strcspn(line, "\n")] = '\0';
+        return line;
+    }
+
+    /* bytes as they are typed, no echo, ^C/^Z as keys; output processing stays on */
+    raw = orig;
+    raw.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+    raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSADRAIN, &raw);
+
+    struct editor e = {.cap = 128, .prompt = prompt, .prompt_cols = text_cols(prompt)};
+    e.buf = malloc(e.cap);
+    char *line = NULL;
+    if (e.buf) {
+        e.buf[0] = '\0';
+        line = edit(&e);
+    }
+
+    tcsetattr(STDIN_FILENO, TCSADRAIN, &orig);
+    free(e.saved);
+    if (!line)
+        free(e.buf);
+    return line;
+}
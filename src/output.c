@@ -0,0 +1,168 @@
+/*
+ * output.c - Buffered, writev-coalescing output for builtins
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/output.h"
+
+static struct out_buf out_slots[OUT_SLOTS] = {
+    [0 ... OUT_SLOTS - 1] = {.fd = -1},
+};
+static int out_victim; /* next slot to evict when all are busy */
+
+/* Helper: writev everything in b, resuming after partial writes */
+static void slot_flush(struct out_buf *b)
+{
+    struct iovec *iov = b->iov;
+    int cnt = b->iovcnt;
+
+    /* anything still sitting in stdio for this fd goes first */
+    if (b->fd == STDOUT_FILENO)
+        fflush(stdout);
+
+    while (cnt > 0) {
+        ssize_t n = writev(b->fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break; /* EPIPE, EBADF...: drop what is left */
+        }
+        while (cnt > 0 && (size_t) n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (char *) iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    b->iovcnt = 0;
+    b->len = 0;
+}
+
+/* Helper: buffer slot for fd, evicting another fd if needed */
+static struct out_buf *slot_get(int fd)
+{
+    struct out_buf *free_slot = NULL;
+    for (int i = 0; i < OUT_SLOTS; i++) {
+        if (out_slots[i].fd == fd)
+            return &out_slots[i];
+        if (out_slots[i].fd < 0 && !free_slot)
+            free_slot = &out_slots[i];
+    }
+    if (!free_slot) {
+        free_slot = &out_slots[out_victim];
+        out_victim = (out_victim + 1) % OUT_SLOTS;
+        slot_flush(free_slot);
+    }
+    free_slot->fd = fd;
+    return free_slot;
+}
+
+/* Helper: flush b unless it has a free iovec and len more bytes of data[]. A
+ * fragment must be formatted into data[] only after this: flushing resets
+ * b->len, which would leave the fragment queued where later ones overwrite it. */
+static void slot_reserve(struct out_buf *b, size_t len)
+{
+    if (b->iovcnt == OUT_IOV || b->len + len > OUT_BUF_LEN)
+        slot_flush(b);
+}
+
+/* Helper: queue a fragment, merging it with the previous one when adjacent */
+static void slot_add(struct out_buf *b, const char *s, size_t len)
+{
+    if (len == 0)
+        return;
+    if (b->iovcnt > 0) {
+        struct iovec *last = &b->iov[b->iovcnt - 1];
+        if ((const char *) last->iov_base + last->iov_len == s) {
+            last->iov_len += len;
+            return;
+        }
+    }
+    if (b->iovcnt == OUT_IOV)
+        slot_flush(b);
+    b->iov[b->iovcnt].iov_base = (void *) s;
+    b->iov[b->iovcnt].iov_len = len;
+    b->iovcnt++;
+}
+
+void out_flush(int fd)
+{
+    for (int i = 0; i < OUT_SLOTS; i++) {
+        if (out_slots[i].fd == fd) {
+            slot_flush(&out_slots[i]);
+            out_slots[i].fd = -1;
+        }
+    }
+}
+
+void out_flush_all(void)
+{
+    for (int i = 0; i < OUT_SLOTS; i++) {
+        if (out_slots[i].fd >= 0) {
+            slot_flush(&out_slots[i]);
+            out_slots[i].fd = -1;
+        }
+    }
+    fflush(stdout);
+}
+
+void pputs(int fd, const char *s, size_t len)
+{
+    struct out_buf *b = slot_get(fd);
+    if (len < OUT_COPY_MAX) {
+        /* short fragments are cheaper to copy than to reference */
+        slot_reserve(b, len);
+        memcpy(b->data + b->len, s, len);
+        slot_add(b, b->data + b->len, len);
+        b->len += len;
+        return;
+    }
+    slot_add(b, s, len);
+}
+
+/* Helper: write to fd or stdout interchangeably */
+void pprintf(int fd, const char *fmt, ...)
+{
+    va_list ap;
+
+    /* errors go out at once, after whatever was queued before them */
+    if (fd == STDERR_FILENO) {
+        out_flush_all();
+        va_start(ap, fmt);
+        vdprintf(fd, fmt, ap);
+        va_end(ap);
+        return;
+    }
+
+    struct out_buf *b = slot_get(fd);
+    slot_reserve(b, 0);
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t room = OUT_BUF_LEN - b->len;
+        va_start(ap, fmt);
+        int n = vsnprintf(b->data + b->len, room, fmt, ap);
+        va_end(ap);
+        if (n < 0)
+            return;
+        if ((size_t) n < room) {
+            slot_add(b, b->data + b->len, n);
+            b->len += n;
+            return;
+        }
+        /* did not fit: drain the buffer and try again */
+        slot_flush(b);
+    }
+
+    /* larger than the whole buffer */
+    va_start(ap, fmt);
+    vdprintf(fd, fmt, ap);
+    va_end(ap);
+}
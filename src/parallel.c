@@ -0,0 +1,652 @@
+/*
+ * parallel.c - parallel and xargs built-ins: bounded fan-out of a command over input
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/arena.h"
+#include "../include/builtin.h"
+#include "../include/command.h"
+#include "../include/fastpath.h"
+#include "../include/shell.h"
+#include "../include/supervise.h"
+
+#define PAR_READ_LEN 65536  // bytes read from in_fd at a time
+#define PAR_KEEP_WINDOW 4   // -k: items in flight or buffered per job slot
+#define XARGS_MARGIN 4096   // ARG_MAX headroom left unused (POSIX asks for 2048)
+#define XARGS_ARG_MAX (32 * 4096)  // longest single argument (Linux MAX_ARG_STRLEN)
+
+extern char **environ;
+
+/* One running item */
+struct par_slot {
+    struct job job;        // one-process job handed to launch_process()
+    struct process proc;   // template copy with the item substituted
+    long seq;              // input position of the item, -1 when the slot is free
+    int memfd;             // captured stdout, replayed in one piece
+    struct timespec start;
+};
+
+/* Item reader over in_fd; items stay valid until the next call */
+struct par_reader {
+    int fd;
+    int delim;  // '\n' lines, '\0' NUL-separated, ' ' any run of blanks
+    char *buf;
+    size_t len, pos, cap;
+    int eof;
+};
+
+/* Run totals for the final report */
+struct par_stats {
+    long long *lat_ns;  // latency of every finished item
+    long n, cap;
+    long failed;
+};
+
+/* State of one parallel run */
+struct par_run {
+    const struct process *tmpl;  // parsed once, copied into each slot
+    struct par_slot *slots;
+    long njobs;                  // slots, i.e. the concurrency limit
+    int keep;                    // -k: output in input order
+    long window;                 // -k: items started but not yet written
+    int *done;                   // -k: finished output by seq % window, -1 unset, -2 none
+    long next_out;               // -k: next seq to write
+    int out_fd, null_fd;
+    struct supervisor sv;
+    struct par_stats st;
+};
+
+/* Helper: first delimiter of r in [s, end), NULL if there is none */
+static char *find_delim(const struct par_reader *r, char *s, char *end)
+{
+    if (r->delim != ' ')
+        return memchr(s, r->delim, end - s);
+    for (; s < end; s++) {
+        if (*s == ' ' || *s == '\t' || *s == '\n')
+            return s;
+    }
+    return NULL;
+}
+
+/* Helper: next non-empty item without its delimiter, NULL at end of input */
+static char *read_item(struct par_reader *r)
+{
+    for (;;) {
+        char *nl = find_delim(r, r->buf + r->pos, r->buf + r->len);
+        if (nl || (r->eof && r->pos < r->len)) {
+            char *line = r->buf + r->pos;
+            char *end = nl ? nl : r->buf + r->len;
+            r->pos = end - r->buf + (nl != NULL);
+            *end = '\0';
+            if (*line)
+                return line;
+            continue;
+        }
+        if (r->eof)
+            return NULL;
+
+        /* keep the partial line, make room and read more */
+        memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+        r->len -= r->pos;
+        r->pos = 0;
+        if (r->cap - r->len < PAR_READ_LEN + 1) {
+            char *buf = realloc(r->buf, r->cap + PAR_READ_LEN + 1);
+            if (!buf)
+                return NULL;
+            r->buf = buf;
+            r->cap += PAR_READ_LEN + 1;
+        }
+        ssize_t n = read(r->fd, r->buf + r->len, PAR_READ_LEN);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            r->eof = 1;
+        else
+            r->len += n;
+    }
+}
+
+/* Helper: copy of word with every {} replaced by item, NULL if word has none */
+static char *substitute(const char *word, const char *item)
+{
+    const char *hole = strstr(word, "{}");
+    if (!hole)
+        return NULL;
+
+    size_t holes = 0;
+    for (const char *s = hole; s; s = strstr(s + 2, "{}"))
+        holes++;
+    size_t item_len = strlen(item);
+    char *out = malloc(strlen(word) + holes * item_len - holes * 2 + 1);
+    if (!out)
+        return NULL;
+
+    char *w = out;
+    const char *s = word;
+    for (; hole; s = hole + 2, hole = strstr(s, "{}")) {
+        memcpy(w, s, hole - s);
+        w += hole - s;
+        memcpy(w, item, item_len);
+        w += item_len;
+    }
+    strcpy(w, s);
+    return out;
+}
+
+/* Helper: parse the command words once, quoting each so the lexer keeps them intact */
+static struct process *parse_template(struct arena *a, char **words, int count)
+{
+    size_t len = 1;
+    for (int i = 0; i < count; i++)
+        len += strlen(words[i]) * 4 + 3;
+
+    char *line = arena_alloc(a, len), *w = line;
+    for (int i = 0; i < count; i++) {
+        *w++ = '\'';
+        for (const char *s = words[i]; *s; s++) {
+            if (*s == '\'') {
+                memcpy(w, "'\\''", 4); /* close, escaped quote, reopen */
+                w += 4;
+            } else {
+                *w++ = *s;
+            }
+        }
+        *w++ = '\'';
+        *w++ = ' ';
+    }
+    *w = '\0';
+    return parse_segment(a, line);
+}
+
+/* Helper: fill slot's process from the template for item */
+static void build_item(struct par_slot *slot, const struct process *tmpl, const char *item)
+{
+    struct process *p = &slot->proc;
+    int has_hole = 0;
+    for (int i = 0; i < tmpl->argc; i++) {
+        char *arg = substitute(tmpl->argv[i], item);
+        p->argv[i] = arg ? arg : tmpl->argv[i];
+        has_hole |= (arg != NULL);
+    }
+    p->argc = tmpl->argc;
+    if (!has_hole)
+        p->argv[p->argc++] = strdup(item); /* no {}: the item becomes the last argument */
+    p->argv[p->argc] = NULL;
+
+    /* fast paths depend on the arguments, everything else was resolved once */
+    if (!tmpl->builtin || tmpl->type == CMD_FASTPATH) {
+        p->builtin = fastpath_find(p);
+        p->type = (p->builtin ? CMD_FASTPATH : CMD_EXTERNAL);
+    }
+}
+
+/* Helper: write an item's captured output to out_fd and release it */
+static void emit(int memfd, int out_fd)
+{
+    if (lseek(memfd, 0, SEEK_SET) == 0)
+        fastpath_copy(memfd, out_fd, -1);
+    close(memfd);
+}
+
+/* Helper: milliseconds between two timestamps */
+static double elapsed_ms(const struct timespec *a, const struct timespec *b)
+{
+    return (b->tv_sec - a->tv_sec) * 1e3 + (b->tv_nsec - a->tv_nsec) / 1e6;
+}
+
+static int cmp_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/* Helper: record one finished item */
+static void par_stats_add(struct par_stats *st, const struct timespec *start, int failed)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    st->failed += failed;
+    if (st->n == st->cap) {
+        long cap = st->cap ? st->cap * 2 : 256;
+        long long *lat = realloc(st->lat_ns, cap * sizeof(*lat));
+        if (!lat)
+            return;
+        st->lat_ns = lat;
+        st->cap = cap;
+    }
+    st->lat_ns[st->n++] = (long long) (elapsed_ms(start, &now) * 1e6);
+}
+
+/* Helper: latency at percentile pct (nearest rank) in milliseconds */
+static double percentile_ms(const struct par_stats *st, int pct)
+{
+    long rank = (st->n * pct + 99) / 100;
+    return st->lat_ns[rank > 0 ? rank - 1 : 0] / 1e6;
+}
+
+/* Helper: throughput and tail latency on stderr */
+static void stats_report(struct par_stats *st, const struct timespec *t0)
+{
+    if (!st->n)
+        return;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double secs = elapsed_ms(t0, &now) / 1e3;
+
+    qsort(st->lat_ns, st->n, sizeof(*st->lat_ns), cmp_ll);
+    pprintf(STDERR_FILENO,
+            "parallel: %ld items (%ld failed) in %.3fs, %.1f items/s, "
+            "latency p50 %.1fms p95 %.1fms p99 %.1fms max %.1fms\n",
+            st->n, st->failed, secs, secs > 0 ? st->n / secs : 0.0, percentile_ms(st, 50), percentile_ms(st, 95),
+            percentile_ms(st, 99), st->lat_ns[st->n - 1] / 1e6);
+}
+
+/* Helper: the item in slot is over: count it, free it and pass its output on,
+ * with -k only once every earlier item's output has been written */
+static void finish_item(struct par_run *run, struct par_slot *slot, int failed)
+{
+    par_stats_add(&run->st, &slot->start, failed);
+    for (int i = 0; i < slot->proc.argc; i++) {
+        if (i >= run->tmpl->argc || slot->proc.argv[i] != run->tmpl->argv[i])
+            free(slot->proc.argv[i]);
+    }
+    slot->proc.argc = 0;
+
+    if (!run->keep) {
+        if (slot->memfd >= 0)
+            emit(slot->memfd, run->out_fd);
+    } else {
+        run->done[slot->seq % run->window] = (slot->memfd >= 0 ? slot->memfd : -2);
+        int *d;
+        while (*(d = &run->done[run->next_out % run->window]) != -1) {
+            if (*d >= 0)
+                emit(*d, run->out_fd);
+            *d = -1;
+            run->next_out++;
+        }
+    }
+    slot->seq = -1;
+}
+
+/* Helper: kill the worker in slot and reap it, for a run that cannot go on */
+static void slot_kill(struct par_slot *slot)
+{
+    kill(slot->proc.pid, SIGKILL);
+    while (waitpid(slot->proc.pid, NULL, 0) < 0 && errno == EINTR)
+        ;
+}
+
+/* Helper: start item number seq in a free slot; returns 1 if it is running */
+static int start_item(struct par_run *run, const char *item, long seq)
+{
+    struct par_slot *slot = run->slots;
+    while (slot->seq >= 0)
+        slot++;
+
+    slot->seq = seq;
+    clock_gettime(CLOCK_MONOTONIC, &slot->start);
+    build_item(slot, run->tmpl, item);
+    slot->memfd = memfd_create("parallel", MFD_CLOEXEC);
+    if (slot->memfd < 0) {
+        pprintf(STDERR_FILENO, "parallel: %s: %s\n", item, strerror(errno));
+        finish_item(run, slot, 1);
+        return 0;
+    }
+
+    memset(&slot->job, 0, sizeof(slot->job));
+    slot->job.mode = BG_EXEC; /* always forked, even for builtins */
+    slot->job.full_cmd = run->tmpl->raw_cmd;
+    slot->job.first = &slot->proc;
+    slot->job.pipe_rd = -1;
+    slot->proc.pid = 0;
+    slot->proc.state = PROC_RUNNING;
+
+    if (launch_process(&slot->job, &slot->proc, run->null_fd, slot->memfd) < 0 || slot->proc.pid <= 0) {
+        finish_item(run, slot, 1);
+        return 0;
+    }
+    if (sv_watch(&run->sv, &slot->proc) < 0) {
+        int status;
+        waitpid(slot->proc.pid, &status, 0); /* cannot be watched: finish it now */
+        finish_item(run, slot, !WIFEXITED(status) || WEXITSTATUS(status) != 0);
+        return 0;
+    }
+    return 1;
+}
+
+/* Built-in: parallel [-j N] [-k] cmd [args...] - run cmd once per input line,
+ * {} in the arguments is replaced by the line (appended if there is none) */
+int cmd_parallel(struct process *proc, int in_fd, int out_fd)
+{
+    struct par_run run;
+    memset(&run, 0, sizeof(run));
+    run.njobs = sysconf(_SC_NPROCESSORS_ONLN);
+    run.out_fd = out_fd;
+
+    int i = 1;
+    for (; i < proc->argc && proc->argv[i][0] == '-'; i++) {
+        if (strcmp(proc->argv[i], "-k") == 0) {
+            run.keep = 1;
+        } else if (strcmp(proc->argv[i], "-j") == 0 && i + 1 < proc->argc) {
+            char *end;
+            run.njobs = strtol(proc->argv[++i], &end, 10);
+            if (*end)
+                run.njobs = 0;
+        } else {
+            break;
+        }
+    }
+    if (i >= proc->argc || proc->argv[i][0] == '-' || run.njobs <= 0) {
+        pprintf(STDERR_FILENO, "usage: parallel [-j N] [-k] command [args...] (with {} for the input line)\n");
+        return -1;
+    }
+
+    struct arena *a = arena_create(ARENA_BLOCK_SIZE);
+    run.tmpl = (a ? parse_template(a, proc->argv + i, proc->argc - i) : NULL);
+    run.null_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    run.slots = calloc(run.njobs, sizeof(*run.slots));
+    run.window = (run.keep ? run.njobs * PAR_KEEP_WINDOW : 1);
+    run.done = malloc(run.window * sizeof(*run.done));
+    int ok = (run.tmpl && run.tmpl->argc > 0 && run.null_fd >= 0 && run.slots && run.done && sv_open(&run.sv) == 0);
+
+    for (long s = 0; ok && s < run.njobs; s++) {
+        run.slots[s].seq = -1;
+        run.slots[s].proc = *run.tmpl;
+        run.slots[s].proc.argc = 0;
+        run.slots[s].proc.argv = malloc((run.tmpl->argc + 2) * sizeof(char *));
+        ok = (run.slots[s].proc.argv != NULL);
+    }
+    for (long s = 0; ok && s < run.window; s++)
+        run.done[s] = -1;
+
+    struct par_reader rd = {.fd = in_fd, .delim = '\n'};
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    long seq = 0, running = 0;
+    char *item;
+
+    while (ok) {
+        /* fill free slots; -k also holds back while the oldest output is pending */
+        while (running < run.njobs && (!run.keep || seq < run.next_out + run.window) && (item = read_item(&rd)))
+            running += start_item(&run, item, seq++);
+        if (!running)
+            break;
+
+        struct process *p;
+        int status;
+        int ev = sv_next(&run.sv, &p, &status);
+        if (ev == SV_HANGUP)
+            continue;
+        if (ev != SV_EXITED) {
+            /* supervisor gave up: stop the workers still running and release their output */
+            pprintf(STDERR_FILENO, "parallel: lost track of workers: %s\n", strerror(errno));
+            for (long s = 0; s < run.njobs; s++) {
+                if (run.slots[s].seq >= 0) {
+                    slot_kill(&run.slots[s]);
+                    finish_item(&run, &run.slots[s], 1);
+                }
+            }
+            break;
+        }
+
+        struct par_slot *slot = run.slots;
+        while (&slot->proc != p)
+            slot++;
+        running--;
+        finish_item(&run, slot, !WIFEXITED(status) || WEXITSTATUS(status) != 0);
+    }
+
+    if (ok)
+        sv_close(&run.sv);
+    else
+        pprintf(STDERR_FILENO, "parallel: cannot set up: %s\n", strerror(errno));
+    stats_report(&run.st, &t0);
+
+    for (long s = 0; run.slots && s < run.njobs; s++)
+        free(run.slots[s].proc.argv);
+    free(run.slots);
+    free(run.done);
+    free(rd.buf);
+    free(run.st.lat_ns);
+    if (run.null_fd >= 0)
+        close(run.null_fd);
+    if (a)
+        arena_destroy(a);
+    return (ok && !run.st.failed) ? 1 : -1;
+}
+
+/* State of one xargs run: the batch being filled and the workers running */
+struct xargs_run {
+    const struct process *tmpl;
+    struct par_slot *slots;  // one per worker, seq >= 0 while running
+    long njobs, running;
+    int out_fd, null_fd;
+    long failed;
+    int stopped;       // the supervisor failed: launch nothing more
+    struct supervisor sv;
+    char **argv;       // template words, then the batch's items
+    int argc, cap;
+    char *buf;         // item storage, reused by every batch
+    long used;         // bytes of buf in use
+    long cost;         // argv bytes charged to the batch, strings and pointers
+    long budget;       // most argv bytes one exec may take
+};
+
+/* Helper: bytes the environment takes away from ARG_MAX */
+static long env_size(void)
+{
+    long n = sizeof(char *);
+    for (char **e = environ; *e; e++)
+        n += strlen(*e) + 1 + sizeof(char *);
+    return n;
+}
+
+/* Helper: wait for one worker to finish */
+static int xargs_reap(struct xargs_run *run)
+{
+    struct process *p;
+    int status, ev;
+    while ((ev = sv_next(&run->sv, &p, &status)) == SV_HANGUP)
+        ;
+    if (ev != SV_EXITED)
+        return -1;
+
+    struct par_slot *slot = run->slots;
+    while (&slot->proc != p)
+        slot++;
+    slot->seq = -1;
+    run->running--;
+    run->failed += (!WIFEXITED(status) || WEXITSTATUS(status) != 0);
+    return 0;
+}
+
+/* Helper: the supervisor failed; kill and reap the running workers and stop the run */
+static void xargs_stop(struct xargs_run *run)
+{
+    pprintf(STDERR_FILENO, "xargs: lost track of workers: %s\n", strerror(errno));
+    for (long s = 0; s < run->njobs; s++) {
+        if (run->slots[s].seq >= 0) {
+            slot_kill(&run->slots[s]);
+            run->slots[s].seq = -1;
+        }
+    }
+    run->running = 0;
+    run->failed++;
+    run->stopped = 1;
+}
+
+/* Helper: exec the batch in a free worker, then start an empty batch */
+static void xargs_launch(struct xargs_run *run)
+{
+    if (run->running == run->njobs && xargs_reap(run) < 0)
+        xargs_stop(run);
+
+    struct par_slot *slot = run->slots;
+    while (slot < run->slots + run->njobs && slot->seq >= 0)
+        slot++;
+    if (run->stopped || slot == run->slots + run->njobs) {
+        run->argc = run->tmpl->argc; /* drop the batch */
+        run->used = 0;
+        run->cost = 0;
+        return;
+    }
+
+    /* the child gets its own copy of argv, so buf is free again on return */
+    run->argv[run->argc] = NULL;
+    slot->proc = *run->tmpl;
+    slot->proc.argv = run->argv;
+    slot->proc.argc = run->argc;
+    if (!run->tmpl->builtin || run->tmpl->type == CMD_FASTPATH) {
+        slot->proc.builtin = fastpath_find(&slot->proc);
+        slot->proc.type = (slot->proc.builtin ? CMD_FASTPATH : CMD_EXTERNAL);
+    }
+    memset(&slot->job, 0, sizeof(slot->job));
+    slot->job.mode = BG_EXEC;
+    slot->job.full_cmd = run->tmpl->raw_cmd;
+    slot->job.first = &slot->proc;
+    slot->job.pipe_rd = -1;
+
+    if (launch_process(&slot->job, &slot->proc, run->null_fd, run->out_fd) < 0 || slot->proc.pid <= 0) {
+        run->failed++;
+    } else if (sv_watch(&run->sv, &slot->proc) < 0) {
+        int status;
+        waitpid(slot->proc.pid, &status, 0);
+        run->failed += (!WIFEXITED(status) || WEXITSTATUS(status) != 0);
+    } else {
+        slot->seq = 0;
+        run->running++;
+    }
+
+    run->argc = run->tmpl->argc;
+    run->used = 0;
+    run->cost = 0;
+}
+
+/* Helper: add item to the batch, launching the full batch first when needed */
+static int xargs_add(struct xargs_run *run, const char *item, int max_items)
+{
+    long len = strlen(item) + 1;
+    long cost = len + sizeof(char *);
+    if (len > XARGS_ARG_MAX || cost > run->budget) {
+        pprintf(STDERR_FILENO, "xargs: argument too long: %.32s...\n", item);
+        return -1;
+    }
+
+    int items = run->argc - run->tmpl->argc;
+    if (items > 0 && (run->cost + cost > run->budget || items == max_items))
+        xargs_launch(run);
+
+    if (run->argc + 1 >= run->cap) {
+        int cap = run->cap * 2;
+        char **argv = realloc(run->argv, cap * sizeof(*argv));
+        if (!argv)
+            return -1;
+        run->argv = argv;
+        run->cap = cap;
+    }
+    char *copy = memcpy(run->buf + run->used, item, len);
+    run->argv[run->argc++] = copy;
+    run->used += len;
+    run->cost += cost;
+    return 0;
+}
+
+/* Built-in: xargs [-n N] [-P N] [-0] cmd [args...] - run cmd with the input
+ * items as extra arguments, as many per exec as ARG_MAX allows */
+int cmd_xargs(struct process *proc, int in_fd, int out_fd)
+{
+    struct xargs_run run;
+    memset(&run, 0, sizeof(run));
+    run.njobs = 1;
+    run.out_fd = out_fd;
+    long max_items = 0;
+    int delim = ' ', i = 1, bad = 0;
+
+    for (; i < proc->argc && proc->argv[i][0] == '-'; i++) {
+        char *end = NULL;
+        if (strcmp(proc->argv[i], "-0") == 0)
+            delim = '\0';
+        else if (strcmp(proc->argv[i], "-n") == 0 && i + 1 < proc->argc)
+            max_items = strtol(proc->argv[++i], &end, 10);
+        else if (strcmp(proc->argv[i], "-P") == 0 && i + 1 < proc->argc)
+            run.njobs = strtol(proc->argv[++i], &end, 10);
+        else
+            break;
+        if (end && (*end || end == proc->argv[i] || max_items < 0 || run.njobs <= 0)) {
+            bad = 1; /* never run a bad value as the command */
+            break;
+        }
+    }
+    if (bad || i >= proc->argc || proc->argv[i][0] == '-') {
+        pprintf(STDERR_FILENO, "usage: xargs [-n N] [-P N] [-0] command [args...]\n");
+        return -1;
+    }
+
+    struct arena *a = arena_create(ARENA_BLOCK_SIZE);
+    run.tmpl = (a ? parse_template(a, proc->argv + i, proc->argc - i) : NULL);
+    int ok = (run.tmpl && run.tmpl->argc > 0);
+
+    /* what one exec may take: ARG_MAX less the environment, the headroom and the command itself */
+    if (ok) {
+        run.budget = sysconf(_SC_ARG_MAX) - env_size() - XARGS_MARGIN;
+        for (int w = 0; w < run.tmpl->argc; w++)
+            run.budget -= strlen(run.tmpl->argv[w]) + 1 + sizeof(char *);
+        if (run.budget < 2 * (long) sizeof(char *)) {
+            pprintf(STDERR_FILENO, "xargs: environment too large for any arguments\n");
+            ok = 0;
+        }
+    }
+
+    run.null_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    run.slots = calloc(run.njobs, sizeof(*run.slots));
+    run.cap = (ok ? run.tmpl->argc + 64 : 0);
+    run.argv = malloc(run.cap * sizeof(*run.argv));
+    run.buf = (ok ? malloc(run.budget) : NULL);
+    ok = ok && run.null_fd >= 0 && run.slots && run.argv && run.buf && sv_open(&run.sv) == 0;
+
+    if (ok) {
+        for (long s = 0; s < run.njobs; s++)
+            run.slots[s].seq = -1;
+        memcpy(run.argv, run.tmpl->argv, run.tmpl->argc * sizeof(*run.argv));
+        run.argc = run.tmpl->argc;
+
+        /* stream: only the batch being filled is held in memory */
+        struct par_reader rd = {.fd = in_fd, .delim = delim};
+        char *item;
+        while (!run.stopped && (item = read_item(&rd))) {
+            if (xargs_add(&run, item, max_items) < 0)
+                run.failed++;
+        }
+        free(rd.buf);
+
+        if (run.argc > run.tmpl->argc)
+            xargs_launch(&run);
+        while (run.running > 0) {
+            if (xargs_reap(&run) < 0)
+                xargs_stop(&run);
+        }
+        sv_close(&run.sv);
+    } else if (run.tmpl && run.tmpl->argc > 0 && run.budget > 0) {
+        pprintf(STDERR_FILENO, "xargs: cannot set up: %s\n", strerror(errno));
+    }
+
+    free(run.slots);
+    free(run.argv);
+    free(run.buf);
+    if (run.null_fd >= 0)
+        close(run.null_fd);
+    if (a)
+        arena_destroy(a);
+    return (ok && !run.failed) ? 1 : -1;
+}
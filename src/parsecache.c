@@ -0,0 +1,301 @@
+/*
+ * parsecache.c - LRU cache of parsed-job templates
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/arena.h"
+#include "../include/builtin.h"
+#include "../include/command.h"
+#include "../include/parsecache.h"
+#include "../include/shell.h"
+
+/* One parsed line. Everything from procs[] up to image_len is the image a hit
+ * copies; its pointers all point into the image itself. The key follows. */
+struct template {
+    struct template *hnext;  // bucket chain
+    struct template *prev;   // LRU list, most recently used first
+    struct template *next;
+    unsigned int hash;
+    int mode;                // FG_EXEC or BG_EXEC
+    int timed;               // `time` prefix
+    int nproc;
+    size_t image_len;        // bytes copied per hit
+    size_t size;             // bytes charged against the budget
+    unsigned long hits;
+    const char *line;        // key, stored right after the image
+    struct process procs[];  // image: processes, argv arrays, CPU sets, strings
+};
+
+/* Shell-wide template cache */
+static struct {
+    struct template *buckets[PARSECACHE_BUCKETS];
+    struct template *head;  // most recently used
+    struct template *tail;  // next to evict
+    size_t budget;
+    size_t used;
+    int count;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+} cache = {.budget = PARSECACHE_BUDGET};
+
+/* Helper: FNV-1a hash of a command line */
+static unsigned int line_hash(const char *line)
+{
+    unsigned int h = 2166136261u;
+    while (*line) {
+        h ^= (unsigned char) *line++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Helper: "65536", "64K" or "1M" in bytes; returns 0 or -1 */
+static int parse_budget(const char *s, size_t *budget)
+{
+    char *end;
+    unsigned long n = strtoul(s, &end, 10);
+    if (end == s)
+        return -1;
+    if (*end == 'K' || *end == 'k') {
+        n <<= 10;
+        end++;
+    } else if (*end == 'M' || *end == 'm') {
+        n <<= 20;
+        end++;
+    }
+    if (*end)
+        return -1;
+    *budget = n;
+    return 0;
+}
+
+void parsecache_init(void)
+{
+    const char *env = getenv(PARSECACHE_ENV);
+    if (env && *env && parse_budget(env, &cache.budget) < 0)
+        pprintf(STDERR_FILENO, "%s: expected a size in bytes (suffix K or M)\n", PARSECACHE_ENV);
+}
+
+static void lru_unlink(struct template *t)
+{
+    if (t->prev)
+        t->prev->next = t->next;
+    else
+        cache.head = t->next;
+    if (t->next)
+        t->next->prev = t->prev;
+    else
+        cache.tail = t->prev;
+}
+
+static void lru_push(struct template *t)
+{
+    t->prev = NULL;
+    t->next = cache.head;
+    if (cache.head)
+        cache.head->prev = t;
+    else
+        cache.tail = t;
+    cache.head = t;
+}
+
+/* Helper: unlink and free one template */
+static void drop(struct template *t)
+{
+    struct template **slot = &cache.buckets[t->hash % PARSECACHE_BUCKETS];
+    while (*slot != t)
+        slot = &(*slot)->hnext;
+    *slot = t->hnext;
+    lru_unlink(t);
+    cache.used -= t->size;
+    cache.count--;
+    free(t);
+}
+
+/* Helper: evict least recently used templates until used fits the budget */
+static void evict(void)
+{
+    while (cache.tail && cache.used > cache.budget) {
+        drop(cache.tail);
+        cache.evictions++;
+    }
+}
+
+void parsecache_clear(void)
+{
+    while (cache.head)
+        drop(cache.head);
+}
+
+void parsecache_set_budget(size_t budget)
+{
+    cache.budget = budget;
+    evict();
+}
+
+/* Helper: the copy of ptr (which points into t's image) inside base */
+static void *rebase(const struct template *t, char *base, const void *ptr)
+{
+    return ptr ? base + ((const char *) ptr - (const char *) t->procs) : NULL;
+}
+
+/* Fill j (processes, mode, time prefix) from the template of j->full_cmd */
+int parsecache_lookup(struct job *j)
+{
+    if (!cache.budget)
+        return 0;
+
+    unsigned int hash = line_hash(j->full_cmd);
+    struct template *t = cache.buckets[hash % PARSECACHE_BUCKETS];
+    while (t && (t->hash != hash || strcmp(t->line, j->full_cmd) != 0))
+        t = t->hnext;
+    if (!t) {
+        cache.misses++;
+        return 0;
+    }
+
+    char *base = arena_alloc(j->arena, t->image_len);
+    if (!base)
+        return 0;
+    memcpy(base, t->procs, t->image_len);
+
+    struct process *procs = (struct process *) base;
+    for (int i = 0; i < t->nproc; i++) {
+        struct process *p = &procs[i];
+        p->raw_cmd = rebase(t, base, p->raw_cmd);
+        p->argv = rebase(t, base, p->argv);
+        for (int k = 0; k < p->argc; k++)
+            p->argv[k] = rebase(t, base, p->argv[k]);
+        p->infile = rebase(t, base, p->infile);
+        p->outfile = rebase(t, base, p->outfile);
+        p->sched.cpus = rebase(t, base, p->sched.cpus);
+        p->next = i + 1 < t->nproc ? p + 1 : NULL;
+    }
+    j->first = procs;
+    j->mode = t->mode;
+    j->timed = t->timed;
+
+    cache.hits++;
+    t->hits++;
+    lru_unlink(t);
+    lru_push(t);
+    return 1;
+}
+
+/* Helper: copy s to *cursor and advance it */
+static char *copy_str(char **cursor, const char *s)
+{
+    if (!s)
+        return NULL;
+    size_t n = strlen(s) + 1;
+    char *d = memcpy(*cursor, s, n);
+    *cursor += n;
+    return d;
+}
+
+/* Remember a freshly parsed job as the template for its line */
+void parsecache_insert(const struct job *j)
+{
+    if (!cache.budget || !j->first)
+        return;
+
+    /* size the image: processes, argv arrays, CPU sets, then strings */
+    int nproc = 0, nargv = 0, ncpus = 0;
+    size_t strings = strlen(j->full_cmd) + 1;
+    for (const struct process *p = j->first; p; p = p->next) {
+        nproc++;
+        nargv += p->argc + 1;
+        ncpus += p->sched.cpus != NULL;
+        for (int k = 0; k < p->argc; k++)
+            strings += strlen(p->argv[k]) + 1;
+        strings += (p->raw_cmd ? strlen(p->raw_cmd) + 1 : 0) + (p->infile ? strlen(p->infile) + 1 : 0) +
+                   (p->outfile ? strlen(p->outfile) + 1 : 0);
+    }
+    size_t size = sizeof(struct template) + nproc * sizeof(struct process) + nargv * sizeof(char *) +
+                  ncpus * sizeof(cpu_set_t) + strings;
+    if (size > cache.budget)
+        return;
+    struct template *t = malloc(size);
+    if (!t)
+        return;
+
+    char **argv = (char **) (t->procs + nproc);
+    cpu_set_t *cpus = (cpu_set_t *) (argv + nargv);
+    char *str = (char *) (cpus + ncpus);
+    int i = 0;
+    for (const struct process *p = j->first; p; p = p->next, i++) {
+        struct process *d = &t->procs[i];
+        *d = *p;
+        d->argv = argv;
+        for (int k = 0; k < p->argc; k++)
+            argv[k] = copy_str(&str, p->argv[k]);
+        argv[p->argc] = NULL;
+        argv += p->argc + 1;
+        d->raw_cmd = copy_str(&str, p->raw_cmd);
+        d->infile = copy_str(&str, p->infile);
+        d->outfile = copy_str(&str, p->outfile);
+        if (p->sched.cpus) {
+            *cpus = *p->sched.cpus;
+            d->sched.cpus = cpus++;
+        }
+        d->next = p->next ? d + 1 : NULL;
+    }
+    t->image_len = str - (char *) t->procs;
+    t->line = copy_str(&str, j->full_cmd);
+
+    t->hash = line_hash(j->full_cmd);
+    t->mode = j->mode;
+    t->timed = j->timed;
+    t->nproc = nproc;
+    t->size = size;
+    t->hits = 0;
+    struct template **slot = &cache.buckets[t->hash % PARSECACHE_BUCKETS];
+    t->hnext = *slot;
+    *slot = t;
+    lru_push(t);
+    cache.used += size;
+    cache.count++;
+    evict();
+}
+
+/* Built-in: parsecache [-r | -s SIZE] - show, clear or resize the template cache */
+int cmd_parsecache(struct process *proc, int in_fd, int out_fd)
+{
+    (void) in_fd;
+
+    if (proc->argc == 1) {
+        if (cache.head)
+            pprintf(out_fd, "hits\tbytes\tcommand\n");
+        for (struct template *t = cache.head; t; t = t->next)
+            pprintf(out_fd, "%4lu\t%zu\t%s\n", t->hits, t->size, t->line);
+        unsigned long lookups = cache.hits + cache.misses;
+        pprintf(out_fd, "parsecache: %d entries, %zu of %zu bytes, %lu hits, %lu misses (%.1f%% hit rate), %lu evicted\n",
+                cache.count, cache.used, cache.budget, cache.hits, cache.misses,
+                lookups ? 100.0 * cache.hits / lookups : 0.0, cache.evictions);
+        return 1;
+    }
+
+    if (strcmp(proc->argv[1], "-r") == 0 && proc->argc == 2) {
+        parsecache_clear();
+        return 1;
+    }
+
+    if (strcmp(proc->argv[1], "-s") == 0 && proc->argc == 3) {
+        size_t budget;
+        if (parse_budget(proc->argv[2], &budget) < 0) {
+            pprintf(STDERR_FILENO, "parsecache: %s: expected a size in bytes (suffix K or M)\n", proc->argv[2]);
+            return -1;
+        }
+        parsecache_set_budget(budget);
+        return 1;
+    }
+
+    pprintf(STDERR_FILENO, "usage: parsecache [-r | -s SIZE]\n");
+    return -1;
+}
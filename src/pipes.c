@@ -0,0 +1,250 @@
+/*
+ * pipes.c - Inter-stage pipes: capacity, packet mode and measurement relays
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/acct.h"
+#include "../include/arena.h"
+#include "../include/command.h"
+#include "../include/pipes.h"
+#include "../include/shell.h"
+
+/* MY_SHELL_PIPE, and the capacity ceiling read once from procfs */
+static struct pipe_opts pipe_defaults;
+static int pipe_max_size = -1;
+static int resize_warned;  // F_SETPIPE_SZ failures are reported once
+
+/* Helper: "64K", "1M", "1048576" in bytes, -1 if malformed or out of range */
+static long parse_size(const char *s, const char *end)
+{
+    char *num_end;
+    long n = strtol(s, &num_end, 10);
+    if (num_end == s || n <= 0)
+        return -1;
+    int shift = 0;
+    if (num_end < end) {
+        switch (*num_end++) {
+        case 'k': case 'K': shift = 10; break;
+        case 'm': case 'M': shift = 20; break;
+        case 'g': case 'G': shift = 30; break;
+        default: return -1;
+        }
+    }
+    if (num_end != end || n > (0x7fffffffL >> shift))
+        return -1;
+    return n << shift;
+}
+
+/* Helper: parse "SIZE,direct,stats" into o; returns 0 or -1 */
+static int parse_value(struct pipe_opts *o, const char *val)
+{
+    memset(o, 0, sizeof(*o));
+    o->set = 1;
+    while (*val) {
+        const char *end = strchrnul(val, ',');
+        size_t len = end - val;
+        if (len == 6 && strncmp(val, "direct", 6) == 0) {
+            o->direct = 1;
+        } else if (len == 5 && strncmp(val, "stats", 5) == 0) {
+            o->stats = 1;
+        } else {
+            long size = parse_size(val, end);
+            if (size < 0)
+                return -1;
+            o->size = size;
+        }
+        val = *end ? end + 1 : end;
+    }
+    return 0;
+}
+
+void pipes_init(void)
+{
+    const char *env = getenv(PIPE_ENV);
+    if (env && *env && parse_value(&pipe_defaults, env) < 0) {
+        pprintf(STDERR_FILENO, "%s: expected SIZE[K|M|G], direct or stats, comma-separated\n", PIPE_ENV);
+        memset(&pipe_defaults, 0, sizeof(pipe_defaults));
+    }
+}
+
+const struct pipe_opts *pipes_default(void)
+{
+    return &pipe_defaults;
+}
+
+/* Parse one word into o: 1 if it was @pipe=, 0 if not, -1 if invalid */
+int pipe_opts_parse(struct pipe_opts *o, const char *word)
+{
+    if (strncmp(word, "@pipe=", 6) != 0)
+        return 0;
+    if (parse_value(o, word + 6) == 0)
+        return 1;
+    pprintf(STDERR_FILENO, "%s: expected SIZE[K|M|G], direct or stats, comma-separated\n", word);
+    return -1;
+}
+
+/* Helper: the largest capacity an unprivileged process may ask for */
+static int max_size(void)
+{
+    if (pipe_max_size < 0) {
+        FILE *f = fopen(PIPE_MAX_SIZE_FILE, "re");
+        if (!f || fscanf(f, "%d", &pipe_max_size) != 1)
+            pipe_max_size = 1 << 20; /* the kernel's default ceiling */
+        if (f)
+            fclose(f);
+    }
+    return pipe_max_size;
+}
+
+/* Helper: one close-on-exec pipe with o's mode and capacity */
+static int make_pipe(const struct pipe_opts *o, int fds[2])
+{
+    if (pipe2(fds, O_CLOEXEC | (o->direct ? O_DIRECT : 0)) < 0) {
+        perror("pipe");
+        return -1;
+    }
+    if (o->size > 0) {
+        int size = o->size < max_size() ? o->size : max_size();
+        if (fcntl(fds[1], F_SETPIPE_SZ, size) < 0 && !resize_warned) {
+            /* pipe-user-pages-soft exhausted: keep the default capacity */
+            pprintf(STDERR_FILENO, "pipe: cannot resize to %d bytes: %s\n", size, strerror(errno));
+            resize_warned = 1;
+        }
+    }
+    return 0;
+}
+
+/* Helper: close every descriptor above stderr in a relay */
+static void close_from(int lowfd)
+{
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, lowfd, ~0U, 0) == 0)
+        return;
+#endif
+    long max = sysconf(_SC_OPEN_MAX);
+    for (int fd = lowfd; fd < max; fd++)
+        close(fd);
+}
+
+/* Helper: relay stdin to stdout with splice, timing how long the relay waits
+ * for data (the writer is slower) and for room (the reader is slower) */
+static void relay_run(int index, const char *from, const char *to)
+{
+    long long start = acct_now(), bytes = 0, empty_ns = 0, full_ns = 0;
+    int cap = fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+    struct pollfd in = {STDIN_FILENO, POLLIN, 0}, out = {STDOUT_FILENO, POLLOUT, 0};
+
+    for (;;) {
+        long long t = acct_now();
+        if (poll(&in, 1, -1) < 0 && errno != EINTR)
+            break;
+        empty_ns += acct_now() - t;
+
+        ssize_t n = splice(STDIN_FILENO, NULL, STDOUT_FILENO, NULL, cap > 0 ? cap : 65536,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            bytes += n;
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EINTR))
+            break; /* writer done, or reader gone */
+
+        t = acct_now();
+        if (poll(&out, 1, -1) < 0 && errno != EINTR)
+            break;
+        full_ns += acct_now() - t;
+        if (out.revents & POLLERR)
+            break;
+    }
+
+    double secs = (acct_now() - start) / 1e9;
+    char line[512];
+    int len = snprintf(line, sizeof(line),
+                       "pipe %d %s -> %s: %lld bytes in %.3fs (%.1f MiB/s), capacity %d, full %.3fs, empty %.3fs\n",
+                       index, from, to, bytes, secs, secs > 0 ? bytes / secs / (1 << 20) : 0.0, cap, full_ns / 1e9,
+                       empty_ns / 1e9);
+    (void) !write(STDERR_FILENO, line, len < (int) sizeof(line) ? len : (int) sizeof(line) - 1);
+}
+
+/* Helper: fork a relay from rd to wr in j's process group; returns its pid */
+static pid_t start_relay(struct job *j, const struct process *p, int rd, int wr)
+{
+    int index = 1;
+    for (const struct process *q = j->first; q != p; q = q->next)
+        index++;
+
+    pid_t pid = fork();
+    if (pid != 0)
+        return pid;
+
+    signal(SIGINT, SIG_DFL);
+    signal(SIGQUIT, SIG_DFL);
+    signal(SIGTSTP, SIG_DFL);
+    signal(SIGPIPE, SIG_IGN); /* report, then let the writer see EPIPE */
+    setpgid(0, j->pgid);
+    dup2(rd, STDIN_FILENO);
+    dup2(wr, STDOUT_FILENO);
+    close_from(STDERR_FILENO + 1);
+    relay_run(index, p->argc ? p->argv[0] : "?", p->next->argc ? p->next->argv[0] : "?");
+    _exit(EXIT_SUCCESS);
+}
+
+/* Create the pipe from p to p->next: p writes fds[1], p->next reads fds[0] */
+int pipe_open(struct job *j, const struct process *p, const struct pipe_opts *o, int fds[2])
+{
+    if (make_pipe(o, fds) < 0)
+        return -1;
+    if (!o->stats)
+        return 0;
+
+    /* writer -> fds -> relay -> out -> reader */
+    int out[2];
+    if (make_pipe(o, out) < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (!j->relays) {
+        int n = 0;
+        for (const struct process *q = j->first; q; q = q->next)
+            n++;
+        j->relays = arena_alloc(j->arena, n * sizeof(*j->relays));
+    }
+
+    pid_t pid = start_relay(j, p, fds[0], out[1]);
+    close(fds[0]);
+    close(out[1]);
+    if (pid < 0) {
+        perror("fork");
+        close(fds[1]);
+        close(out[0]);
+        return -1;
+    }
+    if (j->pgid == 0)
+        j->pgid = pid; /* the first relay may start before any stage */
+    setpgid(pid, j->pgid);
+    j->relays[j->nrelays++] = pid;
+    fds[0] = out[0];
+    return 0;
+}
+
+/* Wait for the relays of a finished foreground job, so their reports come
+ * before the next prompt */
+void pipe_relays_wait(struct job *j)
+{
+    for (int i = 0; i < j->nrelays; i++) {
+        while (waitpid(j->relays[i], NULL, 0) < 0 && errno == EINTR)
+            ;
+    }
+}
@@ -0,0 +1,220 @@
+/*
+ * proctree.c - Process tree snapshots from /proc
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/proctree.h"
+#include "../include/shell.h"
+
+/* Reused read buffer; stat lines and children lists fit comfortably */
+#define PROC_BUF 4096
+static char proc_buf[PROC_BUF];
+
+/* Helper: read a small /proc file relative to dir_fd into proc_buf */
+static ssize_t read_proc_file(int dir_fd, const char *path)
+{
+    int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    ssize_t n = read(fd, proc_buf, PROC_BUF - 1);
+    close(fd);
+    if (n < 0)
+        return -1;
+    proc_buf[n] = '\0';
+    return n;
+}
+
+/* Helper: parse "pid (comm) state ppid ..." from proc_buf. comm may contain
+ * spaces and parentheses, so ppid is located after the LAST ')'. */
+static pid_t parse_stat(ssize_t n, char *comm)
+{
+    char *open = memchr(proc_buf, '(', n);
+    char *close = memrchr(proc_buf, ')', n);
+    if (!open || !close || close < open || close + 4 > proc_buf + n)
+        return -1;
+    if (comm) {
+        size_t len = close - open - 1;
+        if (len >= COMM_LEN)
+            len = COMM_LEN - 1;
+        memcpy(comm, open + 1, len);
+        comm[len] = '\0';
+    }
+    /* skip ") S " */
+    return (pid_t) strtol(close + 4, NULL, 10);
+}
+
+pid_t proc_read_ppid(pid_t pid, char *comm)
+{
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    ssize_t n = read_proc_file(AT_FDCWD, path);
+    if (n <= 0)
+        return -1; /* process doesn't exist */
+    return parse_stat(n, comm);
+}
+
+/* Helper: numeric /proc entry name to pid, 0 if not a pid */
+static pid_t dirent_pid(const char *name)
+{
+    pid_t pid = 0;
+    for (; *name; name++) {
+        if (*name < '0' || *name > '9')
+            return 0;
+        pid = pid * 10 + (*name - '0');
+    }
+    return pid;
+}
+
+int proc_print_children(pid_t pid, int out_fd)
+{
+    char path[NAME_MAX + 16];
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    DIR *task_dir = opendir(path);
+    if (!task_dir)
+        return 0; /* no such process: no children */
+
+    /* collect every thread's children before printing, so a failure on a
+     * later thread leaves nothing behind for the caller's fallback to repeat */
+    int dir_fd = dirfd(task_dir);
+    struct dirent *entry;
+    pid_t *children = NULL;
+    size_t count = 0, cap = 0;
+    int ret = 0;
+    while ((entry = readdir(task_dir)) != NULL) {
+        if (!dirent_pid(entry->d_name))
+            continue;
+        snprintf(path, sizeof(path), "%s/children", entry->d_name);
+        ssize_t n = read_proc_file(dir_fd, path);
+        if (n < 0) {
+            ret = -1; /* kernel built without CONFIG_PROC_CHILDREN */
+            break;
+        }
+        /* space-separated list of child pids */
+        for (char *s = proc_buf; *s;) {
+            char *end;
+            long child = strtol(s, &end, 10);
+            if (end == s)
+                break;
+            if (count == cap) {
+                pid_t *grown = realloc(children, (cap = cap ? cap * 2 : 64) * sizeof(*children));
+                if (!grown) {
+                    ret = -1;
+                    break;
+                }
+                children = grown;
+            }
+            children[count++] = child;
+            s = end;
+        }
+        if (ret < 0)
+            break;
+    }
+    closedir(task_dir);
+
+    for (size_t i = 0; ret == 0 && i < count; i++)
+        pprintf(out_fd, "%d\n", children[i]);
+    free(children);
+    return ret;
+}
+
+/* Helper: insert node idx into the pid hash */
+static void index_insert(struct proc_tree *t, int idx)
+{
+    unsigned int h = (unsigned int) t->nodes[idx].pid * 2654435761u;
+    while (t->slots[h & t->slot_mask] >= 0)
+        h++;
+    t->slots[h & t->slot_mask] = idx;
+}
+
+int proctree_find(const struct proc_tree *t, pid_t pid)
+{
+    unsigned int h = (unsigned int) pid * 2654435761u;
+    int idx;
+    while ((idx = t->slots[h & t->slot_mask]) >= 0) {
+        if (t->nodes[idx].pid == pid)
+            return idx;
+        h++;
+    }
+    return -1;
+}
+
+int proctree_snapshot(struct proc_tree *t)
+{
+    memset(t, 0, sizeof(*t));
+    DIR *proc_dir = opendir("/proc");
+    if (!proc_dir) {
+        perror("opendir /proc");
+        return -1;
+    }
+
+    /* one pass: read every /proc/<pid>/stat relative to the /proc fd */
+    int dir_fd = dirfd(proc_dir);
+    struct dirent *entry;
+    char path[32];
+    while ((entry = readdir(proc_dir)) != NULL) {
+        pid_t pid = dirent_pid(entry->d_name);
+        if (pid <= 0)
+            continue;
+        snprintf(path, sizeof(path), "%d/stat", pid);
+        ssize_t n = read_proc_file(dir_fd, path);
+        if (n <= 0)
+            continue; /* exited meanwhile */
+
+        if (t->count == t->cap) {
+            t->cap = t->cap ? t->cap * 2 : 1024;
+            t->nodes = realloc(t->nodes, t->cap * sizeof(*t->nodes));
+        }
+        struct proc_node *node = &t->nodes[t->count];
+        node->pid = pid;
+        node->ppid = parse_stat(n, node->comm);
+        node->first_child = -1;
+        node->next_sibling = -1;
+        if (node->ppid >= 0)
+            t->count++;
+    }
+    closedir(proc_dir);
+
+    /* pid index sized to at most half full */
+    int size = 64;
+    while (size < t->count * 2)
+        size *= 2;
+    t->slots = malloc(size * sizeof(int));
+    memset(t->slots, -1, size * sizeof(int));
+    t->slot_mask = size - 1;
+    for (int i = 0; i < t->count; i++)
+        index_insert(t, i);
+
+    /* link children; walking backwards keeps siblings in /proc order */
+    for (int i = t->count - 1; i >= 0; i--) {
+        int parent = proctree_find(t, t->nodes[i].ppid);
+        if (parent < 0)
+            continue;
+        t->nodes[i].next_sibling = t->nodes[parent].first_child;
+        t->nodes[parent].first_child = i;
+    }
+    return 0;
+}
+
+void proctree_free(struct proc_tree *t)
+{
+    free(t->nodes);
+    free(t->slots);
+    memset(t, 0, sizeof(*t));
+}
+
+/* Print the subtree rooted at node idx, two spaces per level */
+void proctree_print(const struct proc_tree *t, int idx, int depth, int out_fd)
+{
+    const struct proc_node *node = &t->nodes[idx];
+    pprintf(out_fd, "%*s%d %s\n", depth * 2, "", node->pid, node->comm);
+    for (int c = node->first_child; c >= 0; c = t->nodes[c].next_sibling)
+        proctree_print(t, c, depth + 1, out_fd);
+}
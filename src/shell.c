@@ -3,23 +3,33 @@
  */
 
 #define _GNU_SOURCE
-#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <pwd.h>
 #include <signal.h>
-#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include "../include/acct.h"
 #include "../include/builtin.h"
 #include "../include/command.h"
+#include "../include/exec.h"
+#include "../include/fastpath.h"
+#include "../include/history.h"
+#include "../include/jobs.h"
+#include "../include/parsecache.h"
+#include "../include/pipes.h"
+#include "../include/proctree.h"
 #include "../include/shell.h"
+#include "../include/stats.h"
+#include "../include/supervise.h"
+#include "../include/trace.h"
 
 /* Global shell state */
 struct shell_info shell;
@@ -32,32 +42,33 @@ void update_cwd()
     }
 }
 
-/* Helper: write to fd or stdout interchangeably */
-void pprintf(int fd, const char *fmt, ...)
-{
-    va_list ap;
-    va_start(ap, fmt);
-    if (fd == STDOUT_FILENO) {
-        vprintf(fmt, ap);
-    } else {
-        vdprintf(fd, fmt, ap);
-    }
-    va_end(ap);
-}
-
 /* Initialize shell: set pgid, ignore signals, load user info */
 void shell_init()
 {
+    /* builtin output still queued at exit must not be lost */
+    atexit(out_flush_all);
+
     /* ignore interactive signals */
     signal(SIGINT, SIG_IGN);
     signal(SIGQUIT, SIG_IGN);
     signal(SIGTSTP, SIG_IGN);
     signal(SIGTTIN, SIG_IGN);
 
-    /* set process group */
-    pid_t pid = getpid();
-    setpgid(pid, pid);
-    tcsetpgrp(STDIN_FILENO, pid);
+    /* take over the terminal only when there is one */
+    shell.interactive = isatty(STDIN_FILENO);
+    if (shell.interactive) {
+        pid_t pid = getpid();
+        setpgid(pid, pid);
+        tcsetpgrp(STDIN_FILENO, pid);
+    }
+
+    /* choose how external commands are launched; the fork server goes first,
+     * while the shell has no history map or caches for it to inherit */
+    shell.spawn_mode = spawn_mode_from_env();
+    if (shell.spawn_mode == SPAWN_ZYGOTE && zygote_start() < 0) {
+        perror("zygote");
+        shell.spawn_mode = SPAWN_POSIX;
+    }
 
     /* load user info */
     struct passwd *pw = getpwuid(getuid());
@@ -65,86 +76,71 @@ void shell_init()
     getlogin_r(shell.user, TOK_LEN);
     update_cwd();
 
-    /* clear job slots */
-    for (int i = 0; i <= MAX_JOBS; i++)
-        shell.jobs[i] = NULL;
+    /* map the history store */
+    history_init();
+
+    fastpath_init();
+    pipes_init();
+    parsecache_init();
+    acct_init();
+    stats_init();
+#ifdef SHELL_TRACE
+    trace_init();
+#endif
+
+    /* reap background jobs as they finish */
+    jobs_init();
 }
 
-/* Print shell prompt (with current directory) */
-void print_prompt()
+/* Shell prompt text (with current directory) */
+const char *shell_prompt(void)
 {
-    pprintf(STDOUT_FILENO, "%s:%s >>> $ ", shell.user, shell.cwd);
+    static char prompt[TOK_LEN + PATH_LEN + 8];
+    snprintf(prompt, sizeof(prompt), "%s:%s >>> $ ", shell.user, shell.cwd);
+    return prompt;
 }
 
-/* Add command line to history buffer */
-void add_history(const char *line)
+/* Print shell prompt */
+void print_prompt()
 {
-    if (*line == '\0')
-        return;
-    if (history_count < MAX_HISTORY) {
-        strcpy(history[history_count++], line);
-    } else {
-        /* shift oldest out */
-        memmove(history, history + 1, (MAX_HISTORY - 1) * LINE_LEN);
-        strcpy(history[MAX_HISTORY - 1], line);
-    }
+    pputs(STDOUT_FILENO, shell_prompt(), strlen(shell_prompt()));
+    out_flush(STDOUT_FILENO);
 }
 
 /* Helper: get parent PID from /proc/<pid>/stat */
 pid_t get_parent_pid(pid_t pid)
 {
-    char path[256];
-    char line[1024];
-    pid_t ppid = 0;
-
-    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
-    FILE *fp = fopen(path, "r");
-    if (!fp) {
-        return -1; /* process doesn't exist */
-    }
-
-    if (fgets(line, sizeof(line), fp)) {
-        /* Parse stat file format: pid (comm) state ppid ... */
-        char *token, *saveptr;
-        int field = 0;
-
-        for (token = strtok_r(line, " ", &saveptr); token; token = strtok_r(NULL, " ", &saveptr)) {
-            field++;
-            if (field == 4) { /* 4th field is ppid */
-                ppid = atoi(token);
-                break;
-            }
-        }
-    }
-
-    fclose(fp);
-    return ppid;
+    return proc_read_ppid(pid, NULL);
 }
 
 /* Helper: find all child processes of given PID */
 void find_children(pid_t parent_pid, int out_fd)
 {
-    DIR *proc_dir;
-    struct dirent *entry;
-    pid_t pid;
-
-    proc_dir = opendir("/proc");
-    if (!proc_dir) {
-        perror("opendir /proc");
+    /* O(children) when the kernel exposes task/<tid>/children */
+    if (proc_print_children(parent_pid, out_fd) == 0)
         return;
-    }
 
-    while ((entry = readdir(proc_dir)) != NULL) {
-        /* Check if directory name is a number (PID) */
-        if (strspn(entry->d_name, "0123456789") == strlen(entry->d_name)) {
-            pid = atoi(entry->d_name);
-            if (pid > 0 && get_parent_pid(pid) == parent_pid) {
-                pprintf(out_fd, "%d\n", pid);
-            }
-        }
-    }
+    /* otherwise index the whole process table once */
+    struct proc_tree tree;
+    if (proctree_snapshot(&tree) < 0)
+        return;
+    int idx = proctree_find(&tree, parent_pid);
+    for (int c = idx >= 0 ? tree.nodes[idx].first_child : -1; c >= 0; c = tree.nodes[c].next_sibling)
+        pprintf(out_fd, "%d\n", tree.nodes[c].pid);
+    proctree_free(&tree);
+}
 
-    closedir(proc_dir);
+/* Helper: print the process tree rooted at PID */
+int print_proc_tree(pid_t root_pid, int out_fd)
+{
+    struct proc_tree tree;
+    if (proctree_snapshot(&tree) < 0)
+        return -1;
+    int idx = proctree_find(&tree, root_pid);
+    if (idx >= 0)
+        proctree_print(&tree, idx, 0, out_fd);
+    proctree_free(&tree);
+    return idx >= 0 ? 0 : -1;
 }
 
 /* Launch a single process, handling built-in or exec */
@@ -154,6 +150,7 @@ int launch_process(struct job *j, struct process *p, int in_fd, int out_fd)
     int infile_fd = in_fd;
     int outfile_fd = out_fd;
 
+    TRACE_BEGIN(t_redirect);
     if (p->infile) {
         infile_fd = open(p->infile, O_RDONLY);
         if (infile_fd < 0) {
@@ -171,53 +168,63 @@ int launch_process(struct job *j, struct process *p, int in_fd, int out_fd)
             return -1;
         }
     }
+    if (p->infile || p->outfile)
+        TRACE_END(t_redirect, "redirect", p->raw_cmd);
 
     /* built-in command ----- */
-    if (p->type != CMD_EXTERNAL) {
-        /* find function and call */
-        for (int i = 0; i < num_builtins; i++) {
-            if (builtins[i].id == p->type) {
-                int ret = builtins[i].func(p, infile_fd, outfile_fd);
-                /* close redirected files */
-                if (p->infile && infile_fd != in_fd)
-                    close(infile_fd);
-                if (p->outfile && outfile_fd != out_fd)
-                    close(outfile_fd);
-                return ret;
-            }
-        }
-    }
-
-    /* external command ----- */
-    pid_t pid = fork();
-    if (pid == 0) {
-        /* child resets signals and I/O */
-        signal(SIGINT, SIG_DFL);
-        signal(SIGQUIT, SIG_DFL);
-        signal(SIGTSTP, SIG_DFL);
-        signal(SIGTTIN, SIG_DFL);
-        signal(SIGTTOU, SIG_DFL);
-
-        /* set up input/output redirection */
-        if (infile_fd != STDIN_FILENO) {
-            dup2(infile_fd, STDIN_FILENO);
+    builtin_fn fn = (p->builtin ? p->builtin->func : NULL);
+
+    /* a final foreground builtin runs in the shell itself, so cd/exit work;
+     * a fast path only when its input cannot block the shell (see
+     * fastpath_in_shell()), and a stage with @-prefixes never, so they do not
+     * apply to the shell */
+    int in_shell = (fn && !p->next && j->mode == FG_EXEC && !p->sched.flags);
+    if (in_shell && p->type == CMD_FASTPATH && !fastpath_in_shell(p, infile_fd, p != j->first && !p->infile))
+        in_shell = 0;
+    if (in_shell) {
+        struct rusage before;
+        getrusage(RUSAGE_SELF, &before);
+        p->acct.start_ns = acct_now();
+        stats_builtin(p->type);
+        int ret = fn(p, infile_fd, outfile_fd);
+        out_flush_all();
+        acct_self(p, &before);
+        p->acct.status = W_EXITCODE(ret < 0, 0); /* as a forked builtin would exit */
+        TRACE_END(p->acct.start_ns, "builtin", p->raw_cmd);
+        /* close redirected files */
+        if (p->infile && infile_fd != in_fd)
             close(infile_fd);
-        }
-        if (outfile_fd != STDOUT_FILENO) {
-            dup2(outfile_fd, STDOUT_FILENO);
+        if (p->outfile && outfile_fd != out_fd)
             close(outfile_fd);
-        }
+        return ret;
+    }
 
-        execvp(p->argv[0], p->argv);
-        perror("execvp");
-        exit(EXIT_FAILURE);
+    /* external command or piped/background builtin ----- */
+    out_flush_all(); /* keep shell output ahead of the child's */
+    pid_t pid = 0;
+    p->acct.start_ns = acct_now();
+    stage_sched_resolve(&p->sched);
+    if (fn) {
+        stats_builtin(p->type);
+        pid = spawn_builtin(j, p, fn, infile_fd, outfile_fd);
     }
+    else if (p->argc > 0)
+        pid = spawn_process(j, p, infile_fd, outfile_fd);
+    p->acct.spawn_ns = acct_now() - p->acct.start_ns;
+    TRACE_END(p->acct.start_ns, "spawn", p->raw_cmd);
 
     /* parent process */
-    p->pid = pid;
-    if (j->pgid == 0)
-        j->pgid = pid;
-    setpgid(pid, j->pgid);
+    if (pid > 0) {
+        stats_add(STAT_PROCESSES);
+        stats_time(HIST_SPAWN, p->acct.spawn_ns);
+        p->pid = pid;
+        if (j->pgid == 0)
+            j->pgid = pid;
+        setpgid(pid, j->pgid);
+    } else {
+        /* nothing to run or launch failed: let the rest of the pipeline go on */
+        p->state = PROC_DONE;
+    }
 
     /* close redirected files in parent */
     if (p->infile && infile_fd != in_fd)
@@ -228,52 +235,65 @@ int launch_process(struct job *j, struct process *p, int in_fd, int out_fd)
     return 0;
 }
 
-/* Find an available job slot */
-int get_job_id()
+/* Launch all processes in a job (pipeline), handle fg/bg */
+/* Helper: $? after foreground job j: the last stage's exit code, 128 plus the
+ * signal that killed it, or 2 for a line the parser rejected */
+static void job_status(const struct job *j)
 {
-    for (int i = 1; i <= MAX_JOBS; i++) {
-        if (shell.jobs[i] == NULL)
-            return i;
+    const struct process *p = j->first;
+    if (!p) {
+        shell.last_status = 2;
+        return;
     }
-    return -1; /* no available slots */
+    while (p->next)
+        p = p->next;
+    int status = p->acct.status;
+    shell.last_status = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
 }
 
-/* Launch all processes in a job (pipeline), handle fg/bg */
 int launch_job(struct job *j)
 {
     struct process *p;
     int pipe_fd[2];
     int in_fd = STDIN_FILENO;
     pid_t rightmost_pid = 0;
+    const struct pipe_opts *pipe_opts = pipes_default();
 
-    /* get job id for background jobs */
-    if (j->mode == BG_EXEC) {
-        j->id = get_job_id();
-        if (j->id > 0) {
-            shell.jobs[j->id] = j;
-        }
+    j->start_ns = acct_now();
+    if (j->first) { /* not for lines rejected by the parser */
+        stats_add(STAT_JOBS);
+        if (j->mode == BG_EXEC)
+            stats_add(STAT_BG_JOBS);
     }
 
     /* launch each process in the pipeline */
     for (p = j->first; p; p = p->next) {
         int out_fd;
 
+        /* @pipe= holds for this pipe and the ones after it */
+        if (p->pipe.set)
+            pipe_opts = &p->pipe;
+
         /* determine output fd */
         if (p->next) {
-            /* not the last process, create pipe */
-            if (pipe(pipe_fd) < 0) {
-                perror("pipe");
+            /* not the last process, create pipe; close-on-exec keeps the
+             * read end out of the writer, or it would never see SIGPIPE */
+            TRACE_BEGIN(t_pipe);
+            if (pipe_open(j, p, pipe_opts, pipe_fd) < 0)
                 return -1;
-            }
+            TRACE_END(t_pipe, "pipe", NULL);
             out_fd = pipe_fd[1];
+            j->pipe_rd = pipe_fd[0];
         } else {
             /* last process uses stdout */
             out_fd = STDOUT_FILENO;
+            j->pipe_rd = -1;
             rightmost_pid = 0; /* will be set after launch_process */
         }
 
         /* launch the process */
         if (launch_process(j, p, in_fd, out_fd) < 0) {
+            shell.last_status = 1;
             if (p->next) {
                 close(pipe_fd[0]);
                 close(pipe_fd[1]);
@@ -285,6 +305,8 @@ int launch_job(struct job *j)
         if (!p->next) {
             rightmost_pid = p->pid;
         }
+        if (p->pid > 0)
+            j->running++;
 
         /* close write end of pipe in parent, setup next input */
         if (p->next) {
@@ -302,20 +324,27 @@ int launch_job(struct job *j)
     /* handle foreground vs background execution */
     if (j->mode == FG_EXEC) {
         /* foreground: wait for all processes to complete */
-        int status;
-        for (p = j->first; p; p = p->next) {
-            if (p->type == CMD_EXTERNAL) {
-                waitpid(p->pid, &status, 0);
-            }
-        }
+        TRACE_BEGIN(t_wait);
+        supervise_job(j, -1);
+        pipe_relays_wait(j);
+        stats_time(HIST_WAIT, acct_now() - j->start_ns);
+        TRACE_END(t_wait, "wait", NULL);
+        acct_report(j);
+        job_status(j);
     } else {
-        /* background: print rightmost pid and job info */
+        shell.last_status = 0;
+        /* background: the SIGCHLD reaper frees the job once it finishes */
+        if (j->running > 0)
+            job_add(j);
+
+        /* print rightmost pid and job info */
         if (rightmost_pid > 0) {
             pprintf(STDOUT_FILENO, "%d\n", rightmost_pid);
         }
         if (j->id > 0) {
             pprintf(STDOUT_FILENO, "[%d] %d\n", j->id, j->pgid);
         }
+        out_flush(STDOUT_FILENO);
     }
 
     return 0;
@@ -0,0 +1,273 @@
+/*
+ * stats.c - Exported shell metrics and the stats builtin
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/builtin.h"
+#include "../include/shell.h"
+#include "../include/stats.h"
+
+static struct shell_stats stats_local;
+struct shell_stats *stats = &stats_local;
+static char stats_path[PATH_LEN];  // exported file, empty if none
+
+static const char *const stat_names[NUM_STATS] = {
+    [STAT_LINES] = "lines",
+    [STAT_PARSE_ERRORS] = "parse_errors",
+    [STAT_JOBS] = "jobs",
+    [STAT_BG_JOBS] = "bg_jobs",
+    [STAT_BG_DONE] = "bg_done",
+    [STAT_PROCESSES] = "processes",
+    [STAT_NOT_FOUND] = "not_found",
+    [STAT_SPAWN_FAILURES] = "spawn_failures",
+};
+
+static const char *const hist_names[NUM_HISTS] = {
+    [HIST_PARSE] = "parse",
+    [HIST_SPAWN] = "spawn",
+    [HIST_WAIT] = "wait",
+};
+
+/* Helper: the file goes with the shell, not with a child that calls exit() */
+static void stats_unlink(void)
+{
+    if (stats->pid == getpid())
+        unlink(stats_path);
+}
+
+/* Helper: map path as the exported block; returns the mapping or MAP_FAILED */
+static void *map_file(const char *path)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return MAP_FAILED;
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, sizeof(struct shell_stats)) == 0)
+        map = mmap(NULL, sizeof(struct shell_stats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (map == MAP_FAILED)
+        unlink(path);
+    errno = err;
+    return map;
+}
+
+/* Helper: remove the files of shells in dir that died without cleaning up */
+static void remove_stale(const char *dir)
+{
+    DIR *d = opendir(dir);
+    if (!d)
+        return;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        int pid, end = 0;
+        if (sscanf(e->d_name, "my_shell.%d.stats%n", &pid, &end) == 1 && e->d_name[end] == '\0' && pid > 0 &&
+            kill(pid, 0) < 0 && errno == ESRCH)
+            unlinkat(dirfd(d), e->d_name, 0);
+    }
+    closedir(d);
+}
+
+void stats_init(void)
+{
+    const char *env = getenv(STATS_ENV);
+    int on = env && strcmp(env, "on") == 0;
+    if (on || ((!env || !*env) && shell.interactive)) {
+        /* one file per shell in the runtime directory */
+        const char *dir = getenv("XDG_RUNTIME_DIR");
+        char run_dir[64];
+        if (!dir || !*dir) {
+            snprintf(run_dir, sizeof(run_dir), "/run/user/%d", (int) getuid());
+            dir = run_dir;
+        }
+        remove_stale(dir);
+        snprintf(stats_path, sizeof(stats_path), "%s/my_shell.%d.stats", dir, (int) getpid());
+    } else if (env && *env && strcmp(env, "off") != 0) {
+        snprintf(stats_path, sizeof(stats_path), "%s", env);
+    }
+
+    void *map = MAP_FAILED;
+    if (stats_path[0]) {
+        map = map_file(stats_path);
+        if (map == MAP_FAILED) {
+            if (env && *env) /* no runtime directory is not worth a warning */
+                pprintf(STDERR_FILENO, "%s: %s: %s\n", STATS_ENV, stats_path, strerror(errno));
+            stats_path[0] = '\0';
+        }
+    }
+    /* shared even without a file, so forked builtins see the shell's figures */
+    if (map == MAP_FAILED)
+        map = mmap(NULL, sizeof(struct shell_stats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED)
+        return;
+
+    struct shell_stats *s = map;
+    *s = *stats;
+    s->version = STATS_VERSION;
+    s->size = sizeof(*s);
+    s->pid = getpid();
+    s->start = time(NULL);
+    __atomic_store_n(&s->magic, STATS_MAGIC, __ATOMIC_RELEASE); /* header complete */
+    stats = s;
+    if (stats_path[0])
+        atexit(stats_unlink);
+}
+
+/* Helper: copy the live block word by word */
+static void snapshot(struct shell_stats *out)
+{
+    *out = (struct shell_stats){.pid = stats->pid, .start = stats->start};
+    for (int i = 0; i < NUM_STATS; i++)
+        out->counters[i] = __atomic_load_n(&stats->counters[i], __ATOMIC_RELAXED);
+    for (int i = 0; i < STATS_CMD_IDS; i++)
+        out->builtins[i] = __atomic_load_n(&stats->builtins[i], __ATOMIC_RELAXED);
+    for (int h = 0; h < NUM_HISTS; h++) {
+        const struct stats_hist *src = &stats->hist[h];
+        struct stats_hist *dst = &out->hist[h];
+        dst->count = __atomic_load_n(&src->count, __ATOMIC_RELAXED);
+        dst->sum_ns = __atomic_load_n(&src->sum_ns, __ATOMIC_RELAXED);
+        dst->max_ns = __atomic_load_n(&src->max_ns, __ATOMIC_RELAXED);
+        for (int b = 0; b < STATS_BUCKETS; b++)
+            dst->buckets[b] = __atomic_load_n(&src->buckets[b], __ATOMIC_RELAXED);
+    }
+}
+
+/* Helper: zero the counters and histograms, keeping the header */
+static void reset(void)
+{
+    for (int i = 0; i < NUM_STATS; i++)
+        __atomic_store_n(&stats->counters[i], 0, __ATOMIC_RELAXED);
+    for (int i = 0; i < STATS_CMD_IDS; i++)
+        __atomic_store_n(&stats->builtins[i], 0, __ATOMIC_RELAXED);
+    for (int h = 0; h < NUM_HISTS; h++) {
+        struct stats_hist *s = &stats->hist[h];
+        __atomic_store_n(&s->count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->sum_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->max_ns, 0, __ATOMIC_RELAXED);
+        for (int b = 0; b < STATS_BUCKETS; b++)
+            __atomic_store_n(&s->buckets[b], 0, __ATOMIC_RELAXED);
+    }
+}
+
+/* Helper: name of builtin id, NULL for ids without one */
+static const char *builtin_name(int id)
+{
+    if (id == CMD_DYNAMIC)
+        return "loaded";
+    if (id == CMD_FASTPATH)
+        return "fastpath";
+    for (int i = 0; i < num_builtins; i++) {
+        if (builtins[i].id == id)
+            return builtins[i].name;
+    }
+    return NULL;
+}
+
+/* Helper: upper bound in us of the bucket holding quantile q */
+static uint64_t quantile_us(const struct stats_hist *h, double q)
+{
+    if (!h->count)
+        return 0;
+    uint64_t rank = (uint64_t) (q * (h->count - 1)), seen = 0;
+    int b;
+    for (b = 0; b < STATS_BUCKETS - 1; b++) {
+        seen += h->buckets[b];
+        if (seen > rank)
+            break;
+    }
+    return 1ull << b;
+}
+
+static void print_human(const struct shell_stats *s, int out_fd)
+{
+    pprintf(out_fd, "stats: pid %d, up %llds, %s%s\n", (int) s->pid, (long long) (time(NULL) - s->start),
+            stats_path[0] ? "exported to " : "not exported", stats_path);
+    for (int i = 0; i < NUM_STATS; i++)
+        pprintf(out_fd, "%-16s %10llu\n", stat_names[i], (unsigned long long) s->counters[i]);
+    pprintf(out_fd, "%-16s %10llu\n", "bg_running",
+            (unsigned long long) (s->counters[STAT_BG_JOBS] - s->counters[STAT_BG_DONE]));
+
+    int any = 0;
+    for (int id = 0; id < STATS_CMD_IDS; id++) {
+        const char *name = builtin_name(id);
+        if (!name || !s->builtins[id])
+            continue;
+        pprintf(out_fd, "%s %s %llu", any ? "," : "builtins:", name, (unsigned long long) s->builtins[id]);
+        any = 1;
+    }
+    if (any)
+        pputs(out_fd, "\n", 1);
+
+    /* percentiles are bucket upper bounds, hence powers of two */
+    pprintf(out_fd, "%-8s %10s %10s %10s %10s %10s\n", "latency", "count", "mean us", "p50 us", "p99 us", "max us");
+    for (int h = 0; h < NUM_HISTS; h++) {
+        const struct stats_hist *hs = &s->hist[h];
+        pprintf(out_fd, "%-8s %10llu %10.1f %10llu %10llu %10.1f\n", hist_names[h], (unsigned long long) hs->count,
+                hs->count ? hs->sum_ns / 1e3 / hs->count : 0.0, (unsigned long long) quantile_us(hs, 0.5),
+                (unsigned long long) quantile_us(hs, 0.99), hs->max_ns / 1e3);
+    }
+}
+
+static void print_json(const struct shell_stats *s, int out_fd)
+{
+    pprintf(out_fd, "{\"pid\":%d,\"uptime_s\":%lld,\"counters\":{", (int) s->pid, (long long) (time(NULL) - s->start));
+    for (int i = 0; i < NUM_STATS; i++)
+        pprintf(out_fd, "%s\"%s\":%llu", i ? "," : "", stat_names[i], (unsigned long long) s->counters[i]);
+
+    pputs(out_fd, "},\"builtins\":{", 14);
+    int any = 0;
+    for (int id = 0; id < STATS_CMD_IDS; id++) {
+        const char *name = builtin_name(id);
+        if (!name)
+            continue;
+        pprintf(out_fd, "%s\"%s\":%llu", any ? "," : "", name, (unsigned long long) s->builtins[id]);
+        any = 1;
+    }
+
+    pputs(out_fd, "},\"histograms\":{", 16);
+    for (int h = 0; h < NUM_HISTS; h++) {
+        const struct stats_hist *hs = &s->hist[h];
+        pprintf(out_fd, "%s\"%s\":{\"count\":%llu,\"sum_ns\":%llu,\"max_ns\":%llu,\"p50_us\":%llu,\"p99_us\":%llu,\"buckets\":[",
+                h ? "," : "", hist_names[h], (unsigned long long) hs->count, (unsigned long long) hs->sum_ns,
+                (unsigned long long) hs->max_ns, (unsigned long long) quantile_us(hs, 0.5),
+                (unsigned long long) quantile_us(hs, 0.99));
+        for (int b = 0; b < STATS_BUCKETS; b++)
+            pprintf(out_fd, "%s%llu", b ? "," : "", (unsigned long long) hs->buckets[b]);
+        pputs(out_fd, "]}", 2);
+    }
+    pputs(out_fd, "}}\n", 3);
+}
+
+/* Built-in: stats [-j | -r] - show the shell's metrics, as JSON, or reset them */
+int cmd_stats(struct process *proc, int in_fd, int out_fd)
+{
+    (void) in_fd;
+
+    if (proc->argc > 2 || (proc->argc == 2 && strcmp(proc->argv[1], "-j") != 0 && strcmp(proc->argv[1], "-r") != 0)) {
+        pprintf(STDERR_FILENO, "usage: stats [-j | -r]\n");
+        return -1;
+    }
+    if (proc->argc == 2 && proc->argv[1][1] == 'r') {
+        reset();
+        return 1;
+    }
+
+    struct shell_stats snap;
+    snapshot(&snap);
+    if (proc->argc == 2)
+        print_json(&snap, out_fd);
+    else
+        print_human(&snap, out_fd);
+    return 1;
+}
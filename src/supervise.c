@@ -0,0 +1,450 @@
+/*
+ * supervise.c - pidfd/epoll process supervisor, timeout and wait built-ins
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/acct.h"
+#include "../include/builtin.h"
+#include "../include/command.h"
+#include "../include/exec.h"
+#include "../include/fastpath.h"
+#include "../include/jobs.h"
+#include "../include/shell.h"
+#include "../include/supervise.h"
+
+/* epoll tags: fixed sources first, then one per entry */
+enum {
+    SV_TAG_TIMER,
+    SV_TAG_TTY,
+    SV_TAG_SIGCHLD,
+    SV_TAG_FIRST,  // entries[tag - SV_TAG_FIRST]
+};
+
+/* Helper: pidfd_open(2), failing with ENOSYS where the headers predate it */
+static int pidfd_open_pid(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    return syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void) pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/* Helper: add fd to the epoll set under tag */
+static int sv_add(struct supervisor *sv, int fd, uint32_t events, uint64_t tag)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u64 = tag;
+    return epoll_ctl(sv->epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+/* Set up sv; returns 0 or -1 */
+int sv_open(struct supervisor *sv)
+{
+    memset(sv, 0, sizeof(*sv));
+    sv->timerfd = -1;
+    sv->sigchld = -1;
+    sv->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (sv->epfd < 0) {
+        perror("epoll_create1");
+        return -1;
+    }
+
+    /* no events requested: a terminal only ever reports its hangup */
+    if (isatty(STDIN_FILENO) && sv_add(sv, STDIN_FILENO, 0, SV_TAG_TTY) == 0)
+        sv->tty = 1;
+    return 0;
+}
+
+/* Release every descriptor held by sv */
+void sv_close(struct supervisor *sv)
+{
+    for (int i = 0; i < sv->n; i++) {
+        if (sv->entries[i].pidfd >= 0)
+            close(sv->entries[i].pidfd);
+    }
+    free(sv->entries);
+    if (sv->timerfd >= 0)
+        close(sv->timerfd);
+    close(sv->epfd);
+}
+
+/* Watch p (pid > 0) until it exits; returns 0 or -1 */
+int sv_watch(struct supervisor *sv, struct process *p)
+{
+    if (sv->n == sv->cap) {
+        int cap = sv->cap ? sv->cap * 2 : 8;
+        struct sv_entry *entries = realloc(sv->entries, cap * sizeof(*entries));
+        if (!entries)
+            return -1;
+        sv->entries = entries;
+        sv->cap = cap;
+    }
+
+    struct sv_entry *e = &sv->entries[sv->n];
+    e->p = p;
+    e->pidfd = pidfd_open_pid(p->pid);
+    if (e->pidfd >= 0) {
+        if (sv_add(sv, e->pidfd, EPOLLIN, SV_TAG_FIRST + sv->n) < 0) {
+            close(e->pidfd);
+            return -1;
+        }
+    } else if (sv->sigchld < 0) {
+        /* no pidfds: wake up on SIGCHLD and poll each process instead */
+        int fd = jobs_sigchld_fd();
+        if (fd < 0 || sv_add(sv, fd, EPOLLIN, SV_TAG_SIGCHLD) < 0)
+            return -1;
+        sv->sigchld = fd;
+    }
+
+    sv->n++;
+    sv->live++;
+    return 0;
+}
+
+/* Arm the deadline ms milliseconds from now, ms < 0 disarms it */
+int sv_deadline(struct supervisor *sv, long ms)
+{
+    if (sv->timerfd < 0) {
+        sv->timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+        if (sv->timerfd < 0 || sv_add(sv, sv->timerfd, EPOLLIN, SV_TAG_TIMER) < 0) {
+            perror("timerfd");
+            return -1;
+        }
+    }
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (ms >= 0) {
+        its.it_value.tv_sec = ms / 1000;
+        its.it_value.tv_nsec = (ms % 1000) * 1000000 + 1; /* an all-zero value would disarm */
+    }
+    return timerfd_settime(sv->timerfd, 0, &its, NULL);
+}
+
+/* Helper: stop watching an exited entry */
+static void sv_drop(struct supervisor *sv, struct sv_entry *e)
+{
+    if (e->pidfd >= 0) {
+        epoll_ctl(sv->epfd, EPOLL_CTL_DEL, e->pidfd, NULL);
+        close(e->pidfd);
+        e->pidfd = -1;
+    }
+    e->p = NULL;
+    sv->live--;
+}
+
+/* Helper: reap e if it exited; a process that is not our child (we are a
+ * forked built-in) cannot be reaped and counts as exited once it is gone */
+static int sv_reap(struct supervisor *sv, struct sv_entry *e, struct process **pp, int *status)
+{
+    struct rusage ru;
+    pid_t r = wait4(e->p->pid, status, WNOHANG, &ru);
+    if (r == 0)
+        return 0;
+    if (r < 0)
+        *status = 0;
+    acct_exit(e->p, *status, r > 0 ? &ru : NULL);
+    *pp = e->p;
+    sv_drop(sv, e);
+    return 1;
+}
+
+/* Block until the next event; SV_EXITED reaps the process */
+int sv_next(struct supervisor *sv, struct process **pp, int *status)
+{
+    for (;;) {
+        if (!sv->live)
+            return SV_ERROR;
+
+        /* fallback entries are checked before every sleep, so an exit that
+         * raced with the last drain of the SIGCHLD pipe is not lost */
+        if (sv->sigchld >= 0) {
+            for (int i = 0; i < sv->n; i++) {
+                struct sv_entry *e = &sv->entries[i];
+                if (e->p && e->pidfd < 0 && sv_reap(sv, e, pp, status))
+                    return SV_EXITED;
+            }
+        }
+
+        struct epoll_event ev;
+        if (epoll_wait(sv->epfd, &ev, 1, -1) < 0) {
+            if (errno == EINTR)
+                continue; /* SIGCHLD itself */
+            perror("epoll_wait");
+            return SV_ERROR;
+        }
+
+        if (ev.data.u64 == SV_TAG_TIMER) {
+            uint64_t ticks;
+            (void) !read(sv->timerfd, &ticks, sizeof(ticks));
+            return SV_TIMEOUT;
+        }
+        if (ev.data.u64 == SV_TAG_TTY) {
+            epoll_ctl(sv->epfd, EPOLL_CTL_DEL, STDIN_FILENO, NULL); /* stays hung up */
+            sv->tty = 0;
+            return SV_HANGUP;
+        }
+        if (ev.data.u64 == SV_TAG_SIGCHLD) {
+            char buf[64];
+            while (read(sv->sigchld, buf, sizeof(buf)) > 0)
+                ;
+            continue;
+        }
+
+        struct sv_entry *e = &sv->entries[ev.data.u64 - SV_TAG_FIRST];
+        if (e->p && sv_reap(sv, e, pp, status))
+            return SV_EXITED;
+    }
+}
+
+/* Helper: plain blocking wait for processes the supervisor could not watch */
+static void wait_each(struct job *j)
+{
+    int status;
+    struct rusage ru;
+    for (struct process *p = j->first; p; p = p->next) {
+        if (p->pid > 0 && p->state == PROC_RUNNING && wait4(p->pid, &status, 0, &ru) == p->pid) {
+            acct_exit(p, status, &ru);
+            p->state = WIFSIGNALED(status) ? PROC_TERMINATED : PROC_DONE;
+            j->running--;
+        }
+    }
+}
+
+/* Wait for every launched process of foreground job j, killing its group
+ * on the deadline; returns 1 if the deadline was hit */
+int supervise_job(struct job *j, long timeout_ms)
+{
+    if (!j->running)
+        return 0; /* builtins only: spare the epoll set */
+
+    struct supervisor sv;
+    if (sv_open(&sv) < 0) {
+        wait_each(j);
+        return 0;
+    }
+
+    /* a process that cannot be watched (no fds left) is waited for last */
+    for (struct process *p = j->first; p; p = p->next) {
+        if (p->pid > 0)
+            sv_watch(&sv, p);
+    }
+    if (timeout_ms >= 0 && sv.live)
+        sv_deadline(&sv, timeout_ms);
+
+    int timed_out = 0;
+    struct process *p;
+    int status;
+    for (;;) {
+        int ev = sv_next(&sv, &p, &status);
+        if (ev == SV_EXITED) {
+            p->state = WIFSIGNALED(status) ? PROC_TERMINATED : PROC_DONE;
+            j->running--;
+        } else if (ev == SV_TIMEOUT && j->pgid > 0) {
+            /* ask first, then insist once the grace period is over */
+            kill(-j->pgid, timed_out ? SIGKILL : SIGTERM);
+            if (!timed_out)
+                sv_deadline(&sv, SV_KILL_GRACE_MS);
+            timed_out = 1;
+        } else if (ev == SV_HANGUP && j->pgid > 0) {
+            kill(-j->pgid, SIGHUP);
+        } else if (ev == SV_ERROR) {
+            break;
+        }
+    }
+
+    sv_close(&sv);
+    wait_each(j);
+    return timed_out;
+}
+
+/* Helper: parse a duration such as 1.5, 30s, 2m, 1h or 1d into milliseconds */
+static long parse_duration(const char *s)
+{
+    char *end;
+    double v = strtod(s, &end);
+    if (end == s || !(v >= 0))
+        return -1;
+
+    double scale = 1000;
+    switch (*end) {
+    case '\0':
+    case 's':
+        break;
+    case 'm':
+        scale *= 60;
+        break;
+    case 'h':
+        scale *= 3600;
+        break;
+    case 'd':
+        scale *= 86400;
+        break;
+    default:
+        return -1;
+    }
+    if (*end && end[1])
+        return -1;
+
+    v *= scale;
+    if (v >= (double) LONG_MAX)
+        return -1;
+    return (long) v + (v > (long) v); /* round up: 0.0001 is not "no deadline" */
+}
+
+/* Built-in: timeout SECS cmd [args...] - run cmd, killing it at the deadline */
+int cmd_timeout(struct process *proc, int in_fd, int out_fd)
+{
+    long ms = (proc->argc >= 3 ? parse_duration(proc->argv[1]) : -1);
+    if (ms < 0) {
+        pprintf(STDERR_FILENO, "usage: timeout SECS[s|m|h|d] command [args...]\n");
+        return -1;
+    }
+
+    /* the command runs as a one-process job in its own process group, so
+     * the deadline signals reach it and everything it starts, and nothing else */
+    struct process sub;
+    memset(&sub, 0, sizeof(sub));
+    sub.raw_cmd = proc->raw_cmd;
+    sub.argv = proc->argv + 2;
+    sub.argc = proc->argc - 2;
+    sub.builtin = find_builtin(sub.argv[0]);
+    if (!sub.builtin)
+        sub.builtin = fastpath_find(&sub);
+    sub.type = (sub.builtin ? sub.builtin->id : CMD_EXTERNAL);
+
+    struct job tmp;
+    memset(&tmp, 0, sizeof(tmp));
+    tmp.mode = FG_EXEC;
+    tmp.full_cmd = proc->raw_cmd;
+    tmp.first = &sub;
+    tmp.pipe_rd = -1;
+
+    out_flush_all();
+    if (sub.builtin)
+        sub.pid = spawn_builtin(&tmp, &sub, sub.builtin->func, in_fd, out_fd);
+    else
+        sub.pid = spawn_process(&tmp, &sub, in_fd, out_fd);
+    if (sub.pid < 0)
+        return -1;
+    tmp.pgid = sub.pid;
+    setpgid(sub.pid, sub.pid);
+    tmp.running = 1;
+
+    /* like timeout(1), a zero duration means no deadline */
+    if (supervise_job(&tmp, ms ? ms : -1))
+        return -1;
+    return sub.state == PROC_DONE ? 1 : -1;
+}
+
+/* Helper: whether p is already watched (wait %1 %1) */
+static int sv_watching(const struct supervisor *sv, const struct process *p)
+{
+    for (int i = 0; i < sv->n; i++) {
+        if (sv->entries[i].p == p)
+            return 1;
+    }
+    return 0;
+}
+
+/* Helper: watch every running process of background job j */
+static int watch_job(struct supervisor *sv, struct job *j)
+{
+    for (struct process *p = j->first; p; p = p->next) {
+        if (p->pid > 0 && p->state == PROC_RUNNING && !sv_watching(sv, p) && sv_watch(sv, p) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Built-in: wait [-n] [%job | pid ...] - wait for background jobs to finish */
+int cmd_wait(struct process *proc, int in_fd, int out_fd)
+{
+    (void) in_fd;
+    (void) out_fd;
+
+    int i = 1, next_only = 0, ret = 1;
+    if (i < proc->argc && strcmp(proc->argv[i], "-n") == 0) {
+        next_only = 1;
+        i++;
+    }
+
+    struct supervisor sv;
+    if (sv_open(&sv) < 0)
+        return -1;
+
+    if (i == proc->argc) {
+        for (int id = 1; id <= jobs_max_id(); id++) {
+            struct job *j = job_find_id(id);
+            if (j && watch_job(&sv, j) < 0)
+                ret = -1;
+        }
+    }
+
+    for (; i < proc->argc; i++) {
+        const char *arg = proc->argv[i];
+        const char *num = arg + (arg[0] == '%');
+        char *end;
+        long n = strtol(num, &end, 10);
+        if (end == num || *end || n <= 0) {
+            pprintf(STDERR_FILENO, "wait: %s: not a job or pid\n", arg);
+            ret = -1;
+            continue;
+        }
+
+        if (arg[0] == '%') {
+            struct job *j = job_find_id(n);
+            if (!j) {
+                pprintf(STDERR_FILENO, "wait: %s: no such job\n", arg);
+                ret = -1;
+            } else if (watch_job(&sv, j) < 0) {
+                ret = -1;
+            }
+        } else {
+            struct process *p = job_find_pid(n);
+            if (!p) {
+                pprintf(STDERR_FILENO, "wait: pid %ld is not a child of this shell\n", n);
+                ret = -1;
+            } else if (!sv_watching(&sv, p) && sv_watch(&sv, p) < 0) {
+                ret = -1;
+            }
+        }
+    }
+
+    /* reaped here, so the jobs finish silently instead of reporting Done */
+    struct process *p;
+    int status;
+    for (;;) {
+        int ev = sv_next(&sv, &p, &status);
+        if (ev == SV_HANGUP)
+            continue;
+        if (ev != SV_EXITED)
+            break;
+        int last = (p->job->running == 1);
+        job_exited(p, status, 0);
+        if (next_only && last)
+            break;
+    }
+
+    sv_close(&sv);
+    return ret;
+}
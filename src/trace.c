@@ -0,0 +1,186 @@
+/*
+ * trace.c - Chrome trace-event output for launch latency (make trace)
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/acct.h"
+#include "../include/builtin.h"
+#include "../include/command.h"
+#include "../include/shell.h"
+#include "../include/trace.h"
+
+#ifdef SHELL_TRACE
+
+int trace_fd = -1;
+
+/* Events are formatted here and written in large chunks. A forked builtin
+ * inherits a copy, emptied by TRACE_FLUSH() before the fork; only tr.pid
+ * writes the closing trailer, even when a child calls exit() */
+static struct {
+    char buf[TRACE_BUF_LEN];
+    size_t len;
+    pid_t pid;  // the shell, the trace's process id
+} tr;
+
+void trace_flush(void)
+{
+    size_t off = 0;
+    while (off < tr.len) {
+        ssize_t n = write(trace_fd, tr.buf + off, tr.len - off);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        off += n;
+    }
+    tr.len = 0;
+}
+
+/* Helper: append formatted text, flushing first when it might not fit */
+static void tr_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void tr_printf(const char *fmt, ...)
+{
+    if (tr.len > TRACE_BUF_LEN / 2)
+        trace_flush();
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(tr.buf + tr.len, TRACE_BUF_LEN - tr.len, fmt, ap);
+    va_end(ap);
+    if (n > 0)
+        tr.len += ((size_t) n < TRACE_BUF_LEN - tr.len ? (size_t) n : TRACE_BUF_LEN - tr.len - 1);
+}
+
+/* Helper: append s as a JSON string, at most 256 bytes of it */
+static void tr_string(const char *s)
+{
+    char esc[256 * 6 + 3], *w = esc;
+    *w++ = '"';
+    for (int i = 0; s && s[i] && i < 256; i++) {
+        unsigned char c = s[i];
+        if (c == '"' || c == '\\')
+            w += sprintf(w, "\\%c", c);
+        else if (c < 0x20)
+            w += sprintf(w, "\\u%04x", c);
+        else
+            *w++ = c;
+    }
+    *w++ = '"';
+    *w = '\0';
+    tr_printf("%s", esc);
+}
+
+/* Helper: thread_name metadata so the track shows a name instead of a number */
+static void tr_track(int tid, const char *name)
+{
+    tr_printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", tr.pid, tid);
+    tr_string(name);
+    tr_printf("}},\n");
+}
+
+int trace_open(const char *path)
+{
+    trace_close();
+    trace_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (trace_fd < 0)
+        return -1;
+    tr.pid = getpid();
+    tr.len = 0;
+    tr_printf("[\n");
+    tr_track(tr.pid, "my_shell");
+    return 0;
+}
+
+/* Close the event array so the file is strict JSON */
+void trace_close(void)
+{
+    if (trace_fd < 0)
+        return;
+    if (tr.pid == getpid()) {
+        tr_printf("{\"name\":\"trace_end\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}\n]\n",
+                  acct_now() / 1e3, tr.pid, tr.pid);
+        trace_flush();
+    }
+    tr.len = 0;
+    close(trace_fd);
+    trace_fd = -1;
+}
+
+void trace_init(void)
+{
+    const char *path = getenv(TRACE_ENV);
+    if (path && *path && trace_open(path) < 0)
+        perror(path);
+    atexit(trace_close);
+}
+
+/* Emit a complete event on the shell's track (tid 0) or on child tid */
+void trace_span(const char *name, long long start_ns, long long end_ns, int tid, const char *arg)
+{
+    tr_printf("{\"name\":\"%s\",\"cat\":\"shell\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d", name,
+              start_ns / 1e3, (end_ns - start_ns) / 1e3, tr.pid, tid ? tid : tr.pid);
+    if (arg) {
+        tr_printf(",\"args\":{\"cmd\":");
+        tr_string(arg);
+        tr_printf("}");
+    }
+    tr_printf("},\n");
+}
+
+/* Emit the spawn and run spans of a reaped child on its own track */
+void trace_process(const struct process *p)
+{
+    if (p->pid <= 0 || !p->acct.end_ns)
+        return;
+    char name[64];
+    snprintf(name, sizeof(name), "pid %d %s", (int) p->pid, p->argc > 0 ? p->argv[0] : "");
+    tr_track(p->pid, name);
+
+    long long exec_ns = p->acct.start_ns + p->acct.spawn_ns;
+    trace_span("spawn", p->acct.start_ns, exec_ns, p->pid, NULL);
+    trace_span("run", exec_ns, p->acct.end_ns, p->pid, p->raw_cmd);
+}
+
+/* Built-in: trace [on FILE | off] - start or stop writing a trace */
+int cmd_trace(struct process *proc, int in_fd, int out_fd)
+{
+    (void) in_fd;
+    if (proc->argc == 1) {
+        pprintf(out_fd, "trace: %s\n", trace_fd >= 0 ? "on" : "off");
+        return 1;
+    }
+    if (proc->argc == 3 && strcmp(proc->argv[1], "on") == 0) {
+        if (trace_open(proc->argv[2]) < 0) {
+            pprintf(STDERR_FILENO, "trace: %s: %s\n", proc->argv[2], strerror(errno));
+            return -1;
+        }
+        return 1;
+    }
+    if (proc->argc == 2 && strcmp(proc->argv[1], "off") == 0) {
+        trace_close();
+        return 1;
+    }
+    pprintf(STDERR_FILENO, "usage: trace [on FILE | off]\n");
+    return -1;
+}
+
+#else
+
+/* Built-in: trace - only available in tracing builds */
+int cmd_trace(struct process *proc, int in_fd, int out_fd)
+{
+    (void) proc;
+    (void) in_fd;
+    (void) out_fd;
+    pprintf(STDERR_FILENO, "trace: not compiled in, rebuild with `make clean trace`\n");
+    return -1;
+}
+
+#endif /* SHELL_TRACE */
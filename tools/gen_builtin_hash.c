@@ -0,0 +1,59 @@
+/*
+ * gen_builtin_hash.c - Build-time generator of the builtin dispatch table
+ *
+ * Searches for a seed that maps every name in include/builtins.def to its own
+ * slot of a power-of-two table, and prints the table as a C header on stdout.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+
+#include "builtin.h"
+
+static const char *names[] = {
+#define BUILTIN(name, func, id) #name,
+#include "builtins.def"
+#undef BUILTIN
+};
+#define NUM_NAMES (int) (sizeof(names) / sizeof(*names))
+
+#define MAX_SEEDS 10000000u
+
+int main(void)
+{
+    int size = 1;
+    while (size < NUM_NAMES * 2)
+        size *= 2;
+
+    for (;; size *= 2) {
+        for (unsigned int seed = 0; seed < MAX_SEEDS; seed++) {
+            int slots[1024];
+            int ok = 1;
+            memset(slots, -1, sizeof(slots));
+            for (int i = 0; i < NUM_NAMES && ok; i++) {
+                unsigned int h = builtin_hash(names[i], seed) & (size - 1);
+                if (slots[h] >= 0)
+                    ok = 0;
+                slots[h] = i;
+            }
+            if (!ok)
+                continue;
+
+            printf("/* Generated by tools/gen_builtin_hash.c from builtins.def - do not edit */\n");
+            printf("#ifndef BUILTIN_HASH_H\n#define BUILTIN_HASH_H\n\n");
+            printf("#define BUILTIN_HASH_SEED %uu\n", seed);
+            printf("#define BUILTIN_HASH_SIZE %d\n\n", size);
+            printf("/* slot -> index into builtins[], -1 if empty */\n");
+            printf("static const signed char builtin_hash_slots[BUILTIN_HASH_SIZE] = {");
+            for (int i = 0; i < size; i++)
+                printf("%s%d", i ? ", " : "", slots[i]);
+            printf("};\n\n#endif /* BUILTIN_HASH_H */\n");
+            return 0;
+        }
+        if (size >= 1024) {
+            fprintf(stderr, "gen_builtin_hash: no perfect hash found\n");
+            return 1;
+        }
+    }
+}